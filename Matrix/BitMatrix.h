@@ -0,0 +1,830 @@
+#ifndef MATRIX_BITMATRIX_H
+#define MATRIX_BITMATRIX_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CpuDispatch.h"
+#include "Matrix.h"
+#include "MatrixAlgebra.h"
+#include "ThreadPool.h"
+
+///@brief Amount of Matrix<bool> elements packed into one storage word
+constexpr int bitsPerWord = 64;
+
+///@brief Matrix of Boolean values packed 64 to a word
+///@note Every row starts on a word boundary and unused bits of its last word stay zero, so rows are combined,
+/// compared and counted a word at a time. Words are held by Matrix<std::uint64_t>, which shares them between
+/// copies until the first write like any other matrix. at() and row and column iterators give proxy references
+/// to single bits. Single bits have no address, so ptrAt() and the iterators' operator-> are not provided.
+template<>
+class Matrix<bool> {
+private:
+    Matrix<std::uint64_t> words;
+    MatrixIndex colCount;
+
+    static MatrixIndex wordCount(MatrixIndex columnCount);
+    std::uint64_t lastWordMask();
+    void clearPadding(std::uint64_t* data);
+    void checkSameDimensions(Matrix& other, const char* message);
+    template<typename Operation>
+    Matrix& combine(Matrix& other, Operation operation, const char* message);
+    template<typename Row>
+    void insertRowFrom(const Row& row, MatrixIndex newRowIndex);
+    template<typename Column>
+    void insertColumnFrom(const Column& column, MatrixIndex newColIndex);
+    template<typename Value>
+    static bool elementValue(const Value& value);
+
+    friend void booleanMultiply(Matrix<bool>& a, Matrix<bool>& b, Matrix<bool>& c);
+    friend void countMultiply(Matrix<bool>& a, Matrix<bool>& b, Matrix<int>& c);
+
+public:
+    ///@brief Proxy reference to a single element
+    class reference {
+    private:
+        std::uint64_t* word;
+        std::uint64_t mask;
+
+    public:
+        reference(std::uint64_t* _word, int bit) : word(_word), mask(std::uint64_t(1) << bit) {};
+        reference(const reference& other) = default;
+        operator bool() const {return (*word & mask) != 0;};
+        reference& operator=(bool value) {*word = value ? *word | mask : *word & ~mask; return *this;};
+        reference& operator=(const reference& other) {return *this = static_cast<bool>(other);};
+        void flip() {*word ^= mask;};
+    };
+
+    ///@brief Iterates over rows of the matrix
+    class MatrixRowIterator{
+    protected:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<bool>;
+        using reference         = std::vector<Matrix<bool>::reference>;
+        MatrixIndex index;
+        Matrix<bool>* matrix;
+
+    public:
+        MatrixRowIterator(MatrixIndex _index, Matrix<bool> *_impl): index(_index), matrix(_impl){};
+        ~MatrixRowIterator() = default;
+
+        MatrixRowIterator& operator++() {index++; return *this;};
+        MatrixRowIterator operator++(int) {MatrixRowIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        MatrixIndex getIndex() {return index;};
+        friend bool operator== (const MatrixRowIterator& lhs, const MatrixRowIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!= (const MatrixRowIterator& lhs, const MatrixRowIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    class ConstMatrixRowIterator{
+    protected:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<bool>;
+        using reference         = std::vector<bool>;
+        MatrixIndex index;
+        Matrix<bool>* matrix;
+
+    public:
+        ConstMatrixRowIterator(MatrixIndex _index, Matrix<bool> *_impl): index(_index), matrix(_impl){};
+        ~ConstMatrixRowIterator() = default;
+
+        ConstMatrixRowIterator& operator++() {index++; return *this;};
+        ConstMatrixRowIterator operator++(int) {ConstMatrixRowIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        MatrixIndex getIndex() {return index;};
+        friend bool operator== (const ConstMatrixRowIterator& lhs, const ConstMatrixRowIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!= (const ConstMatrixRowIterator& lhs, const ConstMatrixRowIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    ///@brief Iterates over columns of the matrix
+    class MatrixColumnIterator{
+    protected:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<bool>;
+        using reference         = std::vector<Matrix<bool>::reference>;
+        MatrixIndex index;
+        Matrix<bool>* matrix;
+
+    public:
+        MatrixColumnIterator(MatrixIndex _index, Matrix<bool>* _impl): index(_index), matrix(_impl){};
+        ~MatrixColumnIterator() = default;
+
+        MatrixColumnIterator& operator++() {index++; return *this;};
+        MatrixColumnIterator operator++(int) {MatrixColumnIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        MatrixIndex getIndex() {return index;};
+        friend bool operator== (const MatrixColumnIterator& lhs, const MatrixColumnIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!= (const MatrixColumnIterator& lhs, const MatrixColumnIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    class ConstMatrixColumnIterator{
+    protected:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<bool>;
+        using reference         = std::vector<bool>;
+        MatrixIndex index;
+        Matrix<bool>* matrix;
+
+    public:
+        ConstMatrixColumnIterator(MatrixIndex _index, Matrix<bool>* _impl): index(_index), matrix(_impl){};
+        ~ConstMatrixColumnIterator() = default;
+
+        ConstMatrixColumnIterator& operator++() {index++; return *this;};
+        ConstMatrixColumnIterator operator++(int) {ConstMatrixColumnIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        MatrixIndex getIndex() {return index;};
+        friend bool operator== (const ConstMatrixColumnIterator& lhs, const ConstMatrixColumnIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!= (const ConstMatrixColumnIterator& lhs, const ConstMatrixColumnIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    typedef MatrixRowIterator rowIterator;
+    typedef MatrixColumnIterator columnIterator;
+    typedef ConstMatrixRowIterator const_rowIterator;
+    typedef ConstMatrixColumnIterator const_columnIterator;
+
+    Matrix() noexcept;
+    Matrix(MatrixIndex row, MatrixIndex col);
+    Matrix(Matrix&& other) noexcept;
+    Matrix(const Matrix& other) = default;
+    Matrix& operator=(Matrix&& other) noexcept;
+    Matrix& operator=(const Matrix& other) = default;
+    int refCount();
+    rowIterator eraseRow(rowIterator rowIter);
+    columnIterator eraseColumn(columnIterator columnIter);
+    void swap(Matrix& other) noexcept;
+    void insertRow(std::vector<bool*> row, MatrixIndex newRowIndex);
+    void insertColumn(std::vector<bool*> column, MatrixIndex newColIndex);
+    void insertRow(std::vector<bool> row, MatrixIndex newRowIndex);
+    void insertColumn(std::vector<bool> column, MatrixIndex newColIndex);
+    MatrixIndex getColumnCount();
+    MatrixIndex getRowCount();
+    MatrixIndex getSize();
+    MatrixIndex getRowWordCount();
+    MatrixIndex getCapacity();
+    void reserve(MatrixIndex row, MatrixIndex col);
+    void resize(MatrixIndex newRowCount, MatrixIndex newColumnCount, bool fill = false);
+    void reshape(MatrixIndex newRowCount, MatrixIndex newColumnCount);
+    reference at(MatrixIndex row, MatrixIndex column);
+    bool test(MatrixIndex row, MatrixIndex column);
+    std::uint64_t* rowWords(MatrixIndex row);
+    const std::uint64_t* constRowWords(MatrixIndex row);
+
+    void fill(bool value);
+    void flip();
+    Matrix& operator&=(Matrix& other);
+    Matrix& operator|=(Matrix& other);
+    Matrix& operator^=(Matrix& other);
+    Matrix transposed();
+
+    std::int64_t popcount();
+    std::vector<int> rowPopcounts();
+    std::vector<int> columnPopcounts();
+
+    bool equals(const Matrix& other) const;
+    std::size_t hash() const;
+    friend bool operator==(const Matrix& lhs, const Matrix& rhs) {return lhs.equals(rhs);};
+
+    rowIterator beginRow() {return rowIterator(0, this);};
+    rowIterator endRow() {return rowIterator(getRowCount(), this);};
+    const_rowIterator beginConstRow() {return const_rowIterator(0, this);};
+    const_rowIterator endConstRow() {return const_rowIterator(getRowCount(), this);};
+
+    columnIterator beginColumn() {return columnIterator(0, this);};
+    columnIterator endColumn() {return columnIterator(colCount, this);};
+    const_columnIterator beginConstColumn() {return const_columnIterator(0, this);};
+    const_columnIterator endConstColumn() {return const_columnIterator(colCount, this);};
+};
+
+inline Matrix<bool>::MatrixRowIterator::reference Matrix<bool>::MatrixRowIterator::operator*() const {
+    reference temp;
+    MatrixIndex colCount = matrix->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
+    {
+        temp.push_back(matrix->at(index, i));
+    }
+
+    return temp;
+}
+
+inline Matrix<bool>::ConstMatrixRowIterator::reference Matrix<bool>::ConstMatrixRowIterator::operator*() const {
+    reference temp;
+    MatrixIndex colCount = matrix->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
+    {
+        temp.push_back(matrix->test(index, i));
+    }
+
+    return temp;
+}
+
+inline Matrix<bool>::MatrixColumnIterator::reference Matrix<bool>::MatrixColumnIterator::operator*() const {
+    reference temp;
+    MatrixIndex rowCount = matrix->getRowCount();
+    for (MatrixIndex i = 0; i < rowCount; i++)
+    {
+        temp.push_back(matrix->at(i, index));
+    }
+
+    return temp;
+}
+
+inline Matrix<bool>::ConstMatrixColumnIterator::reference Matrix<bool>::ConstMatrixColumnIterator::operator*() const {
+    reference temp;
+    MatrixIndex rowCount = matrix->getRowCount();
+    for (MatrixIndex i = 0; i < rowCount; i++)
+    {
+        temp.push_back(matrix->test(i, index));
+    }
+
+    return temp;
+}
+
+///@brief Creates 0 x 0 matrix without allocating
+inline Matrix<bool>::Matrix() noexcept :
+        colCount(0)
+{
+}
+
+///@brief Creates matrix with every element false
+inline Matrix<bool>::Matrix(MatrixIndex row, MatrixIndex col) :
+        words(row, wordCount(col)),
+        colCount(col)
+{
+    words.fill(0);
+}
+
+///@brief Gets amount of words holding a row of columnCount elements
+inline MatrixIndex Matrix<bool>::wordCount(MatrixIndex columnCount) {
+    if(columnCount < 0)
+    {
+        throw std::invalid_argument("Matrix<bool> - negative column count");
+    }
+    return (columnCount + bitsPerWord - 1) / bitsPerWord;
+}
+
+///@brief Gets mask of bits of the last row word that hold elements
+inline std::uint64_t Matrix<bool>::lastWordMask() {
+    int usedBits = static_cast<int>(colCount % bitsPerWord);
+    return usedBits == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << usedBits) - 1;
+}
+
+///@brief Zeroes unused bits of the last word of every row
+inline void Matrix<bool>::clearPadding(std::uint64_t* data) {
+    MatrixIndex rowWordCount = getRowWordCount();
+    std::uint64_t mask = lastWordMask();
+    if(rowWordCount == 0 || mask == ~std::uint64_t(0))
+    {
+        return;
+    }
+    for(MatrixIndex row = 0; row < getRowCount(); row++)
+    {
+        data[row * rowWordCount + rowWordCount - 1] &= mask;
+    }
+}
+
+inline void Matrix<bool>::checkSameDimensions(Matrix &other, const char *message) {
+    if(other.getRowCount() != getRowCount() || other.colCount != colCount)
+    {
+        throw std::invalid_argument(message);
+    }
+}
+
+///@brief Gets current matrix data reference count
+inline int Matrix<bool>::refCount() {
+    return words.refCount();
+}
+
+///@brief Takes data of other, which is left as an empty 0 x 0 matrix
+inline Matrix<bool>::Matrix(Matrix &&other) noexcept :
+        words(std::move(other.words)),
+        colCount(std::exchange(other.colCount, 0))
+{
+}
+
+///@brief Takes data of other, which is left as an empty 0 x 0 matrix
+inline Matrix<bool>& Matrix<bool>::operator=(Matrix &&other) noexcept {
+    words = std::move(other.words);
+    colCount = std::exchange(other.colCount, 0);
+    return *this;
+}
+
+inline void Matrix<bool>::swap(Matrix &other) noexcept {
+    words.swap(other.words);
+    std::swap(colCount, other.colCount);
+}
+
+inline MatrixIndex Matrix<bool>::getColumnCount() {
+    return colCount;
+}
+
+inline MatrixIndex Matrix<bool>::getRowCount() {
+    return words.getRowCount();
+}
+
+///@brief Gets amount of matrix elements
+inline MatrixIndex Matrix<bool>::getSize() {
+    return getRowCount() * colCount;
+}
+
+///@brief Gets amount of 64-bit words holding one row
+inline MatrixIndex Matrix<bool>::getRowWordCount() {
+    return words.getColumnCount();
+}
+
+///@brief Gets amount of elements that fit into matrix storage without reallocation
+///@note Counts whole words, so a capacity of c elements holds rows of up to c / rows columns rounded down to words
+inline MatrixIndex Matrix<bool>::getCapacity() {
+    return words.getCapacity() * bitsPerWord;
+}
+
+///@brief Grows word storage so that later resizes up to row x col do not reallocate
+inline void Matrix<bool>::reserve(MatrixIndex row, MatrixIndex col) {
+    words.reserve(row, wordCount(col));
+}
+
+///@brief Changes matrix dimensions keeping elements at their row and column
+///@note Rows start on word boundaries, so words keep their place and only the bits of the old last word
+/// past the old column count need filling
+///@param fill Value of elements not present before resize
+inline void Matrix<bool>::resize(MatrixIndex newRowCount, MatrixIndex newColumnCount, bool fill) {
+    MatrixIndex newWordCount = wordCount(newColumnCount);
+    MatrixIndex keptRows = std::min(newRowCount, getRowCount());
+    MatrixIndex oldColumnCount = colCount;
+    words.resize(newRowCount, newWordCount, fill ? ~std::uint64_t(0) : 0);
+    colCount = newColumnCount;
+    std::uint64_t* data = words.begin();
+    int usedBits = static_cast<int>(oldColumnCount % bitsPerWord);
+    if(fill && newColumnCount > oldColumnCount && usedBits != 0)
+    {
+        MatrixIndex word = oldColumnCount / bitsPerWord;
+        std::uint64_t newBits = ~((std::uint64_t(1) << usedBits) - 1);
+        for(MatrixIndex row = 0; row < keptRows; row++)
+        {
+            data[row * newWordCount + word] |= newBits;
+        }
+    }
+    clearPadding(data);
+}
+
+///@brief Reinterprets row-major elements with new dimensions
+///@note Rows are padded to whole words, so elements are repacked unless the column count stays the same
+///@param newColumnCount Column count after reshape, newRowCount * newColumnCount must equal element count
+inline void Matrix<bool>::reshape(MatrixIndex newRowCount, MatrixIndex newColumnCount) {
+    MatrixIndex size = getSize();
+    if(newRowCount < 0 || newColumnCount < 0 || (newColumnCount != 0 && newRowCount > size / newColumnCount) ||
+       newRowCount * newColumnCount != size)
+    {
+        throw std::invalid_argument("Matrix<bool>::reshape - element count does not match");
+    }
+    if(newColumnCount == colCount && newRowCount == getRowCount())
+    {
+        return;
+    }
+    MATRIX_TRACE_SCOPE("Matrix<bool>::reshape", newRowCount, newColumnCount,
+                       2 * static_cast<std::int64_t>(words.getSize()) * sizeof(std::uint64_t));
+    Matrix<bool> result(newRowCount, newColumnCount);
+    const std::uint64_t* source = words.cbegin();
+    std::uint64_t* destination = result.words.begin();
+    MatrixIndex rowWordCount = getRowWordCount();
+    MatrixIndex resultWordCount = result.getRowWordCount();
+    for(MatrixIndex index = 0; index < size; index++)
+    {
+        MatrixIndex row = index / colCount;
+        MatrixIndex column = index % colCount;
+        if(source[row * rowWordCount + column / bitsPerWord] >> (column % bitsPerWord) & 1)
+        {
+            MatrixIndex resultRow = index / newColumnCount;
+            MatrixIndex resultColumn = index % newColumnCount;
+            destination[resultRow * resultWordCount + resultColumn / bitsPerWord] |=
+                    std::uint64_t(1) << (resultColumn % bitsPerWord);
+        }
+    }
+    swap(result);
+}
+
+///@brief Erases matrix row by iterator, moving whole word rows
+///@retval Iterator pointing to next row or endRow()
+inline Matrix<bool>::rowIterator Matrix<bool>::eraseRow(rowIterator rowIter) {
+    if(rowIter.getIndex() < 0 || rowIter.getIndex() >= getRowCount())
+    {
+        throw std::out_of_range("Matrix<bool>::eraseRow - index out of range");
+    }
+    words.eraseRow(Matrix<std::uint64_t>::rowIterator(rowIter.getIndex(), &words));
+    return rowIter;
+}
+
+///@brief Erases matrix column by iterator, shifting later bits of every row down by one
+///@retval Iterator pointing to next column or endColumn()
+inline Matrix<bool>::columnIterator Matrix<bool>::eraseColumn(columnIterator columnIter) {
+    MatrixIndex erasedColumn = columnIter.getIndex();
+    if(erasedColumn < 0 || erasedColumn >= colCount)
+    {
+        throw std::out_of_range("Matrix<bool>::eraseColumn - index out of range");
+    }
+    MATRIX_TRACE_SCOPE("Matrix<bool>::eraseColumn", getRowCount(), colCount,
+                       2 * static_cast<std::int64_t>(words.getSize()) * sizeof(std::uint64_t));
+    MatrixIndex rowWordCount = getRowWordCount();
+    MatrixIndex firstWord = erasedColumn / bitsPerWord;
+    std::uint64_t lowBits = (std::uint64_t(1) << (erasedColumn % bitsPerWord)) - 1;
+    std::uint64_t* data = words.begin();
+    for(MatrixIndex row = 0; row < getRowCount(); row++)
+    {
+        std::uint64_t* rowData = data + row * rowWordCount;
+        rowData[firstWord] = (rowData[firstWord] & lowBits) | ((rowData[firstWord] >> 1) & ~lowBits);
+        for(MatrixIndex word = firstWord + 1; word < rowWordCount; word++)
+        {
+            rowData[word - 1] |= rowData[word] << (bitsPerWord - 1);
+            rowData[word] >>= 1;
+        }
+    }
+    colCount--;
+    words.resize(getRowCount(), wordCount(colCount));
+    return columnIter;
+}
+
+///@brief Gets value of inserted element given by value or pointer
+template<typename Value>
+bool Matrix<bool>::elementValue(const Value& value) {
+    if constexpr(std::is_pointer_v<Value>)
+    {
+        return *value;
+    }
+    else
+    {
+        return value;
+    }
+}
+
+///@brief Packs row into words and inserts them as a word row at newRowIndex
+template<typename Row>
+void Matrix<bool>::insertRowFrom(const Row& row, MatrixIndex newRowIndex) {
+    if(newRowIndex < 0 || newRowIndex > getRowCount())
+    {
+        throw std::out_of_range("Matrix<bool>::insertRow - index out of range");
+    }
+    if(static_cast<MatrixIndex>(row.size()) != colCount)
+    {
+        throw std::out_of_range("Matrix<bool>::insertRow - row size does not match column count");
+    }
+    std::vector<std::uint64_t> packed(getRowWordCount(), 0);
+    for(MatrixIndex column = 0; column < colCount; column++)
+    {
+        if(elementValue(row[column]))
+        {
+            packed[column / bitsPerWord] |= std::uint64_t(1) << (column % bitsPerWord);
+        }
+    }
+    words.insertRow(std::move(packed), newRowIndex);
+}
+
+///@brief Shifts bits from newColIndex on of every row up by one and stores column values in the freed bits
+template<typename Column>
+void Matrix<bool>::insertColumnFrom(const Column& column, MatrixIndex newColIndex) {
+    if(newColIndex < 0 || newColIndex > colCount)
+    {
+        throw std::out_of_range("Matrix<bool>::insertColumn - index out of range");
+    }
+    if(static_cast<MatrixIndex>(column.size()) != getRowCount())
+    {
+        throw std::out_of_range("Matrix<bool>::insertColumn - column size does not match row count");
+    }
+    MATRIX_TRACE_SCOPE("Matrix<bool>::insertColumn", getRowCount(), colCount,
+                       2 * static_cast<std::int64_t>(words.getSize()) * sizeof(std::uint64_t));
+    words.resize(getRowCount(), wordCount(colCount + 1), 0);
+    colCount++;
+    MatrixIndex rowWordCount = getRowWordCount();
+    MatrixIndex firstWord = newColIndex / bitsPerWord;
+    int bit = static_cast<int>(newColIndex % bitsPerWord);
+    std::uint64_t lowBits = (std::uint64_t(1) << bit) - 1;
+    std::uint64_t* data = words.begin();
+    for(MatrixIndex row = 0; row < getRowCount(); row++)
+    {
+        std::uint64_t* rowData = data + row * rowWordCount;
+        for(MatrixIndex word = rowWordCount - 1; word > firstWord; word--)
+        {
+            rowData[word] = rowData[word] << 1 | rowData[word - 1] >> (bitsPerWord - 1);
+        }
+        std::uint64_t value = elementValue(column[row]) ? std::uint64_t(1) << bit : 0;
+        rowData[firstWord] = (rowData[firstWord] & lowBits) | ((rowData[firstWord] & ~lowBits) << 1) | value;
+    }
+}
+
+///@brief Inserts row at specified index
+///@param row Vector holding pointers to inserted elements
+inline void Matrix<bool>::insertRow(std::vector<bool*> row, MatrixIndex newRowIndex) {
+    insertRowFrom(row, newRowIndex);
+}
+
+///@brief Inserts row at specified index
+///@param row Vector holding inserted elements
+inline void Matrix<bool>::insertRow(std::vector<bool> row, MatrixIndex newRowIndex) {
+    insertRowFrom(row, newRowIndex);
+}
+
+///@brief Inserts column at specified index
+///@param column Vector holding pointers to inserted elements
+inline void Matrix<bool>::insertColumn(std::vector<bool*> column, MatrixIndex newColIndex) {
+    insertColumnFrom(column, newColIndex);
+}
+
+///@brief Inserts column at specified index
+///@param column Vector holding inserted elements
+inline void Matrix<bool>::insertColumn(std::vector<bool> column, MatrixIndex newColIndex) {
+    insertColumnFrom(column, newColIndex);
+}
+
+///@brief Returns proxy reference to element at specified row and column
+///@note Proxy stays valid until the matrix is copied, resized or destroyed
+inline Matrix<bool>::reference Matrix<bool>::at(MatrixIndex row, MatrixIndex column) {
+    if(row < 0 || row >= getRowCount() || column < 0 || column >= colCount)
+    {
+        throw std::out_of_range("Matrix<bool>::at - index out of range");
+    }
+    return reference(&words.at(row, column / bitsPerWord), column % bitsPerWord);
+}
+
+///@brief Gets value of element at specified row and column without detaching shared data
+inline bool Matrix<bool>::test(MatrixIndex row, MatrixIndex column) {
+    if(row < 0 || row >= getRowCount() || column < 0 || column >= colCount)
+    {
+        throw std::out_of_range("Matrix<bool>::test - index out of range");
+    }
+    return (constRowWords(row)[column / bitsPerWord] >> (column % bitsPerWord) & 1) != 0;
+}
+
+///@brief Gets writable words of row, element of column c is bit c % 64 of word c / 64
+///@note Unused bits of the last word must be left zero
+inline std::uint64_t* Matrix<bool>::rowWords(MatrixIndex row) {
+    if(row < 0 || row >= getRowCount())
+    {
+        throw std::out_of_range("Matrix<bool>::rowWords - index out of range");
+    }
+    return getRowWordCount() == 0 ? nullptr : words.ptrAt(row, 0);
+}
+
+///@brief Gets words of row, see rowWords()
+inline const std::uint64_t* Matrix<bool>::constRowWords(MatrixIndex row) {
+    if(row < 0 || row >= getRowCount())
+    {
+        throw std::out_of_range("Matrix<bool>::constRowWords - index out of range");
+    }
+    return words.cbegin() + row * getRowWordCount();
+}
+
+///@brief Assigns value to every matrix element
+inline void Matrix<bool>::fill(bool value) {
+    words.fill(value ? ~std::uint64_t(0) : 0);
+    clearPadding(words.begin());
+}
+
+///@brief Negates every matrix element
+inline void Matrix<bool>::flip() {
+    combine(*this, [](std::uint64_t lhs, std::uint64_t) {return ~lhs;}, "");
+}
+
+///@brief Applies word operation to every word pair of two matrices of the same dimensions, storing into this matrix
+template<typename Operation>
+Matrix<bool>& Matrix<bool>::combine(Matrix &other, Operation operation, const char *message) {
+    MATRIX_TRACE_SCOPE("Matrix<bool>::combine", getRowCount(), colCount,
+                       2 * static_cast<std::int64_t>(words.getSize()) * sizeof(std::uint64_t));
+    checkSameDimensions(other, message);
+    std::uint64_t* data = words.begin();
+    const std::uint64_t* otherData = other.words.cbegin();
+    ThreadPool::instance().parallelFor(0, words.getSize(), 4096, [&](MatrixIndex begin, MatrixIndex end) {
+        for(MatrixIndex index = begin; index < end; index++)
+        {
+            data[index] = operation(data[index], otherData[index]);
+        }
+    });
+    clearPadding(data);
+    return *this;
+}
+
+///@brief Assigns element-wise conjunction with other matrix of the same dimensions
+inline Matrix<bool>& Matrix<bool>::operator&=(Matrix &other) {
+    return combine(other, [](std::uint64_t lhs, std::uint64_t rhs) {return lhs & rhs;},
+                   "Matrix<bool>::operator&= - matrix dimensions do not match");
+}
+
+///@brief Assigns element-wise disjunction with other matrix of the same dimensions
+inline Matrix<bool>& Matrix<bool>::operator|=(Matrix &other) {
+    return combine(other, [](std::uint64_t lhs, std::uint64_t rhs) {return lhs | rhs;},
+                   "Matrix<bool>::operator|= - matrix dimensions do not match");
+}
+
+///@brief Assigns element-wise exclusive disjunction with other matrix of the same dimensions
+inline Matrix<bool>& Matrix<bool>::operator^=(Matrix &other) {
+    return combine(other, [](std::uint64_t lhs, std::uint64_t rhs) {return lhs ^ rhs;},
+                   "Matrix<bool>::operator^= - matrix dimensions do not match");
+}
+
+///@brief Creates transposed copy of the matrix
+///@note Set bits are scattered, so the cost follows the amount of true elements.
+/// Tasks own 64-row bands of the source, which are single word columns of the result.
+inline Matrix<bool> Matrix<bool>::transposed() {
+    MATRIX_TRACE_SCOPE("Matrix<bool>::transposed", getRowCount(), colCount,
+                       2 * static_cast<std::int64_t>(words.getSize()) * sizeof(std::uint64_t));
+    MatrixIndex rowCount = getRowCount();
+    MatrixIndex rowWordCount = getRowWordCount();
+    Matrix<bool> result(colCount, rowCount);
+    MatrixIndex resultWordCount = result.getRowWordCount();
+    const std::uint64_t* source = words.cbegin();
+    std::uint64_t* destination = result.words.begin();
+    ThreadPool::instance().parallelFor(0, resultWordCount, 1, [&](MatrixIndex wordBegin, MatrixIndex wordEnd) {
+        for(MatrixIndex row = wordBegin * bitsPerWord; row < std::min(rowCount, wordEnd * MatrixIndex(bitsPerWord)); row++)
+        {
+            std::uint64_t rowBit = std::uint64_t(1) << (row % bitsPerWord);
+            for(MatrixIndex word = 0; word < rowWordCount; word++)
+            {
+                for(std::uint64_t bits = source[row * rowWordCount + word]; bits != 0; bits &= bits - 1)
+                {
+                    MatrixIndex column = word * bitsPerWord + std::countr_zero(bits);
+                    destination[column * resultWordCount + row / bitsPerWord] |= rowBit;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+namespace MatrixKernels {
+
+///@brief Counts bits set in both word vectors, split into calls of the dispatched kernel whose sizes are int
+inline std::int64_t andPopcount(const std::uint64_t* lhs, const std::uint64_t* rhs, MatrixIndex size) {
+    std::int64_t count = 0;
+    for(MatrixIndex begin = 0; begin < size; begin += dispatchedKernelChunk)
+    {
+        count += cpuKernels().andPopcount(lhs + begin, rhs + begin,
+                                          static_cast<int>(std::min(dispatchedKernelChunk, size - begin)));
+    }
+    return count;
+}
+
+}
+
+///@brief Counts true elements
+inline std::int64_t Matrix<bool>::popcount() {
+    const std::uint64_t* data = words.cbegin();
+    return MatrixKernels::andPopcount(data, data, words.getSize());
+}
+
+///@brief Counts true elements of every row
+inline std::vector<int> Matrix<bool>::rowPopcounts() {
+    MATRIX_TRACE_SCOPE("Matrix<bool>::rowPopcounts", getRowCount(), colCount,
+                       static_cast<std::int64_t>(words.getSize()) * sizeof(std::uint64_t));
+    std::vector<int> counts(getRowCount());
+    const std::uint64_t* data = words.cbegin();
+    MatrixIndex rowWordCount = getRowWordCount();
+    ThreadPool::instance().parallelFor(0, getRowCount(), std::max<MatrixIndex>(1, 4096 / std::max<MatrixIndex>(1, rowWordCount)),
+                                       [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+        {
+            const std::uint64_t* rowData = data + row * rowWordCount;
+            counts[row] = static_cast<int>(MatrixKernels::andPopcount(rowData, rowData, rowWordCount));
+        }
+    });
+    return counts;
+}
+
+///@brief Counts true elements of every column
+///@note Tasks own word columns, so counters are never shared. Cost follows the amount of true elements.
+inline std::vector<int> Matrix<bool>::columnPopcounts() {
+    MATRIX_TRACE_SCOPE("Matrix<bool>::columnPopcounts", getRowCount(), colCount,
+                       static_cast<std::int64_t>(words.getSize()) * sizeof(std::uint64_t));
+    std::vector<int> counts(colCount);
+    const std::uint64_t* data = words.cbegin();
+    MatrixIndex rowCount = getRowCount();
+    MatrixIndex rowWordCount = getRowWordCount();
+    ThreadPool::instance().parallelFor(0, rowWordCount, 1, [&](MatrixIndex wordBegin, MatrixIndex wordEnd) {
+        for(MatrixIndex row = 0; row < rowCount; row++)
+        {
+            for(MatrixIndex word = wordBegin; word < wordEnd; word++)
+            {
+                for(std::uint64_t bits = data[row * rowWordCount + word]; bits != 0; bits &= bits - 1)
+                {
+                    counts[word * bitsPerWord + std::countr_zero(bits)]++;
+                }
+            }
+        }
+    });
+    return counts;
+}
+
+///@brief Compares dimensions and contents of matrices
+inline bool Matrix<bool>::equals(const Matrix &other) const {
+    return colCount == other.colCount && words.equals(other.words);
+}
+
+///@brief Gets hash of matrix dimensions and contents, see Matrix::hash()
+inline std::size_t Matrix<bool>::hash() const {
+    return Matrix<std::uint64_t>::hashBytes(reinterpret_cast<const unsigned char*>(&colCount), sizeof(colCount),
+                                            words.hash());
+}
+
+///@brief Computes element-wise conjunction of matrices of the same dimensions
+inline Matrix<bool> operator&(Matrix<bool> lhs, Matrix<bool> rhs) {
+    lhs &= rhs;
+    return lhs;
+}
+
+///@brief Computes element-wise disjunction of matrices of the same dimensions
+inline Matrix<bool> operator|(Matrix<bool> lhs, Matrix<bool> rhs) {
+    lhs |= rhs;
+    return lhs;
+}
+
+///@brief Computes element-wise exclusive disjunction of matrices of the same dimensions
+inline Matrix<bool> operator^(Matrix<bool> lhs, Matrix<bool> rhs) {
+    lhs ^= rhs;
+    return lhs;
+}
+
+///@brief Computes element-wise negation of matrix
+inline Matrix<bool> operator~(Matrix<bool> matrix) {
+    matrix.flip();
+    return matrix;
+}
+
+///@brief Computes Boolean matrix product, C(i, j) is true when A(i, k) and B(k, j) are true for some k
+///@note Every true element A(i, k) ORs row k of B into row i of C a word at a time. Rows of C run on ThreadPool.
+inline void booleanMultiply(Matrix<bool>& a, Matrix<bool>& b, Matrix<bool>& c) {
+    MatrixIndex m = a.getRowCount();
+    MatrixIndex k = a.getColumnCount();
+    if(b.getRowCount() != k || c.getRowCount() != m || c.getColumnCount() != b.getColumnCount())
+    {
+        throw std::invalid_argument("booleanMultiply - matrix dimensions do not match");
+    }
+    MATRIX_TRACE_SCOPE("booleanMultiply", m, b.getColumnCount(),
+                       (static_cast<std::int64_t>(a.words.getSize()) + b.words.getSize() + c.words.getSize()) *
+                       sizeof(std::uint64_t));
+    const std::uint64_t* aData = a.words.cbegin();
+    const std::uint64_t* bData = b.words.cbegin();
+    std::uint64_t* cData = c.words.begin();
+    if(cData == aData || cData == bData)
+    {
+        throw std::invalid_argument("booleanMultiply - result must not share data with operands");
+    }
+    MatrixIndex aWordCount = a.getRowWordCount();
+    MatrixIndex bWordCount = b.getRowWordCount();
+    MatrixIndex grain = std::max<MatrixIndex>(1, (1 << 16) / std::max<MatrixIndex>(1, k * bWordCount));
+    ThreadPool::instance().parallelFor(0, m, grain, [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+        {
+            std::uint64_t* cRow = cData + row * bWordCount;
+            std::fill(cRow, cRow + bWordCount, 0);
+            for(MatrixIndex word = 0; word < aWordCount; word++)
+            {
+                for(std::uint64_t bits = aData[row * aWordCount + word]; bits != 0; bits &= bits - 1)
+                {
+                    const std::uint64_t* bRow = bData + (word * bitsPerWord + std::countr_zero(bits)) * bWordCount;
+                    for(MatrixIndex index = 0; index < bWordCount; index++)
+                    {
+                        cRow[index] |= bRow[index];
+                    }
+                }
+            }
+        }
+    });
+}
+
+///@brief Computes integer product of Boolean matrices, C(i, j) counts k for which A(i, k) and B(k, j) are true
+///@note E.g. for adjacency matrices it counts paths of length two. B is transposed once, then every element
+/// is a popcount of two word rows ANDed together, using the dispatched SIMD kernel. Rows of C run on ThreadPool.
+inline void countMultiply(Matrix<bool>& a, Matrix<bool>& b, Matrix<int>& c) {
+    MatrixIndex m = a.getRowCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != a.getColumnCount() || c.getRowCount() != m || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("countMultiply - matrix dimensions do not match");
+    }
+    MATRIX_TRACE_SCOPE("countMultiply", m, n,
+                       (static_cast<std::int64_t>(a.words.getSize()) + b.words.getSize()) * sizeof(std::uint64_t) +
+                       static_cast<std::int64_t>(c.getSize()) * sizeof(int));
+    Matrix<bool> bTransposed = b.transposed();
+    const std::uint64_t* aData = a.words.cbegin();
+    const std::uint64_t* bData = bTransposed.words.cbegin();
+    int* cData = c.begin();
+    MatrixIndex wordCount = a.getRowWordCount();
+    ThreadPool::instance().parallelFor(0, m, std::max<MatrixIndex>(1, 4096 / std::max<MatrixIndex>(1, n * wordCount)), [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+        {
+            for(MatrixIndex column = 0; column < n; column++)
+            {
+                cData[row * n + column] = static_cast<int>(MatrixKernels::andPopcount(aData + row * wordCount,
+                                                                                      bData + column * wordCount,
+                                                                                      wordCount));
+            }
+        }
+    });
+}
+
+#endif //MATRIX_BITMATRIX_H
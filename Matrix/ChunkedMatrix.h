@@ -0,0 +1,1047 @@
+#ifndef MATRIX_CHUNKEDMATRIX_H
+#define MATRIX_CHUNKEDMATRIX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Matrix.h"
+
+///@brief Matrix storing rows in blocks that are kept in an implicit treap ordered by row index
+///@note Every block holds up to twice blockBytes of consecutive rows in contiguous memory.
+/// Inserting or erasing a row in the middle shifts rows of one block and updates row counts
+/// along one tree path, so it costs O(row length * block rows + log n) instead of moving every later row.
+/// Row lookup is O(log n), elements of one row are contiguous.
+/// A block left under half full by erasure is merged with a neighbour. Column insertion and erasure
+/// rewrite every row, they repack rows into full blocks in the same pass.
+/// Unlike Matrix, copies are deep and data is never shared.
+template<typename T>
+class ChunkedMatrix {
+private:
+    static constexpr int blockBytes = 16 * 1024;
+
+    struct Block {
+        std::vector<T> data;
+        int rowCount;
+        int subtreeRowCount;
+        unsigned priority;
+        std::unique_ptr<Block> left;
+        std::unique_ptr<Block> right;
+    };
+
+    std::unique_ptr<Block> root;
+    int rowCount;
+    int colCount;
+    std::minstd_rand priorities;
+
+    int blockRows();
+    static int subtreeRows(const std::unique_ptr<Block>& block);
+    static void update(Block* block);
+    static std::unique_ptr<Block> clone(const std::unique_ptr<Block>& block);
+    static std::pair<std::unique_ptr<Block>, std::unique_ptr<Block>> split(std::unique_ptr<Block> block, int rows);
+    static std::unique_ptr<Block> merge(std::unique_ptr<Block> lhs, std::unique_ptr<Block> rhs);
+    std::unique_ptr<Block> makeBlock(std::vector<T> data, int rows);
+    Block* find(int& row) const;
+    T* insertRowSlot(int newRowIndex);
+    void insertBlock(int firstRow, std::unique_ptr<Block> block);
+    void mergeNeighbour(int blockStart, int rows);
+    template<typename Function>
+    void forEachBlock(Function function) const;
+    template<typename Transform>
+    void rebuildRows(int newColCount, Transform transform);
+    template<typename Column>
+    void insertColumnFrom(const Column& column, int newColIndex);
+
+    template<typename Value>
+    class ElementIterator {
+    private:
+        const ChunkedMatrix* matrix;
+        int row;
+        int column;
+        Value* rowData;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::remove_const_t<Value>;
+        using pointer           = Value*;
+        using reference         = Value&;
+
+        ElementIterator() : matrix(nullptr), row(0), column(0), rowData(nullptr) {};
+        ElementIterator(const ChunkedMatrix* _matrix, int _row) :
+                matrix(_matrix), row(_row), column(0),
+                rowData(_row < _matrix->rowCount ? _matrix->rowPointer(_row) : nullptr) {};
+
+        reference operator*() const {return rowData[column];};
+        pointer operator->() const {return rowData + column;};
+        ElementIterator& operator++();
+        ElementIterator operator++(int) {ElementIterator temp = *this; ++*this; return temp;};
+        friend bool operator==(const ElementIterator& lhs, const ElementIterator& rhs) {
+            return lhs.row == rhs.row && lhs.column == rhs.column;
+        };
+    };
+
+    T* rowPointer(int row) const;
+
+public:
+    ///@brief Iterates over rows of the matrix, same interface as Matrix::rowIterator
+    class ChunkedRowIterator {
+    protected:
+        int index;
+        ChunkedMatrix<T>* matrix;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<T>;
+        using pointer           = std::vector<T*>;
+        using reference         = std::vector<std::reference_wrapper<T>>;
+
+        ChunkedRowIterator(int _index, ChunkedMatrix<T>* _matrix) : index(_index), matrix(_matrix) {};
+
+        ChunkedRowIterator& operator++() {index++; return *this;};
+        ChunkedRowIterator operator++(int) {ChunkedRowIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        pointer operator->();
+        int getIndex() {return index;};
+        friend bool operator==(const ChunkedRowIterator& lhs, const ChunkedRowIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!=(const ChunkedRowIterator& lhs, const ChunkedRowIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    class ConstChunkedRowIterator {
+    protected:
+        int index;
+        ChunkedMatrix<T>* matrix;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<T>;
+        using pointer           = std::vector<const T*>;
+        using reference         = std::vector<std::reference_wrapper<const T>>;
+
+        ConstChunkedRowIterator(int _index, ChunkedMatrix<T>* _matrix) : index(_index), matrix(_matrix) {};
+
+        ConstChunkedRowIterator& operator++() {index++; return *this;};
+        ConstChunkedRowIterator operator++(int) {ConstChunkedRowIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        pointer operator->();
+        int getIndex() {return index;};
+        friend bool operator==(const ConstChunkedRowIterator& lhs, const ConstChunkedRowIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!=(const ConstChunkedRowIterator& lhs, const ConstChunkedRowIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    ///@brief Iterates over columns of the matrix, same interface as Matrix::columnIterator
+    ///@note Dereferencing walks every block once, so it costs O(row count)
+    class ChunkedColumnIterator {
+    protected:
+        int index;
+        ChunkedMatrix<T>* matrix;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<T>;
+        using pointer           = std::vector<T*>;
+        using reference         = std::vector<std::reference_wrapper<T>>;
+
+        ChunkedColumnIterator(int _index, ChunkedMatrix<T>* _matrix) : index(_index), matrix(_matrix) {};
+
+        ChunkedColumnIterator& operator++() {index++; return *this;};
+        ChunkedColumnIterator operator++(int) {ChunkedColumnIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        pointer operator->();
+        int getIndex() {return index;};
+        friend bool operator==(const ChunkedColumnIterator& lhs, const ChunkedColumnIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!=(const ChunkedColumnIterator& lhs, const ChunkedColumnIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    class ConstChunkedColumnIterator {
+    protected:
+        int index;
+        ChunkedMatrix<T>* matrix;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<T>;
+        using pointer           = std::vector<const T*>;
+        using reference         = std::vector<std::reference_wrapper<const T>>;
+
+        ConstChunkedColumnIterator(int _index, ChunkedMatrix<T>* _matrix) : index(_index), matrix(_matrix) {};
+
+        ConstChunkedColumnIterator& operator++() {index++; return *this;};
+        ConstChunkedColumnIterator operator++(int) {ConstChunkedColumnIterator temp = *this; index++; return temp;};
+        reference operator*() const;
+        pointer operator->();
+        int getIndex() {return index;};
+        friend bool operator==(const ConstChunkedColumnIterator& lhs, const ConstChunkedColumnIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!=(const ConstChunkedColumnIterator& lhs, const ConstChunkedColumnIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    typedef ChunkedRowIterator rowIterator;
+    typedef ConstChunkedRowIterator const_rowIterator;
+    typedef ChunkedColumnIterator columnIterator;
+    typedef ConstChunkedColumnIterator const_columnIterator;
+    typedef ElementIterator<T> iterator;
+    typedef ElementIterator<const T> const_iterator;
+
+    ChunkedMatrix(int row, int col);
+    explicit ChunkedMatrix(Matrix<T>& matrix);
+    ChunkedMatrix(const ChunkedMatrix& other);
+    ChunkedMatrix(ChunkedMatrix&& other) noexcept;
+    ChunkedMatrix& operator=(ChunkedMatrix other) noexcept;
+    ~ChunkedMatrix();
+
+    int getColumnCount();
+    int getRowCount();
+    int getBlockCount();
+    T& at(int row, int column);
+    T* ptrAt(int row, int column);
+
+    void insertRow(std::vector<T*> row, int newRowIndex);
+    void insertRow(std::vector<T> row, int newRowIndex);
+    rowIterator eraseRow(rowIterator rowIter);
+    void eraseRow(int rowIndex);
+    void insertColumn(std::vector<T*> column, int newColIndex);
+    void insertColumn(std::vector<T> column, int newColIndex);
+    columnIterator eraseColumn(columnIterator columnIter);
+    void eraseColumn(int columnIndex);
+
+    Matrix<T> toMatrix();
+
+    rowIterator beginRow();
+    rowIterator endRow();
+    const_rowIterator beginConstRow();
+    const_rowIterator endConstRow();
+    columnIterator beginColumn();
+    columnIterator endColumn();
+    const_columnIterator beginConstColumn();
+    const_columnIterator endConstColumn();
+
+    iterator begin();
+    iterator end();
+    const_iterator cbegin();
+    const_iterator cend();
+
+    auto rows();
+    auto constRows();
+};
+
+///@brief Creates matrix with default constructed elements
+template<typename T>
+ChunkedMatrix<T>::ChunkedMatrix(int row, int col) :
+        rowCount(0),
+        colCount(col)
+{
+    if(row < 0 || col < 0)
+    {
+        throw std::invalid_argument("ChunkedMatrix - negative dimension");
+    }
+    for(int firstRow = 0; firstRow < row; firstRow += std::min(blockRows(), row - firstRow))
+    {
+        int rows = std::min(blockRows(), row - firstRow);
+        insertBlock(firstRow, makeBlock(std::vector<T>(static_cast<std::size_t>(rows) * colCount), rows));
+    }
+}
+
+///@brief Copies elements of contiguous matrix
+template<typename T>
+ChunkedMatrix<T>::ChunkedMatrix(Matrix<T> &matrix) :
+        rowCount(0),
+        colCount(matrix.getColumnCount())
+{
+    if(matrix.getRowCount() > std::numeric_limits<int>::max() || matrix.getColumnCount() > std::numeric_limits<int>::max())
+    {
+        throw std::length_error("ChunkedMatrix - dimension exceeds int range");
+    }
+    auto source = matrix.cbegin();
+    int row = static_cast<int>(matrix.getRowCount());
+    for(int firstRow = 0; firstRow < row; firstRow += std::min(blockRows(), row - firstRow))
+    {
+        int rows = std::min(blockRows(), row - firstRow);
+        std::vector<T> data(source + static_cast<MatrixIndex>(firstRow) * colCount,
+                            source + static_cast<MatrixIndex>(firstRow + rows) * colCount);
+        insertBlock(firstRow, makeBlock(std::move(data), rows));
+    }
+}
+
+template<typename T>
+ChunkedMatrix<T>::ChunkedMatrix(const ChunkedMatrix &other) :
+        root(clone(other.root)),
+        rowCount(other.rowCount),
+        colCount(other.colCount),
+        priorities(other.priorities)
+{
+}
+
+template<typename T>
+ChunkedMatrix<T>::ChunkedMatrix(ChunkedMatrix &&other) noexcept :
+        root(std::move(other.root)),
+        rowCount(other.rowCount),
+        colCount(other.colCount),
+        priorities(other.priorities)
+{
+    other.rowCount = 0;
+}
+
+template<typename T>
+ChunkedMatrix<T>& ChunkedMatrix<T>::operator=(ChunkedMatrix other) noexcept {
+    std::swap(root, other.root);
+    std::swap(rowCount, other.rowCount);
+    std::swap(colCount, other.colCount);
+    std::swap(priorities, other.priorities);
+    return *this;
+}
+
+///@brief Destroys blocks iteratively, so destruction depth does not depend on tree shape
+template<typename T>
+ChunkedMatrix<T>::~ChunkedMatrix() {
+    std::vector<std::unique_ptr<Block>> pending;
+    if(root)
+    {
+        pending.push_back(std::move(root));
+    }
+    while(!pending.empty())
+    {
+        std::unique_ptr<Block> block = std::move(pending.back());
+        pending.pop_back();
+        if(block->left)
+        {
+            pending.push_back(std::move(block->left));
+        }
+        if(block->right)
+        {
+            pending.push_back(std::move(block->right));
+        }
+    }
+}
+
+template<typename T>
+int ChunkedMatrix<T>::getColumnCount() {
+    return colCount;
+}
+
+template<typename T>
+int ChunkedMatrix<T>::getRowCount() {
+    return rowCount;
+}
+
+///@brief Gets amount of row blocks, mostly useful for diagnostics
+template<typename T>
+int ChunkedMatrix<T>::getBlockCount() {
+    int count = 0;
+    std::vector<Block*> pending;
+    if(root)
+    {
+        pending.push_back(root.get());
+    }
+    while(!pending.empty())
+    {
+        Block* block = pending.back();
+        pending.pop_back();
+        count++;
+        if(block->left)
+        {
+            pending.push_back(block->left.get());
+        }
+        if(block->right)
+        {
+            pending.push_back(block->right.get());
+        }
+    }
+    return count;
+}
+
+///@brief Returns reference to object at specified row and column coordinates
+template<typename T>
+T& ChunkedMatrix<T>::at(int row, int column) {
+    if(row < 0 || column < 0 || row >= rowCount || column >= colCount)
+    {
+        throw std::out_of_range("ChunkedMatrix::at - index out of range");
+    }
+    return rowPointer(row)[column];
+}
+
+///@brief Returns pointer to object at specified row and column coordinates
+template<typename T>
+T* ChunkedMatrix<T>::ptrAt(int row, int column) {
+    return &at(row, column);
+}
+
+///@brief Inserts row at specified index
+///@param row Vector holding pointers to inserted elements
+///@param newRowIndex Index at which new row will be inserted
+template<typename T>
+void ChunkedMatrix<T>::insertRow(std::vector<T *> row, int newRowIndex) {
+    MATRIX_TRACE_SCOPE("ChunkedMatrix::insertRow", getRowCount(), getColumnCount(), getColumnCount() * sizeof(T));
+    if(static_cast<int>(row.size()) != colCount)
+    {
+        throw std::invalid_argument("ChunkedMatrix::insertRow - row size does not match column count");
+    }
+    T* slot = insertRowSlot(newRowIndex);
+    for(int column = 0; column < colCount; column++)
+    {
+        slot[column] = *row[column];
+    }
+}
+
+///@brief Inserts row at specified index
+///@param row Vector holding instances of inserted elements
+///@param newRowIndex Index at which new row will be inserted
+template<typename T>
+void ChunkedMatrix<T>::insertRow(std::vector<T> row, int newRowIndex) {
+    MATRIX_TRACE_SCOPE("ChunkedMatrix::insertRow", getRowCount(), getColumnCount(), getColumnCount() * sizeof(T));
+    if(static_cast<int>(row.size()) != colCount)
+    {
+        throw std::invalid_argument("ChunkedMatrix::insertRow - row size does not match column count");
+    }
+    T* slot = insertRowSlot(newRowIndex);
+    std::move(row.begin(), row.end(), slot);
+}
+
+///@brief Erases matrix row by iterator
+///@param rowIter Iterator that points to removed row
+///@retval Iterator pointing to next row or endRow()
+template<typename T>
+typename ChunkedMatrix<T>::rowIterator ChunkedMatrix<T>::eraseRow(rowIterator rowIter) {
+    eraseRow(rowIter.getIndex());
+    return rowIter;
+}
+
+///@brief Erases matrix row by index
+///@note Shifts rows of one block only, block left empty is unlinked from the tree
+/// and block left under half full is merged with a neighbour
+template<typename T>
+void ChunkedMatrix<T>::eraseRow(int rowIndex) {
+    MATRIX_TRACE_SCOPE("ChunkedMatrix::eraseRow", getRowCount(), getColumnCount(), getColumnCount() * sizeof(T));
+    if(rowIndex < 0 || rowIndex >= rowCount)
+    {
+        throw std::out_of_range("ChunkedMatrix::eraseRow - index out of range");
+    }
+    int offset = rowIndex;
+    Block* block = find(offset);
+    if(block->rowCount == 1)
+    {
+        auto [before, rest] = split(std::move(root), rowIndex);
+        auto [erased, after] = split(std::move(rest), 1);
+        root = merge(std::move(before), std::move(after));
+        rowCount--;
+        return;
+    }
+    auto first = block->data.begin() + static_cast<std::ptrdiff_t>(offset) * colCount;
+    block->data.erase(first, first + colCount);
+
+    //Row counts change along the path from root to the block
+    int row = rowIndex;
+    Block* node = root.get();
+    while(node != block)
+    {
+        node->subtreeRowCount--;
+        int leftRows = subtreeRows(node->left);
+        if(row < leftRows)
+        {
+            node = node->left.get();
+        }
+        else
+        {
+            row -= leftRows + node->rowCount;
+            node = node->right.get();
+        }
+    }
+    block->rowCount--;
+    block->subtreeRowCount--;
+    rowCount--;
+    if(2 * block->rowCount < blockRows())
+    {
+        mergeNeighbour(rowIndex - offset, block->rowCount);
+    }
+}
+
+///@brief Inserts column at specified index
+///@param column Vector holding pointers to inserted elements
+///@param newColIndex Index at which new column will be inserted
+template<typename T>
+void ChunkedMatrix<T>::insertColumn(std::vector<T *> column, int newColIndex) {
+    insertColumnFrom(column, newColIndex);
+}
+
+///@brief Inserts column at specified index
+///@param column Vector holding instances of inserted elements
+///@param newColIndex Index at which new column will be inserted
+template<typename T>
+void ChunkedMatrix<T>::insertColumn(std::vector<T> column, int newColIndex) {
+    insertColumnFrom(column, newColIndex);
+}
+
+///@brief Erases matrix column by iterator
+///@param columnIter Iterator that points to removed column
+///@retval Iterator pointing to next column or endColumn()
+template<typename T>
+typename ChunkedMatrix<T>::columnIterator ChunkedMatrix<T>::eraseColumn(columnIterator columnIter) {
+    eraseColumn(columnIter.getIndex());
+    return columnIter;
+}
+
+///@brief Erases matrix column by index
+///@note Rewrites every row, rows are repacked into full blocks for the narrower row size
+template<typename T>
+void ChunkedMatrix<T>::eraseColumn(int columnIndex) {
+    MATRIX_TRACE_SCOPE("ChunkedMatrix::eraseColumn", getRowCount(), getColumnCount(),
+                       2 * static_cast<std::int64_t>(getRowCount()) * getColumnCount() * sizeof(T));
+    if(columnIndex < 0 || columnIndex >= colCount)
+    {
+        throw std::out_of_range("ChunkedMatrix::eraseColumn - index out of range");
+    }
+    rebuildRows(colCount - 1, [this, columnIndex](const T* source, std::vector<T>& destination) {
+        destination.insert(destination.end(), source, source + columnIndex);
+        destination.insert(destination.end(), source + columnIndex + 1, source + colCount);
+    });
+}
+
+///@brief Copies elements into contiguous matrix
+template<typename T>
+Matrix<T> ChunkedMatrix<T>::toMatrix() {
+    MATRIX_TRACE_SCOPE("ChunkedMatrix::toMatrix", getRowCount(), getColumnCount(),
+                       2 * static_cast<std::int64_t>(getRowCount()) * getColumnCount() * sizeof(T));
+    Matrix<T> result(rowCount, colCount);
+    auto destination = result.begin();
+    for(std::span<const T> row : constRows())
+    {
+        destination = std::copy(row.begin(), row.end(), destination);
+    }
+    return result;
+}
+
+///@brief Gets amount of rows per block, blocks are split when they grow to twice this size
+template<typename T>
+int ChunkedMatrix<T>::blockRows() {
+    std::size_t rowBytes = std::max<std::size_t>(1, sizeof(T) * static_cast<std::size_t>(colCount));
+    return static_cast<int>(std::max<std::size_t>(1, blockBytes / rowBytes));
+}
+
+template<typename T>
+int ChunkedMatrix<T>::subtreeRows(const std::unique_ptr<Block> &block) {
+    return block ? block->subtreeRowCount : 0;
+}
+
+template<typename T>
+void ChunkedMatrix<T>::update(Block *block) {
+    block->subtreeRowCount = subtreeRows(block->left) + block->rowCount + subtreeRows(block->right);
+}
+
+template<typename T>
+std::unique_ptr<typename ChunkedMatrix<T>::Block> ChunkedMatrix<T>::clone(const std::unique_ptr<Block> &block) {
+    if(!block)
+    {
+        return nullptr;
+    }
+    std::unique_ptr<Block> copy(new Block{block->data, block->rowCount, block->subtreeRowCount, block->priority,
+                                          nullptr, nullptr});
+    copy->left = clone(block->left);
+    copy->right = clone(block->right);
+    return copy;
+}
+
+///@brief Splits tree into blocks holding first rows and the rest
+///@note rows must fall on a block boundary
+template<typename T>
+std::pair<std::unique_ptr<typename ChunkedMatrix<T>::Block>, std::unique_ptr<typename ChunkedMatrix<T>::Block>>
+ChunkedMatrix<T>::split(std::unique_ptr<Block> block, int rows) {
+    if(!block)
+    {
+        return {nullptr, nullptr};
+    }
+    int leftRows = subtreeRows(block->left);
+    if(rows <= leftRows)
+    {
+        auto [lhs, rhs] = split(std::move(block->left), rows);
+        block->left = std::move(rhs);
+        update(block.get());
+        return {std::move(lhs), std::move(block)};
+    }
+    auto [lhs, rhs] = split(std::move(block->right), rows - leftRows - block->rowCount);
+    block->right = std::move(lhs);
+    update(block.get());
+    return {std::move(block), std::move(rhs)};
+}
+
+///@brief Concatenates two trees, every row of lhs goes before rows of rhs
+template<typename T>
+std::unique_ptr<typename ChunkedMatrix<T>::Block> ChunkedMatrix<T>::merge(std::unique_ptr<Block> lhs,
+                                                                          std::unique_ptr<Block> rhs) {
+    if(!lhs)
+    {
+        return rhs;
+    }
+    if(!rhs)
+    {
+        return lhs;
+    }
+    if(lhs->priority > rhs->priority)
+    {
+        lhs->right = merge(std::move(lhs->right), std::move(rhs));
+        update(lhs.get());
+        return lhs;
+    }
+    rhs->left = merge(std::move(lhs), std::move(rhs->left));
+    update(rhs.get());
+    return rhs;
+}
+
+template<typename T>
+std::unique_ptr<typename ChunkedMatrix<T>::Block> ChunkedMatrix<T>::makeBlock(std::vector<T> data, int rows) {
+    return std::unique_ptr<Block>(new Block{std::move(data), rows, rows, static_cast<unsigned>(priorities()),
+                                            nullptr, nullptr});
+}
+
+///@brief Finds block holding row
+///@param row Row index, receives row offset inside the found block
+template<typename T>
+typename ChunkedMatrix<T>::Block* ChunkedMatrix<T>::find(int &row) const {
+    Block* block = root.get();
+    while(true)
+    {
+        int leftRows = subtreeRows(block->left);
+        if(row < leftRows)
+        {
+            block = block->left.get();
+        }
+        else if(row < leftRows + block->rowCount)
+        {
+            row -= leftRows;
+            return block;
+        }
+        else
+        {
+            row -= leftRows + block->rowCount;
+            block = block->right.get();
+        }
+    }
+}
+
+template<typename T>
+T* ChunkedMatrix<T>::rowPointer(int row) const {
+    Block* block = find(row);
+    return block->data.data() + static_cast<std::ptrdiff_t>(row) * colCount;
+}
+
+///@brief Opens space for a row at newRowIndex
+///@retval Pointer to colCount default constructed elements of the new row
+template<typename T>
+T* ChunkedMatrix<T>::insertRowSlot(int newRowIndex) {
+    if(newRowIndex < 0 || newRowIndex > rowCount)
+    {
+        throw std::out_of_range("ChunkedMatrix::insertRow - index out of range");
+    }
+    if(!root)
+    {
+        insertBlock(0, makeBlock(std::vector<T>(colCount), 1));
+        return rowPointer(newRowIndex);
+    }
+
+    //Row appended after the last row goes to the last block
+    int offset = newRowIndex == rowCount ? newRowIndex - 1 : newRowIndex;
+    Block* block = find(offset);
+    if(newRowIndex == rowCount)
+    {
+        offset++;
+    }
+    auto position = block->data.begin() + static_cast<std::ptrdiff_t>(offset) * colCount;
+    block->data.insert(position, colCount, T());
+
+    int row = newRowIndex == rowCount ? newRowIndex - 1 : newRowIndex;
+    Block* node = root.get();
+    while(node != block)
+    {
+        node->subtreeRowCount++;
+        int leftRows = subtreeRows(node->left);
+        if(row < leftRows)
+        {
+            node = node->left.get();
+        }
+        else
+        {
+            row -= leftRows + node->rowCount;
+            node = node->right.get();
+        }
+    }
+    block->rowCount++;
+    block->subtreeRowCount++;
+    rowCount++;
+
+    if(block->rowCount >= 2 * blockRows())
+    {
+        //Upper half of the block moves to a new block linked right after it
+        int blockStart = newRowIndex - offset;
+        int total = block->rowCount;
+        auto [before, rest] = split(std::move(root), blockStart);
+        auto [current, after] = split(std::move(rest), total);
+        int kept = total / 2;
+        auto middle = current->data.begin() + static_cast<std::ptrdiff_t>(kept) * colCount;
+        std::vector<T> upper(std::make_move_iterator(middle), std::make_move_iterator(current->data.end()));
+        current->data.erase(middle, current->data.end());
+        current->rowCount = kept;
+        update(current.get());
+        std::unique_ptr<Block> next = makeBlock(std::move(upper), total - kept);
+        root = merge(merge(std::move(before), std::move(current)), merge(std::move(next), std::move(after)));
+    }
+    return rowPointer(newRowIndex);
+}
+
+///@brief Merges block with the next block, or with the previous one if it is the last block
+///@note Blocks are merged only if the result stays below 2 * blockRows() rows, which would split it again
+///@param blockStart Index of the first row of the block
+///@param rows Row count of the block
+template<typename T>
+void ChunkedMatrix<T>::mergeNeighbour(int blockStart, int rows) {
+    int limit = 2 * blockRows();
+    auto [before, rest] = split(std::move(root), blockStart);
+    auto [current, after] = split(std::move(rest), rows);
+    if(after)
+    {
+        Block* next = after.get();
+        while(next->left)
+        {
+            next = next->left.get();
+        }
+        if(rows + next->rowCount < limit)
+        {
+            auto [following, remaining] = split(std::move(after), next->rowCount);
+            current->data.insert(current->data.end(), std::make_move_iterator(following->data.begin()),
+                                 std::make_move_iterator(following->data.end()));
+            current->rowCount += following->rowCount;
+            update(current.get());
+            after = std::move(remaining);
+        }
+    }
+    else if(before)
+    {
+        Block* previous = before.get();
+        while(previous->right)
+        {
+            previous = previous->right.get();
+        }
+        if(rows + previous->rowCount < limit)
+        {
+            int firstRows = before->subtreeRowCount - previous->rowCount;
+            auto [first, preceding] = split(std::move(before), firstRows);
+            preceding->data.insert(preceding->data.end(), std::make_move_iterator(current->data.begin()),
+                                   std::make_move_iterator(current->data.end()));
+            preceding->rowCount += current->rowCount;
+            update(preceding.get());
+            current = std::move(preceding);
+            before = std::move(first);
+        }
+    }
+    root = merge(merge(std::move(before), std::move(current)), std::move(after));
+}
+
+///@brief Calls function with every block in row order
+template<typename T>
+template<typename Function>
+void ChunkedMatrix<T>::forEachBlock(Function function) const {
+    std::vector<Block*> pending;
+    Block* block = root.get();
+    while(block || !pending.empty())
+    {
+        while(block)
+        {
+            pending.push_back(block);
+            block = block->left.get();
+        }
+        block = pending.back();
+        pending.pop_back();
+        function(*block);
+        block = block->right.get();
+    }
+}
+
+///@brief Replaces every row by transformed copy holding newColCount elements, packed into full blocks
+///@param transform Called with pointer to a row and vector to which it appends the new row
+template<typename T>
+template<typename Transform>
+void ChunkedMatrix<T>::rebuildRows(int newColCount, Transform transform) {
+    ChunkedMatrix result(0, newColCount);
+    result.priorities = priorities;
+    int rows = result.blockRows();
+    std::vector<T> pending;
+    int pendingRows = 0;
+    forEachBlock([&](Block& block) {
+        for(int row = 0; row < block.rowCount; row++)
+        {
+            if(pendingRows == 0)
+            {
+                pending.reserve(static_cast<std::size_t>(rows) * newColCount);
+            }
+            transform(block.data.data() + static_cast<std::ptrdiff_t>(row) * colCount, pending);
+            if(++pendingRows == rows)
+            {
+                result.insertBlock(result.rowCount, result.makeBlock(std::move(pending), pendingRows));
+                pending = std::vector<T>();
+                pendingRows = 0;
+            }
+        }
+    });
+    if(pendingRows > 0)
+    {
+        result.insertBlock(result.rowCount, result.makeBlock(std::move(pending), pendingRows));
+    }
+    *this = std::move(result);
+}
+
+///@brief Rewrites rows with column inserted at newColIndex
+///@param column Vector holding inserted elements or pointers to them
+template<typename T>
+template<typename Column>
+void ChunkedMatrix<T>::insertColumnFrom(const Column& column, int newColIndex) {
+    MATRIX_TRACE_SCOPE("ChunkedMatrix::insertColumn", getRowCount(), getColumnCount(),
+                       2 * static_cast<std::int64_t>(getRowCount()) * getColumnCount() * sizeof(T));
+    if(newColIndex < 0 || newColIndex > colCount)
+    {
+        throw std::out_of_range("ChunkedMatrix::insertColumn - index out of range");
+    }
+    if(static_cast<int>(column.size()) != rowCount)
+    {
+        throw std::invalid_argument("ChunkedMatrix::insertColumn - column size does not match row count");
+    }
+    if(colCount == std::numeric_limits<int>::max())
+    {
+        throw std::length_error("ChunkedMatrix::insertColumn - column count exceeds int range");
+    }
+    int row = 0;
+    rebuildRows(colCount + 1, [&](const T* source, std::vector<T>& destination) {
+        destination.insert(destination.end(), source, source + newColIndex);
+        if constexpr(std::is_pointer_v<typename Column::value_type>)
+        {
+            destination.push_back(*column[row]);
+        }
+        else
+        {
+            destination.push_back(column[row]);
+        }
+        destination.insert(destination.end(), source + newColIndex, source + colCount);
+        row++;
+    });
+}
+
+///@brief Links block so that its first row gets index firstRow
+template<typename T>
+void ChunkedMatrix<T>::insertBlock(int firstRow, std::unique_ptr<Block> block) {
+    rowCount += block->rowCount;
+    auto [before, after] = split(std::move(root), firstRow);
+    root = merge(merge(std::move(before), std::move(block)), std::move(after));
+}
+
+template<typename T>
+template<typename Value>
+typename ChunkedMatrix<T>::template ElementIterator<Value>& ChunkedMatrix<T>::ElementIterator<Value>::operator++() {
+    column++;
+    if(column == matrix->colCount)
+    {
+        column = 0;
+        row++;
+        rowData = row < matrix->rowCount ? matrix->rowPointer(row) : nullptr;
+    }
+    return *this;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ChunkedRowIterator::reference ChunkedMatrix<T>::ChunkedRowIterator::operator*() const {
+    reference temp;
+    T* data = matrix->rowPointer(index);
+    for(int i = 0; i < matrix->getColumnCount(); i++)
+    {
+        temp.push_back(std::ref(data[i]));
+    }
+    return temp;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ChunkedRowIterator::pointer ChunkedMatrix<T>::ChunkedRowIterator::operator->() {
+    pointer temp;
+    T* data = matrix->rowPointer(index);
+    for(int i = 0; i < matrix->getColumnCount(); i++)
+    {
+        temp.push_back(data + i);
+    }
+    return temp;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ConstChunkedRowIterator::reference ChunkedMatrix<T>::ConstChunkedRowIterator::operator*() const {
+    reference temp;
+    const T* data = matrix->rowPointer(index);
+    for(int i = 0; i < matrix->getColumnCount(); i++)
+    {
+        temp.push_back(std::cref(data[i]));
+    }
+    return temp;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ConstChunkedRowIterator::pointer ChunkedMatrix<T>::ConstChunkedRowIterator::operator->() {
+    pointer temp;
+    const T* data = matrix->rowPointer(index);
+    for(int i = 0; i < matrix->getColumnCount(); i++)
+    {
+        temp.push_back(data + i);
+    }
+    return temp;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ChunkedColumnIterator::reference ChunkedMatrix<T>::ChunkedColumnIterator::operator*() const {
+    reference temp;
+    temp.reserve(matrix->rowCount);
+    int colCount = matrix->colCount;
+    matrix->forEachBlock([&](Block& block) {
+        for(int row = 0; row < block.rowCount; row++)
+        {
+            temp.push_back(std::ref(block.data[static_cast<std::size_t>(row) * colCount + index]));
+        }
+    });
+    return temp;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ChunkedColumnIterator::pointer ChunkedMatrix<T>::ChunkedColumnIterator::operator->() {
+    pointer temp;
+    temp.reserve(matrix->rowCount);
+    int colCount = matrix->colCount;
+    matrix->forEachBlock([&](Block& block) {
+        for(int row = 0; row < block.rowCount; row++)
+        {
+            temp.push_back(block.data.data() + static_cast<std::ptrdiff_t>(row) * colCount + index);
+        }
+    });
+    return temp;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ConstChunkedColumnIterator::reference ChunkedMatrix<T>::ConstChunkedColumnIterator::operator*() const {
+    reference temp;
+    temp.reserve(matrix->rowCount);
+    int colCount = matrix->colCount;
+    matrix->forEachBlock([&](Block& block) {
+        for(int row = 0; row < block.rowCount; row++)
+        {
+            temp.push_back(std::cref(block.data[static_cast<std::size_t>(row) * colCount + index]));
+        }
+    });
+    return temp;
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::ConstChunkedColumnIterator::pointer ChunkedMatrix<T>::ConstChunkedColumnIterator::operator->() {
+    pointer temp;
+    temp.reserve(matrix->rowCount);
+    int colCount = matrix->colCount;
+    matrix->forEachBlock([&](Block& block) {
+        for(int row = 0; row < block.rowCount; row++)
+        {
+            temp.push_back(block.data.data() + static_cast<std::ptrdiff_t>(row) * colCount + index);
+        }
+    });
+    return temp;
+}
+
+///@brief Returns iterator pointing to top matrix row
+template<typename T>
+typename ChunkedMatrix<T>::rowIterator ChunkedMatrix<T>::beginRow() {
+    return rowIterator(0, this);
+}
+
+///@brief Returns iterator pointing past bottom matrix row
+template<typename T>
+typename ChunkedMatrix<T>::rowIterator ChunkedMatrix<T>::endRow() {
+    return rowIterator(rowCount, this);
+}
+
+///@brief Returns constant iterator pointing to top matrix row
+template<typename T>
+typename ChunkedMatrix<T>::const_rowIterator ChunkedMatrix<T>::beginConstRow() {
+    return const_rowIterator(0, this);
+}
+
+///@brief Returns constant iterator pointing past bottom matrix row
+template<typename T>
+typename ChunkedMatrix<T>::const_rowIterator ChunkedMatrix<T>::endConstRow() {
+    return const_rowIterator(rowCount, this);
+}
+
+///@brief Returns iterator pointing to leftmost matrix column
+template<typename T>
+typename ChunkedMatrix<T>::columnIterator ChunkedMatrix<T>::beginColumn() {
+    return columnIterator(0, this);
+}
+
+///@brief Returns iterator pointing past rightmost matrix column
+template<typename T>
+typename ChunkedMatrix<T>::columnIterator ChunkedMatrix<T>::endColumn() {
+    return columnIterator(colCount, this);
+}
+
+///@brief Returns constant iterator pointing to leftmost matrix column
+template<typename T>
+typename ChunkedMatrix<T>::const_columnIterator ChunkedMatrix<T>::beginConstColumn() {
+    return const_columnIterator(0, this);
+}
+
+///@brief Returns constant iterator pointing past rightmost matrix column
+template<typename T>
+typename ChunkedMatrix<T>::const_columnIterator ChunkedMatrix<T>::endConstColumn() {
+    return const_columnIterator(colCount, this);
+}
+
+///@brief Returns forward iterator pointing to first element in row-major order
+///@note Iterators are invalidated by row insertion and erasure
+template<typename T>
+typename ChunkedMatrix<T>::iterator ChunkedMatrix<T>::begin() {
+    return iterator(this, colCount == 0 ? rowCount : 0);
+}
+
+///@brief Returns forward iterator pointing past last element in row-major order
+template<typename T>
+typename ChunkedMatrix<T>::iterator ChunkedMatrix<T>::end() {
+    return iterator(this, rowCount);
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::const_iterator ChunkedMatrix<T>::cbegin() {
+    return const_iterator(this, colCount == 0 ? rowCount : 0);
+}
+
+template<typename T>
+typename ChunkedMatrix<T>::const_iterator ChunkedMatrix<T>::cend() {
+    return const_iterator(this, rowCount);
+}
+
+///@brief Returns view of matrix rows, each row is a std::span over block storage
+///@note View is invalidated by row insertion and erasure
+template<typename T>
+auto ChunkedMatrix<T>::rows() {
+    return std::views::iota(0, rowCount) | std::views::transform([this](int row) {
+        return std::span<T>(rowPointer(row), colCount);
+    });
+}
+
+///@brief Returns view of matrix rows, each row is a std::span of constant elements
+template<typename T>
+auto ChunkedMatrix<T>::constRows() {
+    return std::views::iota(0, rowCount) | std::views::transform([this](int row) {
+        return std::span<const T>(rowPointer(row), colCount);
+    });
+}
+
+#endif //MATRIX_CHUNKEDMATRIX_H
@@ -0,0 +1,328 @@
+#ifndef MATRIX_CONVOLUTION_H
+#define MATRIX_CONVOLUTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixAlgebra.h"
+#include "ThreadPool.h"
+
+///@brief Rows of one convolution tile, halo rows are added on top of this
+constexpr int convolutionTileRows = 32;
+
+///@brief Columns of one convolution tile, halo columns are added on both sides
+constexpr int convolutionTileColumns = 256;
+
+///@brief Defines values read outside of the source matrix
+enum class BorderMode {
+    Zero,  ///< Outside elements are zero
+    Clamp, ///< Outside elements repeat the nearest edge element
+    Wrap   ///< Matrix repeats periodically in both directions
+};
+
+namespace MatrixKernels {
+
+///@brief Maps index that may lie outside [0, size) according to border mode
+///@retval Index inside [0, size), or -1 if element is zero
+inline MatrixIndex borderIndex(MatrixIndex index, MatrixIndex size, BorderMode border) {
+    if(index >= 0 && index < size)
+    {
+        return index;
+    }
+    switch(border)
+    {
+        case BorderMode::Clamp:
+            return index < 0 ? 0 : size - 1;
+        case BorderMode::Wrap:
+            return ((index % size) + size) % size;
+        default:
+            return -1;
+    }
+}
+
+///@brief Thread-local scratch buffer, grown on demand and reused by later calls on the same thread
+template<typename T>
+T* convolutionScratch(int slot, std::size_t size) {
+    thread_local std::vector<T> buffers[2];
+    if(buffers[slot].size() < size)
+    {
+        buffers[slot].resize(size);
+    }
+    return buffers[slot].data();
+}
+
+///@brief Copies source region with halo into tile, resolving elements outside source by border mode
+///@param tile Destination with (tileRows + haloTop + haloBottom) rows of (tileColumns + haloLeft + haloRight) elements
+template<typename T>
+void loadTile(const T* source, MatrixIndex rows, MatrixIndex cols, MatrixIndex firstRow, MatrixIndex firstCol, int tileRows,
+              int tileColumns, int haloTop, int haloBottom, int haloLeft, int haloRight, BorderMode border, T* tile) {
+    int stride = tileColumns + haloLeft + haloRight;
+    MatrixIndex left = firstCol - haloLeft;
+    //Columns [interiorBegin, interiorEnd) of the tile row come from source without remapping
+    int interiorBegin = static_cast<int>(std::clamp<MatrixIndex>(-left, 0, stride));
+    int interiorEnd = static_cast<int>(std::clamp<MatrixIndex>(cols - left, interiorBegin, stride));
+    for(int row = 0; row < tileRows + haloTop + haloBottom; row++, tile += stride)
+    {
+        MatrixIndex sourceRow = borderIndex(firstRow - haloTop + row, rows, border);
+        if(sourceRow < 0)
+        {
+            std::fill(tile, tile + stride, T(0));
+            continue;
+        }
+        const T* sourceData = source + sourceRow * cols;
+        std::copy(sourceData + left + interiorBegin, sourceData + left + interiorEnd, tile + interiorBegin);
+        for(int column = 0; column < stride; column++)
+        {
+            if(column == interiorBegin && interiorEnd > interiorBegin)
+            {
+                column = interiorEnd - 1;
+                continue;
+            }
+            MatrixIndex sourceColumn = borderIndex(left + column, cols, border);
+            tile[column] = sourceColumn < 0 ? T(0) : sourceData[sourceColumn];
+        }
+    }
+}
+
+///@brief Tries to factor kernel into column vector times row vector
+///@retval True if kernel has rank one within rounding error
+template<typename T>
+bool separateKernel(const T* kernel, int kernelRows, int kernelColumns, std::vector<T>& columnFactor,
+                    std::vector<T>& rowFactor) {
+    int pivot = 0;
+    for(int index = 1; index < kernelRows * kernelColumns; index++)
+    {
+        if(std::abs(kernel[index]) > std::abs(kernel[pivot]))
+        {
+            pivot = index;
+        }
+    }
+    T pivotValue = kernel[pivot];
+    if(pivotValue == T(0))
+    {
+        return false;
+    }
+    int pivotRow = pivot / kernelColumns;
+    int pivotColumn = pivot % kernelColumns;
+    columnFactor.resize(kernelRows);
+    rowFactor.resize(kernelColumns);
+    for(int row = 0; row < kernelRows; row++)
+    {
+        columnFactor[row] = kernel[row * kernelColumns + pivotColumn];
+    }
+    for(int column = 0; column < kernelColumns; column++)
+    {
+        rowFactor[column] = kernel[pivotRow * kernelColumns + column] / pivotValue;
+    }
+    T tolerance = std::abs(pivotValue) * std::numeric_limits<T>::epsilon() * 16;
+    for(int row = 0; row < kernelRows; row++)
+    {
+        for(int column = 0; column < kernelColumns; column++)
+        {
+            if(std::abs(kernel[row * kernelColumns + column] - columnFactor[row] * rowFactor[column]) > tolerance)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+///@brief Correlates halo-padded tile with full kernel, one contiguous axpy per kernel element
+template<typename T>
+void convolveTile(const T* tile, int stride, int tileRows, int tileColumns, const T* kernel, int kernelRows,
+                  int kernelColumns, T* destination, MatrixIndex destinationStride) {
+    for(int row = 0; row < tileRows; row++)
+    {
+        T* output = destination + row * destinationStride;
+        std::fill(output, output + tileColumns, T(0));
+        for(int kernelRow = 0; kernelRow < kernelRows; kernelRow++)
+        {
+            const T* input = tile + (row + kernelRow) * stride;
+            for(int kernelColumn = 0; kernelColumn < kernelColumns; kernelColumn++)
+            {
+                T weight = kernel[kernelRow * kernelColumns + kernelColumn];
+                if(weight == T(0))
+                {
+                    continue;
+                }
+                axpy(weight, input + kernelColumn, output, tileColumns);
+            }
+        }
+    }
+}
+
+///@brief Correlates halo-padded tile with separable kernel as a horizontal then a vertical pass
+///@param scratch Buffer for (tileRows + columnFactor size - 1) x tileColumns intermediate values
+template<typename T>
+void convolveTileSeparable(const T* tile, int stride, int tileRows, int tileColumns,
+                           const std::vector<T>& columnFactor, const std::vector<T>& rowFactor, T* scratch,
+                           T* destination, MatrixIndex destinationStride) {
+    int kernelRows = static_cast<int>(columnFactor.size());
+    int kernelColumns = static_cast<int>(rowFactor.size());
+    for(int row = 0; row < tileRows + kernelRows - 1; row++)
+    {
+        const T* input = tile + row * stride;
+        T* output = scratch + row * tileColumns;
+        std::fill(output, output + tileColumns, T(0));
+        for(int kernelColumn = 0; kernelColumn < kernelColumns; kernelColumn++)
+        {
+            axpy(rowFactor[kernelColumn], input + kernelColumn, output, tileColumns);
+        }
+    }
+    for(int row = 0; row < tileRows; row++)
+    {
+        T* output = destination + row * destinationStride;
+        std::fill(output, output + tileColumns, T(0));
+        for(int kernelRow = 0; kernelRow < kernelRows; kernelRow++)
+        {
+            axpy(columnFactor[kernelRow], scratch + (row + kernelRow) * tileColumns, output, tileColumns);
+        }
+    }
+}
+
+///@brief Splits matrix into tiles and calls body(firstRow, firstCol, tileRows, tileColumns) for each on the pool
+template<typename Function>
+void forEachTile(MatrixIndex rows, MatrixIndex cols, Function body) {
+    MatrixIndex tileRowCount = (rows + convolutionTileRows - 1) / convolutionTileRows;
+    MatrixIndex tileColumnCount = (cols + convolutionTileColumns - 1) / convolutionTileColumns;
+    ThreadPool::instance().parallelFor(0, tileRowCount * tileColumnCount, 1,
+                                       [&](MatrixIndex firstTile, MatrixIndex lastTile) {
+        for(MatrixIndex tileIndex = firstTile; tileIndex < lastTile; tileIndex++)
+        {
+            MatrixIndex firstRow = tileIndex / tileColumnCount * convolutionTileRows;
+            MatrixIndex firstCol = tileIndex % tileColumnCount * convolutionTileColumns;
+            body(firstRow, firstCol, static_cast<int>(std::min<MatrixIndex>(convolutionTileRows, rows - firstRow)),
+                 static_cast<int>(std::min<MatrixIndex>(convolutionTileColumns, cols - firstCol)));
+        }
+    });
+}
+
+///@brief Checks that destination matches source dimensions and does not share its storage
+template<typename T>
+void checkDestination(Matrix<T>& source, Matrix<T>& destination, const char* message) {
+    if(source.getRowCount() != destination.getRowCount() || source.getColumnCount() != destination.getColumnCount()
+       || destination.begin() == source.cbegin())
+    {
+        throw std::invalid_argument(message);
+    }
+}
+
+}
+
+///@brief Correlates source with kernel, destination(r, c) = sum of kernel(i, j) * source(r + i - kr / 2, c + j - kc / 2)
+///@note Kernel is not flipped. Source is processed in tiles with halo on the thread pool.
+/// Rank one kernels are detected and applied as two one-dimensional passes.
+/// Scratch memory is thread-local and reused, so repeated calls with same sizes do not allocate.
+///@param source Matrix to filter
+///@param kernel Filter weights, anchored at its center element
+///@param destination Preallocated matrix with source dimensions, must not share data with source
+///@param border Values used for elements outside source
+template<std::floating_point T>
+void convolve(Matrix<T>& source, Matrix<T>& kernel, Matrix<T>& destination, BorderMode border = BorderMode::Zero) {
+    MATRIX_TRACE_SCOPE("convolve", source.getRowCount(), source.getColumnCount(),
+                       static_cast<std::int64_t>(source.getSize()) * sizeof(T) * 2);
+    MatrixKernels::checkDestination(source, destination, "convolve - destination must match source and not alias it");
+    if(kernel.getSize() == 0)
+    {
+        throw std::invalid_argument("convolve - empty kernel");
+    }
+    //Tile and kernel offsets are computed in int, halo-padded tiles must fit in that range
+    if((convolutionTileRows + kernel.getRowCount()) * (convolutionTileColumns + kernel.getColumnCount()) >
+       std::numeric_limits<int>::max())
+    {
+        throw std::length_error("convolve - kernel too large");
+    }
+    int kernelRows = static_cast<int>(kernel.getRowCount());
+    int kernelColumns = static_cast<int>(kernel.getColumnCount());
+    const T* weights = kernel.cbegin();
+    std::vector<T> columnFactor;
+    std::vector<T> rowFactor;
+    //Two passes also write and reread an intermediate tile, which only pays off for kernels larger than 3x3
+    bool separable = kernelRows * kernelColumns > 2 * (kernelRows + kernelColumns) &&
+            MatrixKernels::separateKernel(weights, kernelRows, kernelColumns, columnFactor, rowFactor);
+
+    MatrixIndex rows = source.getRowCount();
+    MatrixIndex cols = source.getColumnCount();
+    int haloTop = kernelRows / 2;
+    int haloLeft = kernelColumns / 2;
+    int stride = convolutionTileColumns + kernelColumns - 1;
+    const T* sourceData = source.cbegin();
+    T* destinationData = destination.begin();
+    MatrixKernels::forEachTile(rows, cols, [&](MatrixIndex firstRow, MatrixIndex firstCol, int tileRows,
+                                                 int tileColumns) {
+        T* tile = MatrixKernels::convolutionScratch<T>(0, static_cast<std::size_t>(stride) *
+                                                          (convolutionTileRows + kernelRows - 1));
+        MatrixKernels::loadTile(sourceData, rows, cols, firstRow, firstCol, tileRows, tileColumns, haloTop,
+                                kernelRows - 1 - haloTop, haloLeft, kernelColumns - 1 - haloLeft, border, tile);
+        int tileStride = tileColumns + kernelColumns - 1;
+        T* output = destinationData + firstRow * cols + firstCol;
+        if(separable)
+        {
+            T* scratch = MatrixKernels::convolutionScratch<T>(1, static_cast<std::size_t>(convolutionTileColumns) *
+                                                                 (convolutionTileRows + kernelRows - 1));
+            MatrixKernels::convolveTileSeparable(tile, tileStride, tileRows, tileColumns, columnFactor, rowFactor,
+                                                 scratch, output, cols);
+        }
+        else
+        {
+            MatrixKernels::convolveTile(tile, tileStride, tileRows, tileColumns, weights, kernelRows, kernelColumns,
+                                        output, cols);
+        }
+    });
+}
+
+///@brief Applies custom stencil to every element of source
+///@note stencil(center, stride) receives pointer to the source element inside a halo-padded tile,
+/// neighbour (dr, dc) with |dr|, |dc| <= radius is center[dr * stride + dc]. Tiles run on the thread pool.
+///@param source Matrix to filter
+///@param destination Preallocated matrix with source dimensions, must not share data with source
+///@param radius Largest row or column distance read by stencil
+///@param stencil Callable returning destination value
+///@param border Values used for elements outside source
+template<typename T, typename Stencil>
+void applyStencil(Matrix<T>& source, Matrix<T>& destination, int radius, Stencil stencil,
+                  BorderMode border = BorderMode::Zero) {
+    MATRIX_TRACE_SCOPE("applyStencil", source.getRowCount(), source.getColumnCount(),
+                       static_cast<std::int64_t>(source.getSize()) * sizeof(T) * 2);
+    MatrixKernels::checkDestination(source, destination,
+                                    "applyStencil - destination must match source and not alias it");
+    if(radius < 0)
+    {
+        throw std::invalid_argument("applyStencil - negative radius");
+    }
+    //Tile offsets are computed in int, halo-padded tiles must fit in that range
+    if((convolutionTileRows + 2 * static_cast<MatrixIndex>(radius)) *
+       (convolutionTileColumns + 2 * static_cast<MatrixIndex>(radius)) > std::numeric_limits<int>::max())
+    {
+        throw std::length_error("applyStencil - radius too large");
+    }
+    MatrixIndex rows = source.getRowCount();
+    MatrixIndex cols = source.getColumnCount();
+    const T* sourceData = source.cbegin();
+    T* destinationData = destination.begin();
+    MatrixKernels::forEachTile(rows, cols, [&](MatrixIndex firstRow, MatrixIndex firstCol, int tileRows,
+                                                 int tileColumns) {
+        int tileStride = tileColumns + 2 * radius;
+        T* tile = MatrixKernels::convolutionScratch<T>(0, static_cast<std::size_t>(convolutionTileColumns + 2 * radius) *
+                                                          (convolutionTileRows + 2 * radius));
+        MatrixKernels::loadTile(sourceData, rows, cols, firstRow, firstCol, tileRows, tileColumns, radius, radius,
+                                radius, radius, border, tile);
+        for(int row = 0; row < tileRows; row++)
+        {
+            const T* center = tile + (row + radius) * tileStride + radius;
+            T* output = destinationData + (firstRow + row) * cols + firstCol;
+            for(int column = 0; column < tileColumns; column++)
+            {
+                output[column] = stencil(center + column, tileStride);
+            }
+        }
+    });
+}
+
+#endif //MATRIX_CONVOLUTION_H
@@ -0,0 +1,106 @@
+#include "CpuDispatch.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+///@brief Gets lower case name of instruction set as accepted by MATRIX_ISA
+const char* cpuIsaName(CpuIsa isa) {
+    switch(isa)
+    {
+        case CpuIsa::SSE2:
+            return "sse2";
+        case CpuIsa::AVX2:
+            return "avx2";
+        case CpuIsa::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+///@brief Parses instruction set name
+///@param name Name as returned by cpuIsaName()
+///@param isa Receives parsed instruction set
+///@retval False if name is unknown, isa is left unchanged
+bool cpuIsaFromName(const char* name, CpuIsa& isa) {
+    for(CpuIsa candidate : {CpuIsa::Scalar, CpuIsa::SSE2, CpuIsa::AVX2, CpuIsa::AVX512})
+    {
+        if(std::strcmp(name, cpuIsaName(candidate)) == 0)
+        {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+///@brief Checks whether kernels for instruction set are built into the library and can run on this CPU
+bool isCpuIsaSupported(CpuIsa isa) {
+#ifdef MATRIX_HAS_X86_KERNELS
+    switch(isa)
+    {
+        case CpuIsa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case CpuIsa::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case CpuIsa::AVX512:
+            return __builtin_cpu_supports("avx512f");
+        default:
+            return true;
+    }
+#else
+    return isa == CpuIsa::Scalar;
+#endif
+}
+
+///@brief Gets most capable instruction set supported by this CPU
+CpuIsa detectCpuIsa() {
+    for(CpuIsa isa : {CpuIsa::AVX512, CpuIsa::AVX2, CpuIsa::SSE2})
+    {
+        if(isCpuIsaSupported(isa))
+        {
+            return isa;
+        }
+    }
+    return CpuIsa::Scalar;
+}
+
+///@brief Gets instruction set used by cpuKernels()
+///@note MATRIX_ISA environment variable caps the detected instruction set, unknown values are ignored
+CpuIsa activeCpuIsa() {
+    static const CpuIsa active = []() {
+        CpuIsa detected = detectCpuIsa();
+        CpuIsa requested = detected;
+        const char* name = std::getenv(cpuIsaEnvironmentVariable);
+        if(name != nullptr && cpuIsaFromName(name, requested) && requested < detected)
+        {
+            return requested;
+        }
+        return detected;
+    }();
+    return active;
+}
+
+///@brief Gets kernels for instruction set
+///@note Instruction sets that are not supported fall back to the scalar kernels
+const CpuKernels& cpuKernels(CpuIsa isa) {
+    if(!isCpuIsaSupported(isa))
+    {
+        return CpuKernelVariants::scalar;
+    }
+#ifdef MATRIX_HAS_X86_KERNELS
+    switch(isa)
+    {
+        case CpuIsa::SSE2:
+            return CpuKernelVariants::sse2;
+        case CpuIsa::AVX2:
+            return CpuKernelVariants::avx2;
+        case CpuIsa::AVX512:
+            return CpuKernelVariants::avx512;
+        default:
+            break;
+    }
+#endif
+    return CpuKernelVariants::scalar;
+}
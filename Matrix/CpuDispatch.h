@@ -0,0 +1,54 @@
+#ifndef MATRIX_CPUDISPATCH_H
+#define MATRIX_CPUDISPATCH_H
+
+#include <cstdint>
+
+///@brief Instruction set variants of numeric kernels, ordered from least to most capable
+enum class CpuIsa {
+    Scalar,
+    SSE2,
+    AVX2,   ///< AVX2 together with FMA
+    AVX512  ///< AVX-512 Foundation
+};
+
+///@brief Table of numeric kernels compiled for one instruction set
+///@note Every variant lives in its own translation unit built with matching compiler flags
+struct CpuKernels {
+    float (*dotFloat)(const float* lhs, const float* rhs, int size);
+    double (*dotDouble)(const double* lhs, const double* rhs, int size);
+    void (*axpyFloat)(float alpha, const float* x, float* y, int size);
+    void (*axpyDouble)(double alpha, const double* x, double* y, int size);
+    std::int64_t (*andPopcount)(const std::uint64_t* lhs, const std::uint64_t* rhs, int size); ///< Set bits of lhs & rhs
+    void (*minPlusFloat)(float alpha, const float* x, float* y, int size); ///< y = min(y, alpha + x)
+    void (*minPlusInt)(int alpha, const int* x, int* y, int size); ///< y = min(y, alpha + x), INT_MAX is infinite
+};
+
+const char* cpuIsaName(CpuIsa isa);
+bool cpuIsaFromName(const char* name, CpuIsa& isa);
+bool isCpuIsaSupported(CpuIsa isa);
+CpuIsa detectCpuIsa();
+CpuIsa activeCpuIsa();
+const CpuKernels& cpuKernels(CpuIsa isa);
+
+///@brief Environment variable that caps the selected instruction set, e.g. MATRIX_ISA=sse2
+constexpr const char* cpuIsaEnvironmentVariable = "MATRIX_ISA";
+
+namespace CpuKernelVariants {
+
+extern const CpuKernels scalar;
+#ifdef MATRIX_HAS_X86_KERNELS
+extern const CpuKernels sse2;
+extern const CpuKernels avx2;
+extern const CpuKernels avx512;
+#endif
+
+}
+
+///@brief Gets kernels selected for this process
+///@note Selection happens once, on first call
+inline const CpuKernels& cpuKernels() {
+    static const CpuKernels& selected = cpuKernels(activeCpuIsa());
+    return selected;
+}
+
+#endif //MATRIX_CPUDISPATCH_H
@@ -0,0 +1,168 @@
+#include "CpuDispatch.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+//Built with -mavx2 -mfma
+
+namespace {
+
+float horizontalSum(__m256 value) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+double horizontalSum(__m256d value) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+    sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+    return _mm_cvtsd_f64(sum);
+}
+
+float dotFloat(const float* lhs, const float* rhs, int size) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    int index = 0;
+    for(; index + 16 <= size; index += 16)
+    {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + index), _mm256_loadu_ps(rhs + index), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + index + 8), _mm256_loadu_ps(rhs + index + 8), sum1);
+    }
+    if(index + 8 <= size)
+    {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + index), _mm256_loadu_ps(rhs + index), sum0);
+        index += 8;
+    }
+    float sum = horizontalSum(_mm256_add_ps(sum0, sum1));
+    for(; index < size; index++)
+    {
+        sum += lhs[index] * rhs[index];
+    }
+    return sum;
+}
+
+double dotDouble(const double* lhs, const double* rhs, int size) {
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    int index = 0;
+    for(; index + 8 <= size; index += 8)
+    {
+        sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + index), _mm256_loadu_pd(rhs + index), sum0);
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + index + 4), _mm256_loadu_pd(rhs + index + 4), sum1);
+    }
+    if(index + 4 <= size)
+    {
+        sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + index), _mm256_loadu_pd(rhs + index), sum0);
+        index += 4;
+    }
+    double sum = horizontalSum(_mm256_add_pd(sum0, sum1));
+    for(; index < size; index++)
+    {
+        sum += lhs[index] * rhs[index];
+    }
+    return sum;
+}
+
+void axpyFloat(float alpha, const float* x, float* y, int size) {
+    __m256 scale = _mm256_set1_ps(alpha);
+    int index = 0;
+    for(; index + 8 <= size; index += 8)
+    {
+        _mm256_storeu_ps(y + index, _mm256_fmadd_ps(scale, _mm256_loadu_ps(x + index), _mm256_loadu_ps(y + index)));
+    }
+    for(; index < size; index++)
+    {
+        y[index] += alpha * x[index];
+    }
+}
+
+void axpyDouble(double alpha, const double* x, double* y, int size) {
+    __m256d scale = _mm256_set1_pd(alpha);
+    int index = 0;
+    for(; index + 4 <= size; index += 4)
+    {
+        _mm256_storeu_pd(y + index, _mm256_fmadd_pd(scale, _mm256_loadu_pd(x + index), _mm256_loadu_pd(y + index)));
+    }
+    for(; index < size; index++)
+    {
+        y[index] += alpha * x[index];
+    }
+}
+
+//Bits of every nibble are counted with a vpshufb table lookup, bytes are summed by vpsadbw
+std::int64_t andPopcount(const std::uint64_t* lhs, const std::uint64_t* rhs, int size) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibbles = _mm256_set1_epi8(0x0f);
+    __m256i sum = _mm256_setzero_si256();
+    int index = 0;
+    for(; index + 4 <= size; index += 4)
+    {
+        __m256i bits = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + index)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + index)));
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(bits, nibbles)),
+                                         _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(bits, 4), nibbles)));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    std::int64_t count = _mm_cvtsi128_si64(half) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half));
+    for(; index < size; index++)
+    {
+        count += std::popcount(lhs[index] & rhs[index]);
+    }
+    return count;
+}
+
+void minPlusFloat(float alpha, const float* x, float* y, int size) {
+    //Rows with infinite weight cannot shorten any path
+    if(alpha == std::numeric_limits<float>::infinity())
+    {
+        return;
+    }
+    __m256 offset = _mm256_set1_ps(alpha);
+    int index = 0;
+    for(; index + 8 <= size; index += 8)
+    {
+        _mm256_storeu_ps(y + index, _mm256_min_ps(_mm256_add_ps(offset, _mm256_loadu_ps(x + index)),
+                                                  _mm256_loadu_ps(y + index)));
+    }
+    for(; index < size; index++)
+    {
+        y[index] = std::min(y[index], alpha + x[index]);
+    }
+}
+
+void minPlusInt(int alpha, const int* x, int* y, int size) {
+    constexpr int infinity = std::numeric_limits<int>::max();
+    if(alpha == infinity)
+    {
+        return;
+    }
+    __m256i offset = _mm256_set1_epi32(alpha);
+    __m256i infinite = _mm256_set1_epi32(infinity);
+    int index = 0;
+    for(; index + 8 <= size; index += 8)
+    {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + index));
+        //Infinite operands keep infinite sums, which never win the minimum
+        __m256i sum = _mm256_blendv_epi8(_mm256_add_epi32(offset, values), infinite,
+                                         _mm256_cmpeq_epi32(values, infinite));
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + index));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + index), _mm256_min_epi32(sum, current));
+    }
+    for(; index < size; index++)
+    {
+        if(x[index] != infinity)
+        {
+            y[index] = std::min(y[index], alpha + x[index]);
+        }
+    }
+}
+
+}
+
+const CpuKernels CpuKernelVariants::avx2 = {dotFloat, dotDouble, axpyFloat, axpyDouble, andPopcount,
+                                            minPlusFloat, minPlusInt};
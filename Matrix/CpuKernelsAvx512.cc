@@ -0,0 +1,134 @@
+#include "CpuDispatch.h"
+
+#include <immintrin.h>
+#include <limits>
+
+//Built with -mavx512f, tails use masked loads and stores instead of scalar loops
+
+namespace {
+
+float dotFloat(const float* lhs, const float* rhs, int size) {
+    __m512 sum0 = _mm512_setzero_ps();
+    __m512 sum1 = _mm512_setzero_ps();
+    int index = 0;
+    for(; index + 32 <= size; index += 32)
+    {
+        sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + index), _mm512_loadu_ps(rhs + index), sum0);
+        sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + index + 16), _mm512_loadu_ps(rhs + index + 16), sum1);
+    }
+    for(; index < size; index += 16)
+    {
+        __mmask16 mask = size - index >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (size - index)) - 1);
+        sum0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, lhs + index), _mm512_maskz_loadu_ps(mask, rhs + index), sum0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+}
+
+double dotDouble(const double* lhs, const double* rhs, int size) {
+    __m512d sum0 = _mm512_setzero_pd();
+    __m512d sum1 = _mm512_setzero_pd();
+    int index = 0;
+    for(; index + 16 <= size; index += 16)
+    {
+        sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(lhs + index), _mm512_loadu_pd(rhs + index), sum0);
+        sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(lhs + index + 8), _mm512_loadu_pd(rhs + index + 8), sum1);
+    }
+    for(; index < size; index += 8)
+    {
+        __mmask8 mask = size - index >= 8 ? __mmask8(0xFF) : __mmask8((1u << (size - index)) - 1);
+        sum0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, lhs + index), _mm512_maskz_loadu_pd(mask, rhs + index), sum0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+}
+
+void axpyFloat(float alpha, const float* x, float* y, int size) {
+    __m512 scale = _mm512_set1_ps(alpha);
+    int index = 0;
+    for(; index + 16 <= size; index += 16)
+    {
+        _mm512_storeu_ps(y + index, _mm512_fmadd_ps(scale, _mm512_loadu_ps(x + index), _mm512_loadu_ps(y + index)));
+    }
+    if(index < size)
+    {
+        __mmask16 mask = __mmask16((1u << (size - index)) - 1);
+        __m512 result = _mm512_fmadd_ps(scale, _mm512_maskz_loadu_ps(mask, x + index), _mm512_maskz_loadu_ps(mask, y + index));
+        _mm512_mask_storeu_ps(y + index, mask, result);
+    }
+}
+
+void axpyDouble(double alpha, const double* x, double* y, int size) {
+    __m512d scale = _mm512_set1_pd(alpha);
+    int index = 0;
+    for(; index + 8 <= size; index += 8)
+    {
+        _mm512_storeu_pd(y + index, _mm512_fmadd_pd(scale, _mm512_loadu_pd(x + index), _mm512_loadu_pd(y + index)));
+    }
+    if(index < size)
+    {
+        __mmask8 mask = __mmask8((1u << (size - index)) - 1);
+        __m512d result = _mm512_fmadd_pd(scale, _mm512_maskz_loadu_pd(mask, x + index), _mm512_maskz_loadu_pd(mask, y + index));
+        _mm512_mask_storeu_pd(y + index, mask, result);
+    }
+}
+
+//Foundation subset has neither vpopcntq nor byte shuffles, bits are summed within 64-bit lanes by shifts and masks
+std::int64_t andPopcount(const std::uint64_t* lhs, const std::uint64_t* rhs, int size) {
+    const __m512i pairs = _mm512_set1_epi64(0x5555555555555555ll);
+    const __m512i quads = _mm512_set1_epi64(0x3333333333333333ll);
+    const __m512i nibbles = _mm512_set1_epi64(0x0f0f0f0f0f0f0f0fll);
+    const __m512i lane = _mm512_set1_epi64(0x7f);
+    __m512i sum = _mm512_setzero_si512();
+    for(int index = 0; index < size; index += 8)
+    {
+        __mmask8 mask = size - index >= 8 ? __mmask8(0xff) : __mmask8((1u << (size - index)) - 1);
+        __m512i bits = _mm512_and_si512(_mm512_maskz_loadu_epi64(mask, lhs + index),
+                                        _mm512_maskz_loadu_epi64(mask, rhs + index));
+        bits = _mm512_sub_epi64(bits, _mm512_and_si512(_mm512_srli_epi64(bits, 1), pairs));
+        bits = _mm512_add_epi64(_mm512_and_si512(bits, quads), _mm512_and_si512(_mm512_srli_epi64(bits, 2), quads));
+        bits = _mm512_and_si512(_mm512_add_epi64(bits, _mm512_srli_epi64(bits, 4)), nibbles);
+        bits = _mm512_add_epi64(bits, _mm512_srli_epi64(bits, 8));
+        bits = _mm512_add_epi64(bits, _mm512_srli_epi64(bits, 16));
+        bits = _mm512_add_epi64(bits, _mm512_srli_epi64(bits, 32));
+        sum = _mm512_add_epi64(sum, _mm512_and_si512(bits, lane));
+    }
+    return _mm512_reduce_add_epi64(sum);
+}
+
+void minPlusFloat(float alpha, const float* x, float* y, int size) {
+    //Rows with infinite weight cannot shorten any path
+    if(alpha == std::numeric_limits<float>::infinity())
+    {
+        return;
+    }
+    __m512 offset = _mm512_set1_ps(alpha);
+    for(int index = 0; index < size; index += 16)
+    {
+        __mmask16 mask = size - index >= 16 ? __mmask16(0xffff) : __mmask16((1u << (size - index)) - 1);
+        __m512 sum = _mm512_add_ps(offset, _mm512_maskz_loadu_ps(mask, x + index));
+        _mm512_mask_storeu_ps(y + index, mask, _mm512_min_ps(sum, _mm512_maskz_loadu_ps(mask, y + index)));
+    }
+}
+
+//Lanes with infinite operands are left out of the store mask
+void minPlusInt(int alpha, const int* x, int* y, int size) {
+    constexpr int infinity = std::numeric_limits<int>::max();
+    if(alpha == infinity)
+    {
+        return;
+    }
+    __m512i offset = _mm512_set1_epi32(alpha);
+    __m512i infinite = _mm512_set1_epi32(infinity);
+    for(int index = 0; index < size; index += 16)
+    {
+        __mmask16 mask = size - index >= 16 ? __mmask16(0xffff) : __mmask16((1u << (size - index)) - 1);
+        __m512i values = _mm512_maskz_loadu_epi32(mask, x + index);
+        mask = _mm512_mask_cmpneq_epi32_mask(mask, values, infinite);
+        __m512i current = _mm512_maskz_loadu_epi32(mask, y + index);
+        _mm512_mask_storeu_epi32(y + index, mask, _mm512_min_epi32(_mm512_add_epi32(offset, values), current));
+    }
+}
+
+}
+
+const CpuKernels CpuKernelVariants::avx512 = {dotFloat, dotDouble, axpyFloat, axpyDouble, andPopcount,
+                                              minPlusFloat, minPlusInt};
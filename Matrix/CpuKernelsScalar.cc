@@ -0,0 +1,69 @@
+#include "CpuDispatch.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+//Reference variant built without instruction set flags, other variants are tested against it
+
+namespace {
+
+template<typename T>
+T dot(const T* lhs, const T* rhs, int size) {
+    T sum = 0;
+    for(int index = 0; index < size; index++)
+    {
+        sum += lhs[index] * rhs[index];
+    }
+    return sum;
+}
+
+template<typename T>
+void axpy(T alpha, const T* x, T* y, int size) {
+    for(int index = 0; index < size; index++)
+    {
+        y[index] += alpha * x[index];
+    }
+}
+
+std::int64_t andPopcount(const std::uint64_t* lhs, const std::uint64_t* rhs, int size) {
+    std::int64_t count = 0;
+    for(int index = 0; index < size; index++)
+    {
+        count += std::popcount(lhs[index] & rhs[index]);
+    }
+    return count;
+}
+
+void minPlusFloat(float alpha, const float* x, float* y, int size) {
+    //Rows with infinite weight cannot shorten any path
+    if(alpha == std::numeric_limits<float>::infinity())
+    {
+        return;
+    }
+    for(int index = 0; index < size; index++)
+    {
+        y[index] = std::min(y[index], alpha + x[index]);
+    }
+}
+
+//Infinite operands are skipped instead of added, so the sum never overflows into a short path
+void minPlusInt(int alpha, const int* x, int* y, int size) {
+    constexpr int infinity = std::numeric_limits<int>::max();
+    if(alpha == infinity)
+    {
+        return;
+    }
+    for(int index = 0; index < size; index++)
+    {
+        if(x[index] != infinity)
+        {
+            y[index] = std::min(y[index], alpha + x[index]);
+        }
+    }
+}
+
+}
+
+const CpuKernels CpuKernelVariants::scalar = {dot<float>, dot<double>, axpy<float>, axpy<double>, andPopcount,
+                                              minPlusFloat, minPlusInt};
@@ -0,0 +1,149 @@
+#include "CpuDispatch.h"
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+//Built with -msse2
+
+namespace {
+
+float dotFloat(const float* lhs, const float* rhs, int size) {
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    int index = 0;
+    for(; index + 8 <= size; index += 8)
+    {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(lhs + index), _mm_loadu_ps(rhs + index)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(lhs + index + 4), _mm_loadu_ps(rhs + index + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(sum0, sum1));
+    float sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for(; index < size; index++)
+    {
+        sum += lhs[index] * rhs[index];
+    }
+    return sum;
+}
+
+double dotDouble(const double* lhs, const double* rhs, int size) {
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    int index = 0;
+    for(; index + 4 <= size; index += 4)
+    {
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(lhs + index), _mm_loadu_pd(rhs + index)));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(lhs + index + 2), _mm_loadu_pd(rhs + index + 2)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+    double sum = lanes[0] + lanes[1];
+    for(; index < size; index++)
+    {
+        sum += lhs[index] * rhs[index];
+    }
+    return sum;
+}
+
+void axpyFloat(float alpha, const float* x, float* y, int size) {
+    __m128 scale = _mm_set1_ps(alpha);
+    int index = 0;
+    for(; index + 4 <= size; index += 4)
+    {
+        _mm_storeu_ps(y + index, _mm_add_ps(_mm_loadu_ps(y + index), _mm_mul_ps(scale, _mm_loadu_ps(x + index))));
+    }
+    for(; index < size; index++)
+    {
+        y[index] += alpha * x[index];
+    }
+}
+
+void axpyDouble(double alpha, const double* x, double* y, int size) {
+    __m128d scale = _mm_set1_pd(alpha);
+    int index = 0;
+    for(; index + 2 <= size; index += 2)
+    {
+        _mm_storeu_pd(y + index, _mm_add_pd(_mm_loadu_pd(y + index), _mm_mul_pd(scale, _mm_loadu_pd(x + index))));
+    }
+    for(; index < size; index++)
+    {
+        y[index] += alpha * x[index];
+    }
+}
+
+//SSE2 has no popcount instruction, bits are summed within bytes by shifts and masks and bytes by psadbw
+std::int64_t andPopcount(const std::uint64_t* lhs, const std::uint64_t* rhs, int size) {
+    const __m128i pairs = _mm_set1_epi8(0x55);
+    const __m128i quads = _mm_set1_epi8(0x33);
+    const __m128i nibbles = _mm_set1_epi8(0x0f);
+    __m128i sum = _mm_setzero_si128();
+    int index = 0;
+    for(; index + 2 <= size; index += 2)
+    {
+        __m128i bits = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + index)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + index)));
+        bits = _mm_sub_epi8(bits, _mm_and_si128(_mm_srli_epi64(bits, 1), pairs));
+        bits = _mm_add_epi8(_mm_and_si128(bits, quads), _mm_and_si128(_mm_srli_epi64(bits, 2), quads));
+        bits = _mm_and_si128(_mm_add_epi8(bits, _mm_srli_epi64(bits, 4)), nibbles);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(bits, _mm_setzero_si128()));
+    }
+    std::int64_t count = _mm_cvtsi128_si64(sum) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum));
+    for(; index < size; index++)
+    {
+        count += std::popcount(lhs[index] & rhs[index]);
+    }
+    return count;
+}
+
+void minPlusFloat(float alpha, const float* x, float* y, int size) {
+    //Rows with infinite weight cannot shorten any path
+    if(alpha == std::numeric_limits<float>::infinity())
+    {
+        return;
+    }
+    __m128 offset = _mm_set1_ps(alpha);
+    int index = 0;
+    for(; index + 4 <= size; index += 4)
+    {
+        _mm_storeu_ps(y + index, _mm_min_ps(_mm_add_ps(offset, _mm_loadu_ps(x + index)), _mm_loadu_ps(y + index)));
+    }
+    for(; index < size; index++)
+    {
+        y[index] = std::min(y[index], alpha + x[index]);
+    }
+}
+
+//SSE2 has no 32-bit integer minimum, smaller sums are selected with a comparison mask
+void minPlusInt(int alpha, const int* x, int* y, int size) {
+    constexpr int infinity = std::numeric_limits<int>::max();
+    if(alpha == infinity)
+    {
+        return;
+    }
+    __m128i offset = _mm_set1_epi32(alpha);
+    __m128i infinite = _mm_set1_epi32(infinity);
+    int index = 0;
+    for(; index + 4 <= size; index += 4)
+    {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + index));
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + index));
+        __m128i sum = _mm_add_epi32(offset, values);
+        __m128i smaller = _mm_andnot_si128(_mm_cmpeq_epi32(values, infinite), _mm_cmpgt_epi32(current, sum));
+        __m128i result = _mm_or_si128(_mm_and_si128(smaller, sum), _mm_andnot_si128(smaller, current));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y + index), result);
+    }
+    for(; index < size; index++)
+    {
+        if(x[index] != infinity)
+        {
+            y[index] = std::min(y[index], alpha + x[index]);
+        }
+    }
+}
+
+}
+
+const CpuKernels CpuKernelVariants::sse2 = {dotFloat, dotDouble, axpyFloat, axpyDouble, andPopcount,
+                                            minPlusFloat, minPlusInt};
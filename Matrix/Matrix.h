@@ -1,16 +1,66 @@
 #ifndef MATRIX_MATRIX_H
-#define MATRIX_MATRIX_H_H
+#define MATRIX_MATRIX_H
 
 #include <vector>
 #include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#ifdef MATRIX_HAS_EXECUTION_POLICIES
+#include <execution>
+#endif
 
 #include "MatrixImpl.h"
+#include "MatrixTrace.h"
+#include "ThreadPool.h"
+
+template <typename T>
+class MatrixPool;
+
+template <typename T>
+class MatrixProduct;
+
+template <typename T, typename R>
+class RowAggregate;
+
+template <typename T>
+class RowBandPartition;
+
+///@brief Tells whether elements are equal exactly when their bytes are equal, so matrices can be compared and hashed bytewise
+///@note Specialize to std::false_type for types whose operator== compares values although every bit pattern is distinct,
+/// such as emulated floating point types where +0 equals -0 and NaN differs from itself
+template<typename T>
+struct BytewiseComparable : std::bool_constant<std::has_unique_object_representations_v<T>> {};
 
 template <typename T>
 class Matrix {
 private:
     MatrixImpl<T>* impl;
 
+    explicit Matrix(MatrixImpl<T>* _impl);
+    void addRef();
+    void release();
+    void unshare();
+    void detach();
+    template<typename Row>
+    void insertRowFrom(const Row& row, MatrixIndex newRowIndex);
+    template<typename Column>
+    void insertColumnFrom(const Column& column, MatrixIndex newColIndex);
+    static MatrixIndex chunkSize();
+    static bool contentEquals(MatrixImpl<T>* lhsImpl, MatrixImpl<T>* rhsImpl);
+    static std::size_t hashBytes(const unsigned char* bytes, std::size_t size, std::size_t seed);
+
+    template<typename U>
+    friend class Matrix;
+    friend class MatrixPool<T>;
+    template<typename U, typename R>
+    friend class RowAggregate;
+    friend class RowBandPartition<T>;
+
 public:
     ///@brief Iterates over rows of the matrix
     class MatrixRowIterator{
@@ -20,18 +70,18 @@ public:
         using value_type        = std::vector<T>;
         using pointer           = std::vector<T*>;  // or also value_type*
         using reference         = std::vector<std::reference_wrapper<T>>;  // or also value_type&
-        int index;
+        MatrixIndex index;
         Matrix<T>* matrix;
 
     public:
-        MatrixRowIterator(int _index, Matrix<T> *_impl): index(_index), matrix(_impl){};
+        MatrixRowIterator(MatrixIndex _index, Matrix<T> *_impl): index(_index), matrix(_impl){};
         ~MatrixRowIterator() = default;
 
         MatrixRowIterator& operator++() {index++; return *this;};
         MatrixRowIterator operator++(int) {Matrix::MatrixRowIterator temp = *this; index++; return temp;};
         reference operator*() const;
         pointer operator->();
-        int getIndex();
+        MatrixIndex getIndex();
         friend bool operator== (const MatrixRowIterator& lhs, const MatrixRowIterator& rhs) {return lhs.index == rhs.index;};
         friend bool operator!= (const MatrixRowIterator& lhs, const MatrixRowIterator& rhs) {return lhs.index != rhs.index;};
     };
@@ -43,18 +93,18 @@ public:
         using value_type        = std::vector<T>;
         using pointer           = std::vector<const T*>;  // or also value_type*
         using reference         = std::vector<std::reference_wrapper<const T>>;  // or also value_type&
-        int index;
+        MatrixIndex index;
         Matrix<T>* matrix;
 
     public:
-        ConstMatrixRowIterator(int _index, Matrix<T> *_impl): index(_index), matrix(_impl){};
+        ConstMatrixRowIterator(MatrixIndex _index, Matrix<T> *_impl): index(_index), matrix(_impl){};
         ~ConstMatrixRowIterator() = default;
 
         ConstMatrixRowIterator& operator++() {index++; return *this;};
         ConstMatrixRowIterator operator++(int) {Matrix::ConstMatrixRowIterator temp = *this; index++; return temp;};
         reference operator*() const;
         pointer operator->();
-        int getIndex() {return index;};
+        MatrixIndex getIndex() {return index;};
         friend bool operator== (const ConstMatrixRowIterator& lhs, const ConstMatrixRowIterator& rhs) {return lhs.index == rhs.index;};
         friend bool operator!= (const ConstMatrixRowIterator& lhs, const ConstMatrixRowIterator& rhs) {return lhs.index != rhs.index;};
     };
@@ -67,18 +117,18 @@ public:
         using value_type        = std::vector<T>;
         using pointer           = std::vector<T*>;  // or also value_type*
         using reference         = std::vector<std::reference_wrapper<T>>;  // or also value_type&
-        int index;
+        MatrixIndex index;
         Matrix<T>* matrix;
 
     public:
-        MatrixColumnIterator(int _index, Matrix<T>* _impl): index(_index), matrix(_impl){};
+        MatrixColumnIterator(MatrixIndex _index, Matrix<T>* _impl): index(_index), matrix(_impl){};
         ~MatrixColumnIterator() = default;
 
         MatrixColumnIterator& operator++() {index++; return *this;};
         MatrixColumnIterator operator++(int) {Matrix::MatrixColumnIterator temp = *this; index++; return temp;};
         reference operator*() const;
         pointer operator->();
-        int getIndex();
+        MatrixIndex getIndex();
         friend bool operator== (const MatrixColumnIterator& lhs, const MatrixColumnIterator& rhs) {return lhs.index == rhs.index;};
         friend bool operator!= (const MatrixColumnIterator& lhs, const MatrixColumnIterator& rhs) {return lhs.index != rhs.index;};
     };
@@ -90,18 +140,18 @@ public:
         using value_type        = std::vector<T>;
         using pointer           = std::vector<const T*>;  // or also value_type*
         using reference         = std::vector<std::reference_wrapper<const T>>;  // or also value_type&
-        int index;
+        MatrixIndex index;
         Matrix<T>* matrix;
 
     public:
-        ConstMatrixColumnIterator(int _index, Matrix<T>* _impl): index(_index), matrix(_impl){};
+        ConstMatrixColumnIterator(MatrixIndex _index, Matrix<T>* _impl): index(_index), matrix(_impl){};
         ~ConstMatrixColumnIterator() = default;
 
         ConstMatrixColumnIterator& operator++() {index++; return *this;};
         ConstMatrixColumnIterator operator++(int) {Matrix::ConstMatrixColumnIterator temp = *this; index++; return temp;};
         reference operator*() const;
         pointer operator->();
-        int getIndex() {return index;};
+        MatrixIndex getIndex() {return index;};
         friend bool operator== (const ConstMatrixColumnIterator& lhs, const ConstMatrixColumnIterator& rhs) {return lhs.index == rhs.index;};
         friend bool operator!= (const ConstMatrixColumnIterator& lhs, const ConstMatrixColumnIterator& rhs) {return lhs.index != rhs.index;};
     };
@@ -110,26 +160,70 @@ public:
     typedef MatrixColumnIterator columnIterator;
     typedef ConstMatrixRowIterator const_rowIterator;
     typedef ConstMatrixColumnIterator const_columnIterator;
-
-    Matrix<T>(int row, int col);
-    Matrix<T>(Matrix&& other) noexcept; //Move constructor
-    Matrix<T>(Matrix& other); //Copy constructor
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    Matrix() noexcept;
+    Matrix(MatrixIndex row, MatrixIndex col);
+    Matrix(Matrix&& other) noexcept; //Move constructor
+    Matrix(const Matrix& other); //Copy constructor
+    Matrix(MatrixProduct<T>&& product); //Evaluates lazy product, defined in MatrixProduct.h
     ~Matrix();
     int refCount();
     rowIterator eraseRow(rowIterator rowIter);
     columnIterator eraseColumn(columnIterator columnIter);
-    void swap(Matrix& other);
-    void insertRow(std::vector<T*> row, int newRowIndex);
-    void insertColumn(std::vector<T*> column, int newColIndex);
-    void insertRow(std::vector<T> row, int newRowIndex);
-    void insertColumn(std::vector<T> column, int newColIndex);
-    int getColumnCount();
-    int getRowCount();
-    T& at(int row, int column);
-    T * ptrAt(int row, int column);
+    void swap(Matrix& other) noexcept;
+    void insertRow(std::vector<T*> row, MatrixIndex newRowIndex);
+    void insertColumn(std::vector<T*> column, MatrixIndex newColIndex);
+    void insertRow(std::vector<T> row, MatrixIndex newRowIndex);
+    void insertColumn(std::vector<T> column, MatrixIndex newColIndex);
+    MatrixIndex getColumnCount();
+    MatrixIndex getRowCount();
+    MatrixIndex getSize();
+    MatrixIndex getCapacity();
+    void reserve(MatrixIndex row, MatrixIndex col);
+    void resize(MatrixIndex newRowCount, MatrixIndex newColumnCount, const T& fill = T());
+    void reshape(MatrixIndex newRowCount, MatrixIndex newColumnCount);
+    T& at(MatrixIndex row, MatrixIndex column);
+    T * ptrAt(MatrixIndex row, MatrixIndex column);
+
+    void fill(const T& value);
+    template<typename Generator>
+    void generate(Generator generator);
+    template<typename Function>
+    void parallelForEach(Function function);
+    template<typename Function>
+    void parallelTransform(Function function);
+    template<typename U, typename Function>
+    void parallelTransform(Matrix<U>& source, Function function);
+    template<typename Function>
+    void broadcastRows(std::type_identity_t<std::span<const T>> rowVector, Function function);
+    template<typename Function>
+    void broadcastColumns(std::type_identity_t<std::span<const T>> columnVector, Function function);
+    void addRowVector(std::type_identity_t<std::span<const T>> rowVector);
+    void subtractRowVector(std::type_identity_t<std::span<const T>> rowVector);
+    void mulRowVector(std::type_identity_t<std::span<const T>> rowVector);
+    void divRowVector(std::type_identity_t<std::span<const T>> rowVector);
+    void addColumnVector(std::type_identity_t<std::span<const T>> columnVector);
+    void subtractColumnVector(std::type_identity_t<std::span<const T>> columnVector);
+    void mulColumnVector(std::type_identity_t<std::span<const T>> columnVector);
+    void divColumnVector(std::type_identity_t<std::span<const T>> columnVector);
+#ifdef MATRIX_HAS_EXECUTION_POLICIES
+    template<typename ExecutionPolicy, typename Function,
+             typename = std::enable_if_t<std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>>>
+    void parallelForEach(ExecutionPolicy&& policy, Function function);
+    template<typename ExecutionPolicy, typename Function,
+             typename = std::enable_if_t<std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>>>
+    void parallelTransform(ExecutionPolicy&& policy, Function function);
+#endif
 
     Matrix<T>& operator=(Matrix<T> &&other) noexcept;
     Matrix<T>& operator=(Matrix<T> const &other);
+    Matrix<T>& operator=(MatrixProduct<T>&& product); //Evaluates lazy product, defined in MatrixProduct.h
+
+    bool equals(const Matrix& other) const;
+    std::size_t hash() const;
+    friend bool operator==(const Matrix& lhs, const Matrix& rhs) {return lhs.equals(rhs);};
 
     rowIterator beginRow();
     rowIterator endRow();
@@ -140,13 +234,23 @@ public:
     columnIterator endColumn();
     const_columnIterator beginConstColumn();
     const_columnIterator endConstColumn();
+
+    iterator begin();
+    iterator end();
+    const_iterator cbegin();
+    const_iterator cend();
+
+    auto rows();
+    auto constRows();
+    auto columns();
+    auto constColumns();
 };
 
 template<typename T>
 typename Matrix<T>::MatrixRowIterator::reference Matrix<T>::MatrixRowIterator::operator*() const {
     reference temp;
-    int colCount = matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    MatrixIndex colCount = matrix->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
     {
         temp.push_back(std::ref(matrix->at(index,i)));
     }
@@ -157,8 +261,8 @@ typename Matrix<T>::MatrixRowIterator::reference Matrix<T>::MatrixRowIterator::o
 template<typename T>
 typename Matrix<T>::MatrixRowIterator::pointer Matrix<T>::MatrixRowIterator::operator->() {
     pointer temp;
-    int colCount = matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    MatrixIndex colCount = matrix->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
     {
         temp.push_back(matrix->ptrAt(index,i));
     }
@@ -167,17 +271,19 @@ typename Matrix<T>::MatrixRowIterator::pointer Matrix<T>::MatrixRowIterator::ope
 }
 
 template<typename T>
-int Matrix<T>::MatrixRowIterator::getIndex() {
+MatrixIndex Matrix<T>::MatrixRowIterator::getIndex() {
     return index;
 }
 
+///@note Reads shared data directly, so iteration neither detaches nor marks rows modified
 template<typename T>
 typename Matrix<T>::ConstMatrixRowIterator::reference Matrix<T>::ConstMatrixRowIterator::operator*() const {
     reference temp;
-    int colCount = this->matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    const T* data = this->matrix->impl->getData();
+    MatrixIndex colCount = this->matrix->impl->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
     {
-        temp.push_back(std::cref(this->matrix->at(this->index,i)));
+        temp.push_back(std::cref(data[this->index * colCount + i]));
     }
 
     return temp;
@@ -186,10 +292,11 @@ typename Matrix<T>::ConstMatrixRowIterator::reference Matrix<T>::ConstMatrixRowI
 template<typename T>
 typename Matrix<T>::ConstMatrixRowIterator::pointer Matrix<T>::ConstMatrixRowIterator::operator->() {
     pointer temp;
-    int colCount = this->matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    const T* data = this->matrix->impl->getData();
+    MatrixIndex colCount = this->matrix->impl->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
     {
-        temp.push_back(this->matrix->ptrAt(this->index,i));
+        temp.push_back(data + this->index * colCount + i);
     }
 
     return temp;
@@ -198,8 +305,8 @@ typename Matrix<T>::ConstMatrixRowIterator::pointer Matrix<T>::ConstMatrixRowIte
 template<typename T>
 typename Matrix<T>::MatrixColumnIterator::reference Matrix<T>::MatrixColumnIterator::operator*() const {
     reference temp;
-    int colCount = matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    MatrixIndex colCount = matrix->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
     {
         temp.push_back(std::ref(matrix->at(i,index)));
     }
@@ -210,8 +317,8 @@ typename Matrix<T>::MatrixColumnIterator::reference Matrix<T>::MatrixColumnItera
 template<typename T>
 typename Matrix<T>::MatrixColumnIterator::pointer Matrix<T>::MatrixColumnIterator::operator->() {
     pointer temp;
-    int colCount = matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    MatrixIndex colCount = matrix->getColumnCount();
+    for (MatrixIndex i = 0; i < colCount; i++)
     {
         temp.push_back(matrix->ptrAt(i,index));
     }
@@ -220,17 +327,20 @@ typename Matrix<T>::MatrixColumnIterator::pointer Matrix<T>::MatrixColumnIterato
 }
 
 template<typename T>
-int Matrix<T>::MatrixColumnIterator::getIndex() {
+MatrixIndex Matrix<T>::MatrixColumnIterator::getIndex() {
     return index;
 }
 
+///@note Reads shared data directly, so iteration neither detaches nor marks rows modified
 template<typename T>
 typename Matrix<T>::ConstMatrixColumnIterator::reference Matrix<T>::ConstMatrixColumnIterator::operator*() const {
     reference temp;
-    int colCount = this->matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    const T* data = this->matrix->impl->getData();
+    MatrixIndex rowCount = this->matrix->impl->getRowCount();
+    MatrixIndex colCount = this->matrix->impl->getColumnCount();
+    for (MatrixIndex i = 0; i < rowCount; i++)
     {
-        temp.push_back(std::cref(this->matrix->at(i,this->index)));
+        temp.push_back(std::cref(data[i * colCount + this->index]));
     }
 
     return temp;
@@ -239,42 +349,107 @@ typename Matrix<T>::ConstMatrixColumnIterator::reference Matrix<T>::ConstMatrixC
 template<typename T>
 typename Matrix<T>::ConstMatrixColumnIterator::pointer Matrix<T>::ConstMatrixColumnIterator::operator->() {
     pointer temp;
-    int colCount = this->matrix->getColumnCount();
-    for (int i = 0; i < colCount; i++)
+    const T* data = this->matrix->impl->getData();
+    MatrixIndex rowCount = this->matrix->impl->getRowCount();
+    MatrixIndex colCount = this->matrix->impl->getColumnCount();
+    for (MatrixIndex i = 0; i < rowCount; i++)
     {
-        temp.push_back(this->matrix->ptrAt(i,this->index));
+        temp.push_back(data + i * colCount + this->index);
     }
 
     return temp;
 }
 
+///@brief Adds reference of this instance to matrix data, shared empty data is not reference counted
+template<typename T>
+void Matrix<T>::addRef() {
+    if(impl != MatrixImpl<T>::empty())
+    {
+        impl->addRef();
+    }
+}
+
+///@brief Drops reference to matrix data, deleting it or handing it back to its owner when it was the last one
+template<typename T>
+void Matrix<T>::release() {
+    MatrixImplOwner<T>* owner = impl->getOwner();
+    if(owner != nullptr)
+    {
+        owner->release(impl);
+    }
+    else if(impl->removeRef() == 0)
+    {
+        delete impl;
+    }
+}
+
+///@brief Makes matrix data exclusively owned by this instance, copying it if shared
+///@note Data held by an owner such as MatrixPool is never written in place
+template<typename T>
+void Matrix<T>::unshare() {
+    MatrixImpl<T>* temp;
+    if(impl->getRefCount() != 1 || impl->getOwner() != nullptr)
+    {
+        MATRIX_TRACE_SCOPE("Matrix::detach", impl->getRowCount(), impl->getColumnCount(),
+                           2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+        temp = new MatrixImpl<T>(*impl);
+        release();
+        impl = temp;
+    }
+}
+
+///@brief Makes matrix data exclusively owned and marks all of it modified
+///@note Every mutable access path that may write any element goes through here, so cached content hash
+/// is dropped and all rows get a new version. Paths writing a known row use unshare() and mark that row.
 template<typename T>
-Matrix<T>::Matrix(int row, int col) {
+void Matrix<T>::detach() {
+    unshare();
+    impl->invalidateHash();
+    impl->markAllRowsModified();
+}
+
+///@brief Gets amount of elements processed by one parallel task
+///@note Chunks are sized to stay within L1 data cache
+template<typename T>
+MatrixIndex Matrix<T>::chunkSize() {
+    return std::max<MatrixIndex>(1, static_cast<MatrixIndex>(32 * 1024 / sizeof(T)));
+}
+
+///@brief Wraps data whose reference was already added for this instance
+template<typename T>
+Matrix<T>::Matrix(MatrixImpl<T>* _impl) :
+        impl(_impl)
+{
+}
+
+///@brief Creates 0 x 0 matrix without allocating, data is shared with every other empty handle
+template<typename T>
+Matrix<T>::Matrix() noexcept :
+        impl(MatrixImpl<T>::empty())
+{
+}
+
+template<typename T>
+Matrix<T>::Matrix(MatrixIndex row, MatrixIndex col) {
     this->impl = new MatrixImpl<T>(row,col);
 }
 
+///@brief Takes data of other, which is left as an empty 0 x 0 matrix without allocating
 template<typename T>
 Matrix<T>::Matrix(Matrix &&other) noexcept {
     this->impl = other.impl;
-    other.impl = new MatrixImpl<T>(other.getRowCount(), other.getColumnCount());
+    other.impl = MatrixImpl<T>::empty();
 }
 
 template<typename T>
-Matrix<T>::Matrix(Matrix &other) {
+Matrix<T>::Matrix(const Matrix &other) {
     this->impl = other.impl;
-    impl->addRef();
+    addRef();
 }
 
 template<typename T>
 Matrix<T>::~Matrix() {
-    if(impl->getRefCount() == 1)
-    {
-        delete this->impl;
-    }
-    else
-    {
-        impl->removeRef();
-    }
+    release();
 }
 
 ///@brief Gets current matrix data reference count
@@ -289,32 +464,31 @@ int Matrix<T>::refCount() {
 ///@retval Iterator pointing to next row or endRow()
 template<typename T>
 typename Matrix<T>::rowIterator Matrix<T>::eraseRow(Matrix::rowIterator rowIter) {
-    MatrixImpl<T>* temp = new MatrixImpl<T>(impl->getRowCount() - 1, impl->getColumnCount());
-
-    int offset = 0;
-    try {
-        for (auto iter = this->beginRow(); iter != this->endRow(); iter++) {
-            if (iter == rowIter) {
-                offset = -1;
-                continue;
-            } else {
-                temp->setRowDirect(iter.getIndex() + offset,iter.operator*());
-            }
-        }
-    } catch(...)
+    MATRIX_TRACE_SCOPE("Matrix::eraseRow", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    MatrixIndex rowCount = impl->getRowCount();
+    MatrixIndex colCount = impl->getColumnCount();
+    MatrixIndex erasedRow = rowIter.getIndex();
+    if(erasedRow < 0 || erasedRow >= rowCount)
     {
-        delete temp;
-        throw;
+        throw std::out_of_range("Matrix::eraseRow - index out of range");
     }
-
-    if(impl->getRefCount() == 1)
+    MatrixImpl<T>* temp = new MatrixImpl<T>(rowCount - 1, colCount);
+    try
     {
-        delete impl;
+        const T* source = impl->getData();
+        T* destination = temp->getData();
+        std::copy(source, source + erasedRow * colCount, destination);
+        std::copy(source + (erasedRow + 1) * colCount, source + rowCount * colCount, destination + erasedRow * colCount);
     }
-    else
+    catch(...)
     {
-        impl->removeRef();
+        delete temp;
+        throw;
     }
+
+    temp->inheritRowVersions(*impl, erasedRow);
+    release();
     impl = temp;
 
     return rowIter;
@@ -325,32 +499,34 @@ typename Matrix<T>::rowIterator Matrix<T>::eraseRow(Matrix::rowIterator rowIter)
 ///@retval Iterator pointing to next column or endColumn()
 template<typename T>
 typename Matrix<T>::columnIterator Matrix<T>::eraseColumn(Matrix::columnIterator columnIter) {
-    MatrixImpl<T>* temp = new MatrixImpl<T>(impl->getRowCount(), impl->getColumnCount() - 1);
-
-    int offset = 0;
-    try {
-        for (auto iter = this->beginColumn(); iter != this->endColumn(); iter++) {
-            if (iter == columnIter) {
-                offset = -1;
-                continue;
-            } else {
-                temp->setColumnDirect(iter.getIndex() + offset,iter.operator->());
-            }
-        }
-    } catch(...)
+    MATRIX_TRACE_SCOPE("Matrix::eraseColumn", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    MatrixIndex rowCount = impl->getRowCount();
+    MatrixIndex colCount = impl->getColumnCount();
+    MatrixIndex erasedColumn = columnIter.getIndex();
+    if(erasedColumn < 0 || erasedColumn >= colCount)
     {
-        delete temp;
-        throw;
+        throw std::out_of_range("Matrix::eraseColumn - index out of range");
     }
-
-    if(impl->getRefCount() == 1)
+    MatrixImpl<T>* temp = new MatrixImpl<T>(rowCount, colCount - 1);
+    try
     {
-        delete impl;
+        for(MatrixIndex row = 0; row < rowCount; row++)
+        {
+            const T* source = impl->getData() + row * colCount;
+            T* destination = temp->getData() + row * (colCount - 1);
+            std::copy(source, source + erasedColumn, destination);
+            std::copy(source + erasedColumn + 1, source + colCount, destination + erasedColumn);
+        }
     }
-    else
+    catch(...)
     {
-        impl->removeRef();
+        delete temp;
+        throw;
     }
+
+    temp->inheritRowVersions(*impl, 0);
+    release();
     impl = temp;
 
     return columnIter;
@@ -359,160 +535,232 @@ typename Matrix<T>::columnIterator Matrix<T>::eraseColumn(Matrix::columnIterator
 ///@brief Swaps matrix data with other matrix instance
 ///@param other Matrix to swap data with
 template<typename T>
-void Matrix<T>::swap(Matrix &other) {
+void Matrix<T>::swap(Matrix &other) noexcept {
     MatrixImpl<T>* temp = other.impl;
     other.impl = this->impl;
     this->impl = temp;
 }
 
-///@brief Inserts row at specified index
-///@param row Vector holding pointers to inserted elements
-///@param newRowIndex Index at which new row will be inserted
+///@brief Copies matrix to new storage with row inserted at newRowIndex
+///@param row Vector holding inserted elements or pointers to them
 template<typename T>
-void Matrix<T>::insertRow(std::vector<T*> row, int newRowIndex) {
-    MatrixImpl<T>* temp = new MatrixImpl<T>(impl->getRowCount() + 1, impl->getColumnCount());
-
-    int offset = 0;
-
-    for(int rowIndex = 0; rowIndex<temp->getRowCount(); rowIndex++)
+template<typename Row>
+void Matrix<T>::insertRowFrom(const Row& row, MatrixIndex newRowIndex) {
+    MATRIX_TRACE_SCOPE("Matrix::insertRow", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    MatrixIndex rowCount = impl->getRowCount();
+    MatrixIndex colCount = impl->getColumnCount();
+    if(newRowIndex < 0 || newRowIndex > rowCount)
     {
-        if(rowIndex == newRowIndex)
+        throw std::out_of_range("Matrix::insertRow - index out of range");
+    }
+    if(static_cast<MatrixIndex>(row.size()) != colCount)
+    {
+        throw std::out_of_range("Matrix::insertRow - row size does not match column count");
+    }
+    MatrixImpl<T>* temp = new MatrixImpl<T>(rowCount + 1, colCount);
+    try
+    {
+        const T* source = impl->getData();
+        T* destination = temp->getData();
+        std::copy(source, source + newRowIndex * colCount, destination);
+        for(MatrixIndex column = 0; column < colCount; column++)
         {
-            for(int colIndex = 0; colIndex<temp->getColumnCount(); colIndex++)
+            if constexpr(std::is_pointer_v<typename Row::value_type>)
             {
-                temp->at(rowIndex,colIndex) = *row.at(colIndex);
-                offset = -1; //Before row insertion impl is sampled at same row index, after insertion - one lower, since a new row has been inserted
+                destination[newRowIndex * colCount + column] = *row[column];
             }
-        } else{
-            for(int colIndex = 0; colIndex<temp->getColumnCount(); colIndex++)
+            else
             {
-                temp->at(rowIndex,colIndex) = impl->at(rowIndex+offset,colIndex);
+                destination[newRowIndex * colCount + column] = row[column];
             }
         }
+        std::copy(source + newRowIndex * colCount, source + rowCount * colCount,
+                  destination + (newRowIndex + 1) * colCount);
     }
-
-    if(impl->getRefCount() == 1)
-    {
-        delete impl;
-    }
-    else
+    catch(...)
     {
-        impl->removeRef();
+        delete temp;
+        throw;
     }
+
+    temp->inheritRowVersions(*impl, newRowIndex);
+    release();
     impl = temp;
 }
 
-///@brief Inserts row at specified index
-///@param row Vector holding instances of inserted elements
-///@param newRowIndex Index at which new row will be inserted
+///@brief Copies matrix to new storage with column inserted at newColIndex
+///@param column Vector holding inserted elements or pointers to them
 template<typename T>
-void Matrix<T>::insertRow(std::vector<T> row, int newRowIndex) {
-    MatrixImpl<T>* temp = new MatrixImpl<T>(impl->getRowCount() + 1, impl->getColumnCount());
-
-    int offset = 0;
-
-    for(int rowIndex = 0; rowIndex<temp->getRowCount(); rowIndex++)
+template<typename Column>
+void Matrix<T>::insertColumnFrom(const Column& column, MatrixIndex newColIndex) {
+    MATRIX_TRACE_SCOPE("Matrix::insertColumn", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    MatrixIndex rowCount = impl->getRowCount();
+    MatrixIndex colCount = impl->getColumnCount();
+    if(newColIndex < 0 || newColIndex > colCount)
     {
-        if(rowIndex == newRowIndex)
+        throw std::out_of_range("Matrix::insertColumn - index out of range");
+    }
+    if(static_cast<MatrixIndex>(column.size()) != rowCount)
+    {
+        throw std::out_of_range("Matrix::insertColumn - column size does not match row count");
+    }
+    MatrixImpl<T>* temp = new MatrixImpl<T>(rowCount, colCount + 1);
+    try
+    {
+        for(MatrixIndex row = 0; row < rowCount; row++)
         {
-            for(int colIndex = 0; colIndex<temp->getColumnCount(); colIndex++)
+            const T* source = impl->getData() + row * colCount;
+            T* destination = temp->getData() + row * (colCount + 1);
+            std::copy(source, source + newColIndex, destination);
+            if constexpr(std::is_pointer_v<typename Column::value_type>)
             {
-                temp->at(rowIndex,colIndex) = row.at(colIndex);
-                offset = -1; //Before row insertion impl is sampled at same row index, after insertion - one lower, since a new row has been inserted
+                destination[newColIndex] = *column[row];
             }
-        } else{
-            for(int colIndex = 0; colIndex<temp->getColumnCount(); colIndex++)
+            else
             {
-                temp->at(rowIndex,colIndex) = impl->at(rowIndex+offset,colIndex);
+                destination[newColIndex] = column[row];
             }
+            std::copy(source + newColIndex, source + colCount, destination + newColIndex + 1);
         }
     }
-
-    if(impl->getRefCount() == 1)
+    catch(...)
     {
-        delete impl;
+        delete temp;
+        throw;
     }
+
+    temp->inheritRowVersions(*impl, 0);
+    release();
     impl = temp;
 }
 
+///@brief Inserts row at specified index
+///@param row Vector holding pointers to inserted elements
+///@param newRowIndex Index at which new row will be inserted
+template<typename T>
+void Matrix<T>::insertRow(std::vector<T*> row, MatrixIndex newRowIndex) {
+    insertRowFrom(row, newRowIndex);
+}
+
+///@brief Inserts row at specified index
+///@param row Vector holding instances of inserted elements
+///@param newRowIndex Index at which new row will be inserted
+template<typename T>
+void Matrix<T>::insertRow(std::vector<T> row, MatrixIndex newRowIndex) {
+    insertRowFrom(row, newRowIndex);
+}
+
 ///@brief Inserts column at specified index
 ///@param column Vector holding pointers to inserted elements
 ///@param newColIndex Index at which new column will be inserted
 template<typename T>
-void Matrix<T>::insertColumn(std::vector<T *> column, int newColIndex) {
-    MatrixImpl<T>* temp = new MatrixImpl<T>(impl->getRowCount(), impl->getColumnCount() + 1);
+void Matrix<T>::insertColumn(std::vector<T *> column, MatrixIndex newColIndex) {
+    insertColumnFrom(column, newColIndex);
+}
 
-    int offset = 0;
+///@brief Inserts column at specified index
+///@param column Vector holding instances of inserted elements
+///@param newColIndex Index at which new column will be inserted
+template<typename T>
+void Matrix<T>::insertColumn(std::vector<T> column, MatrixIndex newColIndex) {
+    insertColumnFrom(column, newColIndex);
+}
 
-    for(int colIndex = 0; colIndex<temp->getColumnCount(); colIndex++)
-    {
-        if(colIndex == newColIndex)
-        {
-            for(int rowIndex = 0; rowIndex<temp->getRowCount(); rowIndex++)
-            {
-                temp->at(rowIndex,colIndex) = *column.at(rowIndex);
-                offset = -1; //Before row insertion impl is sampled at same row index, after insertion - one lower, since a new row has been inserted
-            }
-        } else{
-            for(int rowIndex = 0; rowIndex<temp->getRowCount(); rowIndex++)
-            {
-                temp->at(rowIndex,colIndex) = impl->at(rowIndex,colIndex+offset);
-            }
-        }
-    }
+///@brief Gets matrix column count
+///@retval Matrix column count
+template<typename T>
+MatrixIndex Matrix<T>::getColumnCount() {
+    return impl->getColumnCount();
+}
 
-    if(impl->getRefCount() == 1)
-    {
-        delete impl;
-    }
-    impl = temp;
+///@brief Gets matrix row count
+///@retval Matrix row count
+template<typename T>
+MatrixIndex Matrix<T>::getRowCount() {
+    return impl->getRowCount();
 }
 
+///@brief Gets amount of elements in matrix
+template<typename T>
+MatrixIndex Matrix<T>::getSize() {
+    return impl->getSize();
+}
 
-///@brief Inserts column at specified index
-///@param column Vector holding instances of inserted elements
-///@param newColIndex Index at which new column will be inserted
+///@brief Gets amount of elements that fit into matrix storage without reallocation
 template<typename T>
-void Matrix<T>::insertColumn(std::vector<T> column, int newColIndex) {
-    MatrixImpl<T>* temp = new MatrixImpl<T>(impl->getRowCount(), impl->getColumnCount() + 1);
+MatrixIndex Matrix<T>::getCapacity() {
+    return impl->getCapacity();
+}
 
-    int offset = 0;
+///@brief Grows matrix storage so that later resizes up to row x col do not reallocate
+///@param row Row count to reserve storage for
+///@param col Column count to reserve storage for
+template<typename T>
+void Matrix<T>::reserve(MatrixIndex row, MatrixIndex col) {
+    MATRIX_TRACE_SCOPE("Matrix::reserve", row, col, static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    unshare();
+    impl->reserve(row, col);
+}
 
-    for(int colIndex = 0; colIndex<temp->getColumnCount(); colIndex++)
+///@brief Changes matrix dimensions keeping elements at their row and column
+///@note Exclusively owned data is resized inside its storage when capacity allows.
+/// Shared data is not copied in full, only elements kept by the resize are copied to new storage.
+///@param newRowCount Row count after resize
+///@param newColumnCount Column count after resize
+///@param fill Value of elements not present before resize
+template<typename T>
+void Matrix<T>::resize(MatrixIndex newRowCount, MatrixIndex newColumnCount, const T &fill) {
+    MatrixIndex newSize = MatrixImpl<T>::checkedSize(newRowCount, newColumnCount);
+    MATRIX_TRACE_SCOPE("Matrix::resize", newRowCount, newColumnCount, static_cast<std::int64_t>(newSize) * sizeof(T));
+    if(impl->getRefCount() == 1 && impl->getOwner() == nullptr)
     {
-        if(colIndex == newColIndex)
+        impl->resize(newRowCount, newColumnCount, fill);
+        return;
+    }
+    MatrixImpl<T>* temp = new MatrixImpl<T>(newRowCount, newColumnCount);
+    try
+    {
+        MatrixIndex keptRows = std::min(newRowCount, impl->getRowCount());
+        MatrixIndex keptColumns = std::min(newColumnCount, impl->getColumnCount());
+        const T* source = impl->getData();
+        T* destination = temp->getData();
+        for(MatrixIndex row = 0; row < keptRows; row++)
         {
-            for(int rowIndex = 0; rowIndex<temp->getRowCount(); rowIndex++)
-            {
-                temp->at(rowIndex,colIndex) = column.at(rowIndex);
-                offset = -1; //Before row insertion impl is sampled at same row index, after insertion - one lower, since a new row has been inserted
-            }
-        } else{
-            for(int rowIndex = 0; rowIndex<temp->getRowCount(); rowIndex++)
-            {
-                temp->at(rowIndex,colIndex) = impl->at(rowIndex,colIndex+offset);
-            }
+            std::copy(source + row * impl->getColumnCount(), source + row * impl->getColumnCount() + keptColumns,
+                      destination + row * newColumnCount);
+            std::fill(destination + row * newColumnCount + keptColumns, destination + (row + 1) * newColumnCount,
+                      fill);
         }
+        std::fill(destination + keptRows * newColumnCount, destination + newSize, fill);
     }
-
-    if(impl->getRefCount() == 1)
+    catch(...)
     {
-        delete impl;
+        delete temp;
+        throw;
     }
+    temp->inheritRowVersions(*impl, 0);
+    release();
     impl = temp;
 }
-///@brief Gets matrix column count
-///@retval Matrix column count
-template<typename T>
-int Matrix<T>::getColumnCount() {
-    return impl->getColumnCount();
-}
 
-///@brief Gets matrix row count
-///@retval Matrix row count
+///@brief Reinterprets row-major elements with new dimensions
+///@note Exclusively owned data is not copied, shared data is detached first since dimensions are part of it
+///@param newRowCount Row count after reshape
+///@param newColumnCount Column count after reshape, newRowCount * newColumnCount must equal element count
 template<typename T>
-int Matrix<T>::getRowCount() {
-    return impl->getRowCount();
+void Matrix<T>::reshape(MatrixIndex newRowCount, MatrixIndex newColumnCount) {
+    MATRIX_TRACE_SCOPE("Matrix::reshape", newRowCount, newColumnCount, 0);
+    //Element count is compared by division first, so dimensions whose product overflows are rejected without computing it
+    MatrixIndex size = impl->getSize();
+    if(newRowCount < 0 || newColumnCount < 0 || (newColumnCount != 0 && newRowCount > size / newColumnCount) ||
+       newRowCount * newColumnCount != size)
+    {
+        throw std::invalid_argument("Matrix::reshape - element count does not match");
+    }
+    detach();
+    impl->reshape(newRowCount, newColumnCount);
 }
 
 ///@brief Returns reference to object at specified row and column coordinates
@@ -520,18 +768,12 @@ int Matrix<T>::getRowCount() {
 ///@param column Zero-base column index
 ///@retval Reference to object at specified coordinates
 template<typename T>
-T &Matrix<T>::at(int row, int column) {
-    if(row >= this->getRowCount() || column >= this->getColumnCount())
+T &Matrix<T>::at(MatrixIndex row, MatrixIndex column) {
+    if(row < 0 || column < 0 || row >= this->getRowCount() || column >= this->getColumnCount())
     {
         throw std::out_of_range("Matrix::at - index out of range");
     }
-    MatrixImpl<T>* temp;
-    if(impl->getRefCount() != 1)
-    {
-        temp = new MatrixImpl<T>(*impl);
-        impl->removeRef();
-        impl = temp;
-    }
+    unshare();
     return impl->at(row,column);
 }
 
@@ -540,41 +782,346 @@ T &Matrix<T>::at(int row, int column) {
 ///@param column Zero-base column index
 ///@retval Pointer to object at specified coordinates
 template<typename T>
-T * Matrix<T>::ptrAt(int row, int column) {
-    MatrixImpl<T>* temp;
-    if(impl->getRefCount() != 1)
+T * Matrix<T>::ptrAt(MatrixIndex row, MatrixIndex column) {
+    unshare();
+    return impl->ptrAt(row,column);
+}
+
+///@brief Assigns value to every matrix element
+///@param value Value copied to every element
+template<typename T>
+void Matrix<T>::fill(const T& value) {
+    MATRIX_TRACE_SCOPE("Matrix::fill", impl->getRowCount(), impl->getColumnCount(),
+                       static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    detach();
+    T* data = impl->getData();
+    ThreadPool::instance().parallelFor(0, impl->getSize(), chunkSize(), [data, &value](MatrixIndex begin, MatrixIndex end) {
+        std::fill(data + begin, data + end, value);
+    });
+}
+
+///@brief Assigns every matrix element with value returned by generator
+///@note Generator is called concurrently from several threads and in unspecified order
+///@param generator Callable taking zero-based row and column indexes and returning element value
+template<typename T>
+template<typename Generator>
+void Matrix<T>::generate(Generator generator) {
+    MATRIX_TRACE_SCOPE("Matrix::generate", impl->getRowCount(), impl->getColumnCount(),
+                       static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    detach();
+    T* data = impl->getData();
+    MatrixIndex colCount = impl->getColumnCount();
+    ThreadPool::instance().parallelFor(0, impl->getSize(), chunkSize(), [data, colCount, &generator](MatrixIndex begin, MatrixIndex end) {
+        for(MatrixIndex index = begin; index < end; index++)
+        {
+            data[index] = generator(index / colCount, index % colCount);
+        }
+    });
+}
+
+///@brief Calls function for every matrix element using all pool threads
+///@note Function is called concurrently from several threads and in unspecified order
+///@param function Callable taking reference to element
+template<typename T>
+template<typename Function>
+void Matrix<T>::parallelForEach(Function function) {
+    MATRIX_TRACE_SCOPE("Matrix::parallelForEach", impl->getRowCount(), impl->getColumnCount(),
+                       static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    detach();
+    T* data = impl->getData();
+    ThreadPool::instance().parallelFor(0, impl->getSize(), chunkSize(), [data, &function](MatrixIndex begin, MatrixIndex end) {
+        std::for_each(data + begin, data + end, function);
+    });
+}
+
+///@brief Replaces every matrix element with result of function applied to it
+///@note Function is called concurrently from several threads and in unspecified order
+///@param function Callable taking element and returning new element value
+template<typename T>
+template<typename Function>
+void Matrix<T>::parallelTransform(Function function) {
+    MATRIX_TRACE_SCOPE("Matrix::parallelTransform", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    detach();
+    T* data = impl->getData();
+    ThreadPool::instance().parallelFor(0, impl->getSize(), chunkSize(), [data, &function](MatrixIndex begin, MatrixIndex end) {
+        std::transform(data + begin, data + end, data + begin, function);
+    });
+}
+
+///@brief Sets every matrix element to result of function applied to element of source at same position
+///@note Function is called concurrently from several threads and in unspecified order
+///@param source Matrix of same dimensions supplying function arguments
+///@param function Callable taking source element and returning new element value
+template<typename T>
+template<typename U, typename Function>
+void Matrix<T>::parallelTransform(Matrix<U>& source, Function function) {
+    MATRIX_TRACE_SCOPE("Matrix::parallelTransform", impl->getRowCount(), impl->getColumnCount(),
+                       static_cast<std::int64_t>(impl->getSize()) * (sizeof(T) + sizeof(U)));
+    if(source.getRowCount() != this->getRowCount() || source.getColumnCount() != this->getColumnCount())
     {
-        temp = new MatrixImpl<T>(*impl);
-        impl->removeRef();
-        impl = temp;
+        throw std::invalid_argument("Matrix::parallelTransform - source dimensions do not match");
+    }
+    detach();
+    T* data = impl->getData();
+    const U* sourceData = source.impl->getData();
+    ThreadPool::instance().parallelFor(0, impl->getSize(), chunkSize(), [data, sourceData, &function](MatrixIndex begin, MatrixIndex end) {
+        std::transform(sourceData + begin, sourceData + end, data + begin, function);
+    });
+}
+
+///@brief Combines every row with a vector, element (r, c) becomes function(element, rowVector[c])
+///@note Single in-place pass over exclusively owned data, shared data is detached first.
+/// Rows are split between pool threads, so the vector stays cached while a chunk of rows streams through.
+///@param rowVector Vector with one value per column
+///@param function Callable taking element and vector value and returning new element value
+template<typename T>
+template<typename Function>
+void Matrix<T>::broadcastRows(std::type_identity_t<std::span<const T>> rowVector, Function function) {
+    MATRIX_TRACE_SCOPE("Matrix::broadcastRows", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    if(static_cast<MatrixIndex>(rowVector.size()) != impl->getColumnCount())
+    {
+        throw std::invalid_argument("Matrix::broadcastRows - vector size does not match column count");
+    }
+    detach();
+    T* data = impl->getData();
+    MatrixIndex colCount = impl->getColumnCount();
+    const T* vector = rowVector.data();
+    MatrixIndex grain = std::max<MatrixIndex>(1, chunkSize() / std::max<MatrixIndex>(1, colCount));
+    ThreadPool::instance().parallelFor(0, impl->getRowCount(), grain, [data, colCount, vector, &function](MatrixIndex begin, MatrixIndex end) {
+        for(MatrixIndex row = begin; row < end; row++)
+        {
+            T* rowData = data + row * colCount;
+            for(MatrixIndex col = 0; col < colCount; col++)
+            {
+                rowData[col] = function(rowData[col], vector[col]);
+            }
+        }
+    });
+}
+
+///@brief Combines every column with a vector, element (r, c) becomes function(element, columnVector[r])
+///@note Single in-place pass over exclusively owned data, shared data is detached first
+///@param columnVector Vector with one value per row
+///@param function Callable taking element and vector value and returning new element value
+template<typename T>
+template<typename Function>
+void Matrix<T>::broadcastColumns(std::type_identity_t<std::span<const T>> columnVector, Function function) {
+    MATRIX_TRACE_SCOPE("Matrix::broadcastColumns", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    if(static_cast<MatrixIndex>(columnVector.size()) != impl->getRowCount())
+    {
+        throw std::invalid_argument("Matrix::broadcastColumns - vector size does not match row count");
     }
-    return impl->ptrAt(row,column);;
+    detach();
+    T* data = impl->getData();
+    MatrixIndex colCount = impl->getColumnCount();
+    const T* vector = columnVector.data();
+    MatrixIndex grain = std::max<MatrixIndex>(1, chunkSize() / std::max<MatrixIndex>(1, colCount));
+    ThreadPool::instance().parallelFor(0, impl->getRowCount(), grain, [data, colCount, vector, &function](MatrixIndex begin, MatrixIndex end) {
+        for(MatrixIndex row = begin; row < end; row++)
+        {
+            T* rowData = data + row * colCount;
+            const T value = vector[row];
+            for(MatrixIndex col = 0; col < colCount; col++)
+            {
+                rowData[col] = function(rowData[col], value);
+            }
+        }
+    });
+}
+
+///@brief Adds rowVector[c] to every element of column c
+template<typename T>
+void Matrix<T>::addRowVector(std::type_identity_t<std::span<const T>> rowVector) {
+    broadcastRows(rowVector, std::plus<T>());
+}
+
+///@brief Subtracts rowVector[c] from every element of column c
+template<typename T>
+void Matrix<T>::subtractRowVector(std::type_identity_t<std::span<const T>> rowVector) {
+    broadcastRows(rowVector, std::minus<T>());
+}
+
+///@brief Multiplies every element of column c by rowVector[c]
+template<typename T>
+void Matrix<T>::mulRowVector(std::type_identity_t<std::span<const T>> rowVector) {
+    broadcastRows(rowVector, std::multiplies<T>());
+}
+
+///@brief Divides every element of column c by rowVector[c]
+template<typename T>
+void Matrix<T>::divRowVector(std::type_identity_t<std::span<const T>> rowVector) {
+    broadcastRows(rowVector, std::divides<T>());
+}
+
+///@brief Adds columnVector[r] to every element of row r
+template<typename T>
+void Matrix<T>::addColumnVector(std::type_identity_t<std::span<const T>> columnVector) {
+    broadcastColumns(columnVector, std::plus<T>());
+}
+
+///@brief Subtracts columnVector[r] from every element of row r
+template<typename T>
+void Matrix<T>::subtractColumnVector(std::type_identity_t<std::span<const T>> columnVector) {
+    broadcastColumns(columnVector, std::minus<T>());
+}
+
+///@brief Multiplies every element of row r by columnVector[r]
+template<typename T>
+void Matrix<T>::mulColumnVector(std::type_identity_t<std::span<const T>> columnVector) {
+    broadcastColumns(columnVector, std::multiplies<T>());
+}
+
+///@brief Divides every element of row r by columnVector[r]
+template<typename T>
+void Matrix<T>::divColumnVector(std::type_identity_t<std::span<const T>> columnVector) {
+    broadcastColumns(columnVector, std::divides<T>());
+}
+
+#ifdef MATRIX_HAS_EXECUTION_POLICIES
+///@brief Calls function for every matrix element using standard library parallel algorithms
+///@param policy Standard execution policy, e.g. std::execution::par_unseq
+///@param function Callable taking reference to element
+template<typename T>
+template<typename ExecutionPolicy, typename Function, typename>
+void Matrix<T>::parallelForEach(ExecutionPolicy&& policy, Function function) {
+    detach();
+    T* data = impl->getData();
+    std::for_each(std::forward<ExecutionPolicy>(policy), data, data + impl->getSize(), function);
+}
+
+///@brief Replaces every matrix element with result of function using standard library parallel algorithms
+///@param policy Standard execution policy, e.g. std::execution::par_unseq
+///@param function Callable taking element and returning new element value
+template<typename T>
+template<typename ExecutionPolicy, typename Function, typename>
+void Matrix<T>::parallelTransform(ExecutionPolicy&& policy, Function function) {
+    detach();
+    T* data = impl->getData();
+    std::transform(std::forward<ExecutionPolicy>(policy), data, data + impl->getSize(), data, function);
 }
+#endif
 
+///@brief Takes data of other, which is left as an empty 0 x 0 matrix without allocating
 template<typename T>
 Matrix<T> &Matrix<T>::operator=(Matrix<T> &&other) noexcept {
-    if(impl->getRefCount() == 1)
+    if(this != &other)
     {
-        delete impl;
-    } else{
-        impl->removeRef();
+        release();
+        impl = other.impl;
+        other.impl = MatrixImpl<T>::empty();
     }
-    this->impl = other.impl;
     return *this;
 }
 
 template<typename T>
 Matrix<T> &Matrix<T>::operator=(Matrix<T> const &other) {
-    other.impl->addRef();
-    if(impl->getRefCount() == 1)
+    Matrix<T> copy(other);
+    swap(copy);
+    return *this;
+}
+
+///@brief Compares dimensions and contents with other matrix
+///@note Matrices sharing data are equal without comparing elements. Cached hashes are not consulted, since
+/// pointers and references obtained before hash() can still write afterwards and leave them stale.
+/// Elements that are BytewiseComparable are compared with memcmp, other elements with operator==.
+///@param other Matrix to compare with
+template<typename T>
+bool Matrix<T>::equals(const Matrix &other) const {
+    MATRIX_TRACE_SCOPE("Matrix::equals", impl->getRowCount(), impl->getColumnCount(),
+                       2 * static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    return contentEquals(impl, other.impl);
+}
+
+///@brief Compares dimensions and contents of matrix data, see equals()
+template<typename T>
+bool Matrix<T>::contentEquals(MatrixImpl<T>* lhsImpl, MatrixImpl<T>* rhsImpl) {
+    if(lhsImpl == rhsImpl)
     {
-        delete impl;
-    }else{
-        impl->removeRef();
+        return true;
+    }
+    if(lhsImpl->getRowCount() != rhsImpl->getRowCount() || lhsImpl->getColumnCount() != rhsImpl->getColumnCount())
+    {
+        return false;
+    }
+    const T* lhs = lhsImpl->getData();
+    const T* rhs = rhsImpl->getData();
+    std::size_t size = static_cast<std::size_t>(lhsImpl->getSize());
+    if constexpr(BytewiseComparable<T>::value)
+    {
+        return size == 0 || std::memcmp(lhs, rhs, size * sizeof(T)) == 0;
     }
-    impl = other.impl;
+    else
+    {
+        return std::equal(lhs, lhs + size, rhs);
+    }
+}
 
-    return *this;
+///@brief Gets hash of matrix dimensions and contents
+///@note Hash is cached only for data with an owner, such as pooled data, which is never written in place.
+/// Other data can still be written through pointers or references obtained earlier, so its hash is recomputed.
+/// Elements that are BytewiseComparable are hashed as raw bytes, other elements with std::hash.
+template<typename T>
+std::size_t Matrix<T>::hash() const {
+    bool cacheable = impl->getOwner() != nullptr;
+    std::size_t result = cacheable ? impl->getCachedHash() : 0;
+    if(result != 0)
+    {
+        return result;
+    }
+    MATRIX_TRACE_SCOPE("Matrix::hash", impl->getRowCount(), impl->getColumnCount(),
+                       static_cast<std::int64_t>(impl->getSize()) * sizeof(T));
+    const T* data = impl->getData();
+    std::size_t size = static_cast<std::size_t>(impl->getSize());
+    std::size_t dimensions[2] = {static_cast<std::size_t>(impl->getRowCount()),
+                                 static_cast<std::size_t>(impl->getColumnCount())};
+    result = hashBytes(reinterpret_cast<const unsigned char*>(dimensions), sizeof(dimensions), 0);
+    if constexpr(BytewiseComparable<T>::value)
+    {
+        result = hashBytes(reinterpret_cast<const unsigned char*>(data), size * sizeof(T), result);
+    }
+    else
+    {
+        std::hash<T> elementHash;
+        for(std::size_t index = 0; index < size; index++)
+        {
+            std::size_t value = elementHash(data[index]);
+            result = hashBytes(reinterpret_cast<const unsigned char*>(&value), sizeof(value), result);
+        }
+    }
+    //Zero marks missing cache entry
+    result = result == 0 ? 1 : result;
+    if(cacheable)
+    {
+        impl->setCachedHash(result);
+    }
+    return result;
+}
+
+///@brief Mixes bytes into seed eight bytes at a time
+template<typename T>
+std::size_t Matrix<T>::hashBytes(const unsigned char *bytes, std::size_t size, std::size_t seed) {
+    constexpr std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+    std::uint64_t state = seed ^ (size * multiplier);
+    std::size_t index = 0;
+    for(; index + 8 <= size; index += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + index, 8);
+        state = (state ^ word) * multiplier;
+        state ^= state >> 29;
+    }
+    if(index < size)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes + index, size - index);
+        state = (state ^ word) * multiplier;
+        state ^= state >> 29;
+    }
+    state ^= state >> 32;
+    return static_cast<std::size_t>(state);
 }
 
 ///@brief Returns iterator pointing to top matrix row
@@ -625,4 +1172,93 @@ typename Matrix<T>::const_columnIterator Matrix<T>::endConstColumn() {
     return Matrix::const_columnIterator(this->getColumnCount(), this);
 }
 
+///@brief Returns contiguous iterator pointing to first element in row-major order
+///@note Detaches shared data, iterators are invalidated by any operation changing matrix dimensions
+template<typename T>
+typename Matrix<T>::iterator Matrix<T>::begin() {
+    detach();
+    return impl->getData();
+}
+
+///@brief Returns contiguous iterator pointing past last element in row-major order
+template<typename T>
+typename Matrix<T>::iterator Matrix<T>::end() {
+    detach();
+    return impl->getData() + impl->getSize();
+}
+
+///@brief Returns constant contiguous iterator pointing to first element in row-major order
+///@note Does not detach shared data
+template<typename T>
+typename Matrix<T>::const_iterator Matrix<T>::cbegin() {
+    return impl->getData();
+}
+
+///@brief Returns constant contiguous iterator pointing past last element in row-major order
+template<typename T>
+typename Matrix<T>::const_iterator Matrix<T>::cend() {
+    return impl->getData() + impl->getSize();
+}
+
+///@brief Returns view of matrix rows, each row is a std::span over matrix storage
+///@note Detaches shared data, view is invalidated by any operation changing matrix dimensions
+template<typename T>
+auto Matrix<T>::rows() {
+    detach();
+    T* data = impl->getData();
+    MatrixIndex colCount = impl->getColumnCount();
+    return std::views::iota(MatrixIndex(0), impl->getRowCount()) | std::views::transform([data, colCount](MatrixIndex row) {
+        return std::span<T>(data + row * colCount, colCount);
+    });
+}
+
+///@brief Returns view of matrix rows, each row is a std::span of constant elements
+template<typename T>
+auto Matrix<T>::constRows() {
+    const T* data = impl->getData();
+    MatrixIndex colCount = impl->getColumnCount();
+    return std::views::iota(MatrixIndex(0), impl->getRowCount()) | std::views::transform([data, colCount](MatrixIndex row) {
+        return std::span<const T>(data + row * colCount, colCount);
+    });
+}
+
+///@brief Returns view of matrix columns, each column is a random access view of element references
+///@note Detaches shared data, view is invalidated by any operation changing matrix dimensions
+template<typename T>
+auto Matrix<T>::columns() {
+    detach();
+    T* data = impl->getData();
+    MatrixIndex rowCount = impl->getRowCount();
+    MatrixIndex colCount = impl->getColumnCount();
+    return std::views::iota(MatrixIndex(0), colCount) | std::views::transform([data, rowCount, colCount](MatrixIndex column) {
+        return std::views::iota(MatrixIndex(0), rowCount) | std::views::transform([data, colCount, column](MatrixIndex row) -> T& {
+            return data[row * colCount + column];
+        });
+    });
+}
+
+///@brief Returns view of matrix columns, each column is a random access view of constant element references
+template<typename T>
+auto Matrix<T>::constColumns() {
+    const T* data = impl->getData();
+    MatrixIndex rowCount = impl->getRowCount();
+    MatrixIndex colCount = impl->getColumnCount();
+    return std::views::iota(MatrixIndex(0), colCount) | std::views::transform([data, rowCount, colCount](MatrixIndex column) {
+        return std::views::iota(MatrixIndex(0), rowCount) | std::views::transform([data, colCount, column](MatrixIndex row) -> const T& {
+            return data[row * colCount + column];
+        });
+    });
+}
+
+///@brief Hashes matrix dimensions and contents, see Matrix::hash()
+template<typename T>
+struct std::hash<Matrix<T>> {
+    std::size_t operator()(const Matrix<T>& matrix) const {
+        return matrix.hash();
+    }
+};
+
+//Bit-packed Matrix<bool> specialization has to be visible wherever Matrix<bool> is used
+#include "BitMatrix.h"
+
 #endif //MATRIX_MATRIX_H
@@ -0,0 +1,480 @@
+#ifndef MATRIX_MATRIXALGEBRA_H
+#define MATRIX_MATRIXALGEBRA_H
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "CpuDispatch.h"
+#include "Matrix.h"
+#include "ThreadPool.h"
+
+///@brief Element count of a matrix above which matrix-vector products are split between pool threads
+constexpr int gemvParallelThreshold = 1 << 16;
+
+///@brief Square matrix size at or below which Strassen-Winograd recursion hands off to blocked GEMM
+constexpr int strassenCutoff = 512;
+
+namespace MatrixKernels {
+
+///@brief Computes dot product of two contiguous vectors
+///@note Independent partial sums let the compiler keep several SIMD accumulators in flight
+template<typename T>
+T dot(const T* lhs, const T* rhs, MatrixIndex size) {
+    constexpr int lanes = 8;
+    T partial[lanes] = {};
+    MatrixIndex index = 0;
+    for(; index + lanes <= size; index += lanes)
+    {
+        for(int lane = 0; lane < lanes; lane++)
+        {
+            partial[lane] += lhs[index + lane] * rhs[index + lane];
+        }
+    }
+    for(; index < size; index++)
+    {
+        partial[0] += lhs[index] * rhs[index];
+    }
+    for(int lane = 1; lane < lanes; lane++)
+    {
+        partial[0] += partial[lane];
+    }
+    return partial[0];
+}
+
+///@brief Computes y = alpha * x + y for contiguous vectors
+template<typename T>
+void axpy(T alpha, const T* x, T* y, MatrixIndex size) {
+    for(MatrixIndex index = 0; index < size; index++)
+    {
+        y[index] += alpha * x[index];
+    }
+}
+
+///@brief Longest vector handed to one call of a dispatched kernel, whose sizes are int
+constexpr MatrixIndex dispatchedKernelChunk = MatrixIndex(1) << 30;
+
+///@brief Computes dot product with the instruction set variant selected at run time
+inline float dot(const float* lhs, const float* rhs, MatrixIndex size) {
+    float sum = 0.0f;
+    for(MatrixIndex begin = 0; begin < size; begin += dispatchedKernelChunk)
+    {
+        sum += cpuKernels().dotFloat(lhs + begin, rhs + begin,
+                                     static_cast<int>(std::min(dispatchedKernelChunk, size - begin)));
+    }
+    return sum;
+}
+
+inline double dot(const double* lhs, const double* rhs, MatrixIndex size) {
+    double sum = 0.0;
+    for(MatrixIndex begin = 0; begin < size; begin += dispatchedKernelChunk)
+    {
+        sum += cpuKernels().dotDouble(lhs + begin, rhs + begin,
+                                      static_cast<int>(std::min(dispatchedKernelChunk, size - begin)));
+    }
+    return sum;
+}
+
+///@brief Computes y = alpha * x + y with the instruction set variant selected at run time
+inline void axpy(float alpha, const float* x, float* y, MatrixIndex size) {
+    for(MatrixIndex begin = 0; begin < size; begin += dispatchedKernelChunk)
+    {
+        cpuKernels().axpyFloat(alpha, x + begin, y + begin, static_cast<int>(std::min(dispatchedKernelChunk, size - begin)));
+    }
+}
+
+inline void axpy(double alpha, const double* x, double* y, MatrixIndex size) {
+    for(MatrixIndex begin = 0; begin < size; begin += dispatchedKernelChunk)
+    {
+        cpuKernels().axpyDouble(alpha, x + begin, y + begin, static_cast<int>(std::min(dispatchedKernelChunk, size - begin)));
+    }
+}
+
+///@brief Computes y = beta * y, zero beta overwrites y without reading it
+template<typename T>
+void scale(T beta, T* y, MatrixIndex size) {
+    if(beta == T(0))
+    {
+        std::fill(y, y + size, T(0));
+    }
+    else if(beta != T(1))
+    {
+        for(MatrixIndex index = 0; index < size; index++)
+        {
+            y[index] *= beta;
+        }
+    }
+}
+
+///@brief Computes rows [rowBegin, rowEnd) of y = alpha * A * x + beta * y for row-major A
+template<typename T>
+void gemvRows(const T* a, MatrixIndex colCount, const T* x, T* y, T alpha, T beta, MatrixIndex rowBegin,
+              MatrixIndex rowEnd) {
+    for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+    {
+        T product = alpha * dot(a + row * colCount, x, colCount);
+        y[row] = beta == T(0) ? product : product + beta * y[row];
+    }
+}
+
+///@brief Computes columns [colBegin, colEnd) of y = alpha * A^T * x + beta * y for row-major A
+///@note Panel of y stays in cache while rows of A stream through it
+template<typename T>
+void gemvTransposedPanel(const T* a, MatrixIndex rowCount, MatrixIndex colCount, const T* x, T* y, T alpha, T beta,
+                         MatrixIndex colBegin, MatrixIndex colEnd) {
+    MatrixIndex panelWidth = colEnd - colBegin;
+    scale(beta, y + colBegin, panelWidth);
+    for(MatrixIndex row = 0; row < rowCount; row++)
+    {
+        axpy(alpha * x[row], a + row * colCount + colBegin, y + colBegin, panelWidth);
+    }
+}
+
+///@brief Accumulates products of row-major m x k matrix A and k x n matrix B into C
+///@note Blocks of B are kept in L2 cache while rows of A and C stream through them. Arithmetic is left to
+/// rowUpdate(weight, bRow, cRow, width), called for every element of A with the matching B row slice and C row slice,
+/// which lets semiring products share the blocking of numeric GEMM.
+template<typename T, typename RowUpdate>
+void blockedGemm(MatrixIndex m, MatrixIndex n, MatrixIndex k, const T* a, MatrixIndex lda, const T* b, MatrixIndex ldb,
+                 T* c, MatrixIndex ldc, RowUpdate rowUpdate) {
+    constexpr int blockK = 256;
+    constexpr int blockN = 256;
+    for(MatrixIndex depthBegin = 0; depthBegin < k; depthBegin += blockK)
+    {
+        MatrixIndex depthEnd = std::min(k, depthBegin + blockK);
+        for(MatrixIndex colBegin = 0; colBegin < n; colBegin += blockN)
+        {
+            int width = static_cast<int>(std::min<MatrixIndex>(n, colBegin + blockN) - colBegin);
+            for(MatrixIndex row = 0; row < m; row++)
+            {
+                T* cRow = c + row * ldc + colBegin;
+                for(MatrixIndex depth = depthBegin; depth < depthEnd; depth++)
+                {
+                    rowUpdate(a[row * lda + depth], b + depth * ldb + colBegin, cRow, width);
+                }
+            }
+        }
+    }
+}
+
+///@brief Computes C = alpha * A * B + beta * C for row-major m x k matrix A and k x n matrix B
+template<typename T>
+void gemm(MatrixIndex m, MatrixIndex n, MatrixIndex k, T alpha, const T* a, MatrixIndex lda, const T* b, MatrixIndex ldb,
+          T beta, T* c, MatrixIndex ldc) {
+    for(MatrixIndex row = 0; row < m; row++)
+    {
+        scale(beta, c + row * ldc, n);
+    }
+    blockedGemm(m, n, k, a, lda, b, ldb, c, ldc, [alpha](T weight, const T* bRow, T* cRow, int width) {
+        axpy(alpha * weight, bRow, cRow, width);
+    });
+}
+
+///@brief Computes C = alpha * A * B + beta * C splitting row blocks of C between ThreadPool threads
+template<typename T>
+void parallelGemm(MatrixIndex m, MatrixIndex n, MatrixIndex k, T alpha, const T* a, MatrixIndex lda, const T* b,
+                  MatrixIndex ldb, T beta, T* c, MatrixIndex ldc) {
+    constexpr int blockM = 64;
+    ThreadPool::instance().parallelFor(0, m, blockM, [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        gemm(rowEnd - rowBegin, n, k, alpha, a + rowBegin * lda, lda, b, ldb, beta, c + rowBegin * ldc, ldc);
+    });
+}
+
+///@brief Computes z = x + y for n x n blocks
+template<typename T>
+void add(const T* x, MatrixIndex ldx, const T* y, MatrixIndex ldy, T* z, MatrixIndex ldz, MatrixIndex n) {
+    for(MatrixIndex row = 0; row < n; row++)
+    {
+        for(MatrixIndex col = 0; col < n; col++)
+        {
+            z[row * ldz + col] = x[row * ldx + col] + y[row * ldy + col];
+        }
+    }
+}
+
+///@brief Computes z = x - y for n x n blocks
+template<typename T>
+void subtract(const T* x, MatrixIndex ldx, const T* y, MatrixIndex ldy, T* z, MatrixIndex ldz, MatrixIndex n) {
+    for(MatrixIndex row = 0; row < n; row++)
+    {
+        for(MatrixIndex col = 0; col < n; col++)
+        {
+            z[row * ldz + col] = x[row * ldx + col] - y[row * ldy + col];
+        }
+    }
+}
+
+///@brief Gets amount of scratch elements needed by strassen() for n x n operands
+///@param parallelDepth Amount of top recursion levels whose seven products run concurrently
+inline MatrixIndex strassenScratchSize(MatrixIndex n, int cutoff, int parallelDepth) {
+    if(n <= cutoff)
+    {
+        return 0;
+    }
+    MatrixIndex half = n / 2;
+    MatrixIndex children = parallelDepth > 0 ? 7 : 1;
+    return 15 * half * half + children * strassenScratchSize(n / 2, cutoff, parallelDepth - 1);
+}
+
+///@brief Computes C = A * B for n x n blocks with Strassen-Winograd recursion
+///@note n must stay even on every level above cutoff, scratch must hold strassenScratchSize() elements
+template<typename T>
+void strassen(const T* a, MatrixIndex lda, const T* b, MatrixIndex ldb, T* c, MatrixIndex ldc, MatrixIndex n, int cutoff,
+              int parallelDepth, T* scratch) {
+    if(n <= cutoff)
+    {
+        gemm(n, n, n, T(1), a, lda, b, ldb, T(0), c, ldc);
+        return;
+    }
+    MatrixIndex h = n / 2;
+    MatrixIndex quarter = h * h;
+    const T* a11 = a;
+    const T* a12 = a + h;
+    const T* a21 = a + h * lda;
+    const T* a22 = a + h * lda + h;
+    const T* b11 = b;
+    const T* b12 = b + h;
+    const T* b21 = b + h * ldb;
+    const T* b22 = b + h * ldb + h;
+
+    T* s1 = scratch;
+    T* s2 = s1 + quarter;
+    T* s3 = s2 + quarter;
+    T* s4 = s3 + quarter;
+    T* t1 = s4 + quarter;
+    T* t2 = t1 + quarter;
+    T* t3 = t2 + quarter;
+    T* t4 = t3 + quarter;
+    T* products = t4 + quarter;
+    T* childScratch = products + 7 * quarter;
+
+    add(a21, lda, a22, lda, s1, h, h);
+    subtract(s1, h, a11, lda, s2, h, h);
+    subtract(a11, lda, a21, lda, s3, h, h);
+    subtract(a12, lda, s2, h, s4, h, h);
+    subtract(b12, ldb, b11, ldb, t1, h, h);
+    subtract(b22, ldb, t1, h, t2, h, h);
+    subtract(b22, ldb, b12, ldb, t3, h, h);
+    subtract(t2, h, b21, ldb, t4, h, h);
+
+    const T* lhs[7] = {a11, a12, s4, a22, s1, s2, s3};
+    MatrixIndex lhsStride[7] = {lda, lda, h, lda, h, h, h};
+    const T* rhs[7] = {b11, b21, b22, t4, t1, t2, t3};
+    MatrixIndex rhsStride[7] = {ldb, ldb, ldb, h, h, h, h};
+    MatrixIndex childSize = strassenScratchSize(h, cutoff, parallelDepth - 1);
+    auto product = [&](MatrixIndex index, T* productScratch) {
+        strassen(lhs[index], lhsStride[index], rhs[index], rhsStride[index], products + index * quarter, h, h,
+                 cutoff, parallelDepth - 1, productScratch);
+    };
+    if(parallelDepth > 0)
+    {
+        ThreadPool::instance().parallelFor(0, 7, 1, [&](MatrixIndex begin, MatrixIndex end) {
+            for(MatrixIndex index = begin; index < end; index++)
+            {
+                product(index, childScratch + index * childSize);
+            }
+        });
+    }
+    else
+    {
+        for(MatrixIndex index = 0; index < 7; index++)
+        {
+            product(index, childScratch);
+        }
+    }
+
+    T* p1 = products;
+    T* p2 = p1 + quarter;
+    T* p3 = p2 + quarter;
+    T* p4 = p3 + quarter;
+    T* p5 = p4 + quarter;
+    T* p6 = p5 + quarter;
+    T* p7 = p6 + quarter;
+    T* c11 = c;
+    T* c12 = c + h;
+    T* c21 = c + h * ldc;
+    T* c22 = c + h * ldc + h;
+    add(p1, h, p2, h, c11, ldc, h);
+    add(p1, h, p6, h, p6, h, h);     //U2 = P1 + P6
+    add(p6, h, p7, h, p7, h, h);     //U3 = U2 + P7
+    add(p6, h, p5, h, p6, h, h);     //U4 = U2 + P5
+    add(p6, h, p3, h, c12, ldc, h);  //C12 = U4 + P3
+    subtract(p7, h, p4, h, c21, ldc, h); //C21 = U3 - P4
+    add(p7, h, p5, h, c22, ldc, h);  //C22 = U3 + P5
+}
+
+}
+
+///@brief Computes matrix product C = alpha * A * B + beta * C with cache-blocked kernel
+///@note Row blocks of C are computed concurrently on ThreadPool
+///@param a Left operand
+///@param b Right operand with as many rows as A has columns
+///@param c Result with A row count and B column count
+///@param alpha Product multiplier
+///@param beta Multiplier of initial C, zero makes initial C ignored
+template<typename T>
+void gemm(Matrix<T>& a, Matrix<T>& b, Matrix<T>& c, std::type_identity_t<T> alpha = T(1),
+          std::type_identity_t<T> beta = T(0)) {
+    MATRIX_TRACE_SCOPE("gemm", c.getRowCount(), c.getColumnCount(),
+                       (static_cast<std::int64_t>(a.getSize()) + b.getSize() + 2 * c.getSize()) * sizeof(T));
+    MatrixIndex m = a.getRowCount();
+    MatrixIndex k = a.getColumnCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != k || c.getRowCount() != m || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("gemm - matrix dimensions do not match");
+    }
+    const T* aData = a.cbegin();
+    const T* bData = b.cbegin();
+    T* cData = c.begin();
+    if(cData == aData || cData == bData)
+    {
+        throw std::invalid_argument("gemm - result must not share data with operands");
+    }
+    MatrixKernels::parallelGemm(m, n, k, alpha, aData, k, bData, n, beta, cData, n);
+}
+
+///@brief Computes square matrix product C = A * B with Strassen-Winograd algorithm
+///@note Recursion stops at cutoff and continues with blocked GEMM. Operands are zero-padded so that size
+/// halves evenly down to cutoff. All scratch memory is allocated once before recursion starts and seven
+/// products of top levels run concurrently. Non-square operands and operands not larger than cutoff
+/// are multiplied with gemm().
+///@param a Left square operand
+///@param b Right square operand of the same size
+///@param c Result of the same size
+///@param cutoff Operand size at or below which blocked GEMM is used
+template<typename T>
+void strassenMultiply(Matrix<T>& a, Matrix<T>& b, Matrix<T>& c, int cutoff = strassenCutoff) {
+    MATRIX_TRACE_SCOPE("strassenMultiply", c.getRowCount(), c.getColumnCount(),
+                       (static_cast<std::int64_t>(a.getSize()) + b.getSize() + c.getSize()) * sizeof(T));
+    MatrixIndex n = a.getRowCount();
+    if(cutoff < 1)
+    {
+        throw std::invalid_argument("strassenMultiply - cutoff must be positive");
+    }
+    if(n <= cutoff || a.getColumnCount() != n || b.getRowCount() != n || b.getColumnCount() != n)
+    {
+        gemm(a, b, c);
+        return;
+    }
+    if(c.getRowCount() != n || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("strassenMultiply - matrix dimensions do not match");
+    }
+
+    int levels = 0;
+    MatrixIndex baseSize = n;
+    while(baseSize > cutoff)
+    {
+        baseSize = (baseSize + 1) / 2;
+        levels++;
+    }
+    MatrixIndex padded = baseSize << levels;
+    unsigned threadCount = ThreadPool::instance().getThreadCount();
+    int parallelDepth = threadCount == 1 ? 0 : (threadCount > 7 ? 2 : 1);
+
+    MatrixIndex paddedSize = MatrixImpl<T>::checkedSize(padded, padded);
+    MatrixIndex recursionSize = MatrixKernels::strassenScratchSize(padded, cutoff, parallelDepth);
+    std::vector<T> scratch(recursionSize + (padded == n ? 0 : 3 * paddedSize), T(0));
+
+    const T* aData = a.cbegin();
+    const T* bData = b.cbegin();
+    T* cData = c.begin();
+    if(cData == aData || cData == bData)
+    {
+        throw std::invalid_argument("strassenMultiply - result must not share data with operands");
+    }
+    if(padded == n)
+    {
+        MatrixKernels::strassen(aData, n, bData, n, cData, n, n, cutoff, parallelDepth, scratch.data());
+        return;
+    }
+
+    T* aPadded = scratch.data() + recursionSize;
+    T* bPadded = aPadded + paddedSize;
+    T* cPadded = bPadded + paddedSize;
+    for(MatrixIndex row = 0; row < n; row++)
+    {
+        std::copy(aData + row * n, aData + (row + 1) * n, aPadded + row * padded);
+        std::copy(bData + row * n, bData + (row + 1) * n, bPadded + row * padded);
+    }
+    MatrixKernels::strassen<T>(aPadded, padded, bPadded, padded, cPadded, padded, padded, cutoff, parallelDepth,
+                               scratch.data());
+    for(MatrixIndex row = 0; row < n; row++)
+    {
+        std::copy(cPadded + row * padded, cPadded + row * padded + n, cData + row * n);
+    }
+}
+
+///@brief Computes matrix-vector product y = alpha * A * x + beta * y
+///@note Products of matrices larger than gemvParallelThreshold elements run on ThreadPool
+///@param a Matrix with as many columns as x has elements
+///@param x Input vector
+///@param y Output vector with as many elements as A has rows
+///@param alpha Product multiplier
+///@param beta Multiplier of initial y, zero makes initial y ignored
+template<typename T>
+void gemv(Matrix<T>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y,
+          std::type_identity_t<T> alpha = T(1), std::type_identity_t<T> beta = T(0)) {
+    MATRIX_TRACE_SCOPE("gemv", a.getRowCount(), a.getColumnCount(), static_cast<std::int64_t>(a.getSize()) * sizeof(T));
+    MatrixIndex rowCount = a.getRowCount();
+    MatrixIndex colCount = a.getColumnCount();
+    if(static_cast<MatrixIndex>(x.size()) != colCount || static_cast<MatrixIndex>(y.size()) != rowCount)
+    {
+        throw std::invalid_argument("gemv - vector sizes do not match matrix dimensions");
+    }
+    const T* data = a.cbegin();
+    if(rowCount * colCount < gemvParallelThreshold)
+    {
+        MatrixKernels::gemvRows(data, colCount, x.data(), y.data(), alpha, beta, 0, rowCount);
+        return;
+    }
+    //Row blocks of roughly 16k elements keep chunk overhead negligible
+    MatrixIndex grain = std::max<MatrixIndex>(1, (1 << 14) / std::max<MatrixIndex>(1, colCount));
+    ThreadPool::instance().parallelFor(0, rowCount, grain, [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        MatrixKernels::gemvRows(data, colCount, x.data(), y.data(), alpha, beta, rowBegin, rowEnd);
+    });
+}
+
+///@brief Computes transposed matrix-vector product y = alpha * A^T * x + beta * y
+///@note Products of matrices larger than gemvParallelThreshold elements run on ThreadPool
+///@param a Matrix with as many rows as x has elements
+///@param x Input vector
+///@param y Output vector with as many elements as A has columns
+///@param alpha Product multiplier
+///@param beta Multiplier of initial y, zero makes initial y ignored
+template<typename T>
+void gemvTransposed(Matrix<T>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y,
+                    std::type_identity_t<T> alpha = T(1), std::type_identity_t<T> beta = T(0)) {
+    MATRIX_TRACE_SCOPE("gemvTransposed", a.getRowCount(), a.getColumnCount(),
+                       static_cast<std::int64_t>(a.getSize()) * sizeof(T));
+    MatrixIndex rowCount = a.getRowCount();
+    MatrixIndex colCount = a.getColumnCount();
+    if(static_cast<MatrixIndex>(x.size()) != rowCount || static_cast<MatrixIndex>(y.size()) != colCount)
+    {
+        throw std::invalid_argument("gemvTransposed - vector sizes do not match matrix dimensions");
+    }
+    const T* data = a.cbegin();
+    //Panel of y sized to stay in L1 data cache
+    MatrixIndex panelWidth = std::max<MatrixIndex>(1, 16 * 1024 / sizeof(T));
+    if(rowCount * colCount < gemvParallelThreshold)
+    {
+        for(MatrixIndex colBegin = 0; colBegin < colCount; colBegin += panelWidth)
+        {
+            MatrixKernels::gemvTransposedPanel(data, rowCount, colCount, x.data(), y.data(), alpha, beta,
+                                               colBegin, std::min(colCount, colBegin + panelWidth));
+        }
+        return;
+    }
+    //Narrower panels when there are too few to occupy every thread
+    MatrixIndex threadCount = ThreadPool::instance().getThreadCount();
+    panelWidth = std::clamp<MatrixIndex>(colCount / (threadCount * 4), 64, panelWidth);
+    ThreadPool::instance().parallelFor(0, colCount, panelWidth, [&](MatrixIndex colBegin, MatrixIndex colEnd) {
+        MatrixKernels::gemvTransposedPanel(data, rowCount, colCount, x.data(), y.data(), alpha, beta,
+                                           colBegin, colEnd);
+    });
+}
+
+#endif //MATRIX_MATRIXALGEBRA_H
@@ -0,0 +1,121 @@
+#ifndef MATRIX_MATRIXALLOCATOR_H
+#define MATRIX_MATRIXALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "ThreadPool.h"
+
+///@brief Size of a transparent huge page on x86-64 and most AArch64 Linux configurations
+constexpr std::size_t hugePageSize = std::size_t(2) << 20;
+
+///@brief Smallest page size that first touch has to reach when huge pages are not granted
+constexpr std::size_t smallPageSize = 4096;
+
+///@brief Buffers of at least this many bytes are mapped with huge pages and initialized in parallel
+constexpr std::size_t hugePageThreshold = 8 * hugePageSize;
+
+///@brief Allocates matrix element storage
+///@note Large buffers of trivial types are mapped directly, aligned to huge page size and advised
+/// with MADV_HUGEPAGE, so a multi-gigabyte matrix needs a few thousand TLB entries instead of a million.
+/// Their pages are first touched from pool threads, one huge page per task, so faulting in a large buffer
+/// is not serialized on the allocating thread. Work stealing decides which thread touches which page,
+/// so placement of pages on NUMA nodes is not controlled.
+/// Other buffers use new T[], so deallocate() must be given the count passed to allocate().
+template<typename T>
+class MatrixAllocator {
+private:
+    static constexpr bool trivial = std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>;
+
+    static std::size_t mappedBytes(std::size_t count);
+
+public:
+    static bool isHugePageAllocation(std::size_t count);
+    static T* allocate(std::size_t count);
+    static void deallocate(T* data, std::size_t count);
+};
+
+///@brief Checks whether buffer of count elements takes the huge page path
+template<typename T>
+bool MatrixAllocator<T>::isHugePageAllocation(std::size_t count) {
+#ifdef __linux__
+    return trivial && count * sizeof(T) >= hugePageThreshold;
+#else
+    return false;
+#endif
+}
+
+template<typename T>
+std::size_t MatrixAllocator<T>::mappedBytes(std::size_t count) {
+    return (count * sizeof(T) + hugePageSize - 1) / hugePageSize * hugePageSize;
+}
+
+///@brief Allocates storage for count elements
+///@note Elements of huge page buffers are zeroed, other elements are default-initialized like new T[]
+template<typename T>
+T* MatrixAllocator<T>::allocate(std::size_t count) {
+    if(!isHugePageAllocation(count))
+    {
+        return new T[count];
+    }
+#ifdef __linux__
+    std::size_t bytes = mappedBytes(count);
+    //Mapping is over-allocated by one huge page and trimmed to an aligned range
+    void* mapping = mmap(nullptr, bytes + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mapping == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(mapping);
+    std::uintptr_t aligned = (begin + hugePageSize - 1) / hugePageSize * hugePageSize;
+    if(aligned != begin)
+    {
+        munmap(mapping, aligned - begin);
+    }
+    std::size_t tail = begin + bytes + hugePageSize - (aligned + bytes);
+    if(tail != 0)
+    {
+        munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+    }
+    //Huge pages are only a hint, kernels without THP keep working with small pages
+    madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+
+    //Anonymous mappings are already zero, a write per small page is enough to fault the pages in
+    volatile unsigned char* data = reinterpret_cast<unsigned char*>(aligned);
+    int pageCount = static_cast<int>(bytes / hugePageSize);
+    ThreadPool::instance().parallelFor(0, pageCount, 1, [data](int firstPage, int lastPage) {
+        for(std::size_t offset = firstPage * hugePageSize; offset < lastPage * hugePageSize; offset += smallPageSize)
+        {
+            data[offset] = 0;
+        }
+    });
+    return reinterpret_cast<T*>(aligned);
+#else
+    return new T[count];
+#endif
+}
+
+///@brief Frees storage returned by allocate()
+///@param count Element count passed to allocate()
+template<typename T>
+void MatrixAllocator<T>::deallocate(T* data, std::size_t count) {
+    if(data == nullptr)
+    {
+        return;
+    }
+    if(!isHugePageAllocation(count))
+    {
+        delete[] data;
+        return;
+    }
+#ifdef __linux__
+    munmap(data, mappedBytes(count));
+#endif
+}
+
+#endif //MATRIX_MATRIXALLOCATOR_H
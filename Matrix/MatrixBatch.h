@@ -0,0 +1,520 @@
+#ifndef MATRIX_MATRIXBATCH_H
+#define MATRIX_MATRIXBATCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Matrix.h"
+#include "ThreadPool.h"
+
+///@brief Matrices of a batch processed together by one kernel pass, storage is padded to a multiple of this
+constexpr int batchLanes = 64;
+
+///@brief Approximate amount of bytes touched by one parallel batch task
+constexpr int batchTaskBytes = 256 * 1024;
+
+///@brief Batch of same-shaped small matrices stored structure-of-arrays
+///@note Element (r, c) of all matrices is one contiguous stream, element (r, c) of matrix i is at
+/// elementData(r, c)[i]. Batch kernels run every formula once per stream position, so the compiler
+/// vectorizes them across matrices and no per-matrix dispatch is left. Streams are padded with zero
+/// matrices up to a multiple of batchLanes.
+template<typename T>
+class MatrixBatch {
+private:
+    int count;
+    int rowCount;
+    int colCount;
+    int stride;
+    std::vector<T> data;
+
+public:
+    MatrixBatch(int _count, int _row, int _col);
+    explicit MatrixBatch(std::vector<Matrix<T>>& matrices);
+
+    int getCount();
+    int getRowCount();
+    int getColumnCount();
+    int getStride();
+    T& at(int index, int row, int column);
+    T* elementData(int row, int column);
+
+    Matrix<T> getMatrix(int index);
+    void setMatrix(int index, Matrix<T>& matrix);
+    std::vector<Matrix<T>> toMatrices();
+};
+
+///@brief Creates batch of count zero matrices with row x col elements
+template<typename T>
+MatrixBatch<T>::MatrixBatch(int _count, int _row, int _col) :
+        count(_count),
+        rowCount(_row),
+        colCount(_col),
+        stride((_count + batchLanes - 1) / batchLanes * batchLanes)
+{
+    if(_count < 0 || _row < 0 || _col < 0)
+    {
+        throw std::invalid_argument("MatrixBatch - negative dimension");
+    }
+    data.resize(static_cast<std::size_t>(stride) * rowCount * colCount);
+}
+
+///@brief Creates batch holding copies of matrices
+///@param matrices Non-empty vector of matrices with equal dimensions
+template<typename T>
+MatrixBatch<T>::MatrixBatch(std::vector<Matrix<T>>& matrices) :
+        MatrixBatch(static_cast<int>(matrices.size()), matrices.empty() ? 0 : matrices.front().getRowCount(),
+                    matrices.empty() ? 0 : matrices.front().getColumnCount())
+{
+    for(Matrix<T>& matrix : matrices)
+    {
+        if(matrix.getRowCount() != rowCount || matrix.getColumnCount() != colCount)
+        {
+            throw std::invalid_argument("MatrixBatch - matrices differ in dimensions");
+        }
+    }
+    int grain = std::max(1, batchTaskBytes / static_cast<int>(sizeof(T) * std::max(1, rowCount * colCount)));
+    ThreadPool::instance().parallelFor(0, count, grain, [this, &matrices](int begin, int end) {
+        for(int index = begin; index < end; index++)
+        {
+            setMatrix(index, matrices[index]);
+        }
+    });
+}
+
+template<typename T>
+int MatrixBatch<T>::getCount() {
+    return count;
+}
+
+template<typename T>
+int MatrixBatch<T>::getRowCount() {
+    return rowCount;
+}
+
+template<typename T>
+int MatrixBatch<T>::getColumnCount() {
+    return colCount;
+}
+
+///@brief Gets distance between consecutive element streams, count rounded up to a multiple of batchLanes
+template<typename T>
+int MatrixBatch<T>::getStride() {
+    return stride;
+}
+
+///@brief Gets a reference to element at specified row and column of matrix index
+template<typename T>
+T& MatrixBatch<T>::at(int index, int row, int column) {
+    if(index < 0 || index >= count || row < 0 || row >= rowCount || column < 0 || column >= colCount)
+    {
+        throw std::out_of_range("MatrixBatch::at - index out of range");
+    }
+    return data[static_cast<std::size_t>(row * colCount + column) * stride + index];
+}
+
+///@brief Gets stream of element at specified row and column, holding getStride() values
+template<typename T>
+T* MatrixBatch<T>::elementData(int row, int column) {
+    return data.data() + static_cast<std::size_t>(row * colCount + column) * stride;
+}
+
+///@brief Copies matrix index out of the batch
+template<typename T>
+Matrix<T> MatrixBatch<T>::getMatrix(int index) {
+    if(index < 0 || index >= count)
+    {
+        throw std::out_of_range("MatrixBatch::getMatrix - index out of range");
+    }
+    Matrix<T> matrix(rowCount, colCount);
+    T* destination = matrix.begin();
+    for(int element = 0; element < rowCount * colCount; element++)
+    {
+        destination[element] = data[static_cast<std::size_t>(element) * stride + index];
+    }
+    return matrix;
+}
+
+///@brief Copies matrix into the batch at index
+///@param matrix Matrix with batch dimensions
+template<typename T>
+void MatrixBatch<T>::setMatrix(int index, Matrix<T>& matrix) {
+    if(index < 0 || index >= count)
+    {
+        throw std::out_of_range("MatrixBatch::setMatrix - index out of range");
+    }
+    if(matrix.getRowCount() != rowCount || matrix.getColumnCount() != colCount)
+    {
+        throw std::invalid_argument("MatrixBatch::setMatrix - matrix dimensions do not match");
+    }
+    const T* source = matrix.cbegin();
+    for(int element = 0; element < rowCount * colCount; element++)
+    {
+        data[static_cast<std::size_t>(element) * stride + index] = source[element];
+    }
+}
+
+///@brief Copies every matrix out of the batch
+template<typename T>
+std::vector<Matrix<T>> MatrixBatch<T>::toMatrices() {
+    std::vector<Matrix<T>> matrices;
+    matrices.reserve(count);
+    for(int index = 0; index < count; index++)
+    {
+        matrices.emplace_back(rowCount, colCount);
+    }
+    int grain = std::max(1, batchTaskBytes / static_cast<int>(sizeof(T) * std::max(1, rowCount * colCount)));
+    ThreadPool::instance().parallelFor(0, count, grain, [this, &matrices](int begin, int end) {
+        for(int index = begin; index < end; index++)
+        {
+            T* destination = matrices[index].begin();
+            for(int element = 0; element < rowCount * colCount; element++)
+            {
+                destination[element] = data[static_cast<std::size_t>(element) * stride + index];
+            }
+        }
+    });
+    return matrices;
+}
+
+namespace MatrixKernels {
+
+///@brief Runs body(firstLane, lastLane) on the thread pool for lane ranges that are multiples of batchLanes
+///@param elements Amount of elements of all operands read or written per matrix
+template<typename T, typename Function>
+void forEachBatchChunk(int stride, int elements, Function body) {
+    int chunkCount = stride / batchLanes;
+    int grain = std::max(1, batchTaskBytes / static_cast<int>(batchLanes * sizeof(T) * std::max(1, elements)));
+    ThreadPool::instance().parallelFor(0, chunkCount, grain, [&body](int firstChunk, int lastChunk) {
+        body(firstChunk * batchLanes, lastChunk * batchLanes);
+    });
+}
+
+///@brief Computes determinant and, if withInverse is set, adjugate divided by determinant of batchLanes matrices
+///@note Closed-form cofactor expansion without branches, so every lane runs the same instructions.
+/// Element e of lane l is in[e][l].
+template<int n, bool withInverse, typename T>
+void invertLanes(const T (&in)[n * n][batchLanes], T (&inverse)[n * n][batchLanes], T (&determinant)[batchLanes]) {
+    for(int l = 0; l < batchLanes; l++)
+    {
+        if constexpr(n == 1)
+        {
+            determinant[l] = in[0][l];
+            if constexpr(withInverse)
+            {
+                inverse[0][l] = T(1) / in[0][l];
+            }
+        }
+        else if constexpr(n == 2)
+        {
+            T det = in[0][l] * in[3][l] - in[1][l] * in[2][l];
+            determinant[l] = det;
+            if constexpr(withInverse)
+            {
+                T scale = T(1) / det;
+                inverse[0][l] = in[3][l] * scale;
+                inverse[1][l] = -in[1][l] * scale;
+                inverse[2][l] = -in[2][l] * scale;
+                inverse[3][l] = in[0][l] * scale;
+            }
+        }
+        else if constexpr(n == 3)
+        {
+            T a00 = in[0][l], a01 = in[1][l], a02 = in[2][l];
+            T a10 = in[3][l], a11 = in[4][l], a12 = in[5][l];
+            T a20 = in[6][l], a21 = in[7][l], a22 = in[8][l];
+            T c00 = a11 * a22 - a12 * a21;
+            T c01 = a12 * a20 - a10 * a22;
+            T c02 = a10 * a21 - a11 * a20;
+            T det = a00 * c00 + a01 * c01 + a02 * c02;
+            determinant[l] = det;
+            if constexpr(withInverse)
+            {
+                T scale = T(1) / det;
+                inverse[0][l] = c00 * scale;
+                inverse[1][l] = (a02 * a21 - a01 * a22) * scale;
+                inverse[2][l] = (a01 * a12 - a02 * a11) * scale;
+                inverse[3][l] = c01 * scale;
+                inverse[4][l] = (a00 * a22 - a02 * a20) * scale;
+                inverse[5][l] = (a02 * a10 - a00 * a12) * scale;
+                inverse[6][l] = c02 * scale;
+                inverse[7][l] = (a01 * a20 - a00 * a21) * scale;
+                inverse[8][l] = (a00 * a11 - a01 * a10) * scale;
+            }
+        }
+        else
+        {
+            T a00 = in[0][l], a01 = in[1][l], a02 = in[2][l], a03 = in[3][l];
+            T a10 = in[4][l], a11 = in[5][l], a12 = in[6][l], a13 = in[7][l];
+            T a20 = in[8][l], a21 = in[9][l], a22 = in[10][l], a23 = in[11][l];
+            T a30 = in[12][l], a31 = in[13][l], a32 = in[14][l], a33 = in[15][l];
+            //2x2 minors of the top two rows (s) and of the bottom two rows (c)
+            T s0 = a00 * a11 - a10 * a01, s1 = a00 * a12 - a10 * a02, s2 = a00 * a13 - a10 * a03;
+            T s3 = a01 * a12 - a11 * a02, s4 = a01 * a13 - a11 * a03, s5 = a02 * a13 - a12 * a03;
+            T c0 = a20 * a31 - a30 * a21, c1 = a20 * a32 - a30 * a22, c2 = a20 * a33 - a30 * a23;
+            T c3 = a21 * a32 - a31 * a22, c4 = a21 * a33 - a31 * a23, c5 = a22 * a33 - a32 * a23;
+            T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+            determinant[l] = det;
+            if constexpr(withInverse)
+            {
+                T scale = T(1) / det;
+                inverse[0][l] = (a11 * c5 - a12 * c4 + a13 * c3) * scale;
+                inverse[1][l] = (-a01 * c5 + a02 * c4 - a03 * c3) * scale;
+                inverse[2][l] = (a31 * s5 - a32 * s4 + a33 * s3) * scale;
+                inverse[3][l] = (-a21 * s5 + a22 * s4 - a23 * s3) * scale;
+                inverse[4][l] = (-a10 * c5 + a12 * c2 - a13 * c1) * scale;
+                inverse[5][l] = (a00 * c5 - a02 * c2 + a03 * c1) * scale;
+                inverse[6][l] = (-a30 * s5 + a32 * s2 - a33 * s1) * scale;
+                inverse[7][l] = (a20 * s5 - a22 * s2 + a23 * s1) * scale;
+                inverse[8][l] = (a10 * c4 - a11 * c2 + a13 * c0) * scale;
+                inverse[9][l] = (-a00 * c4 + a01 * c2 - a03 * c0) * scale;
+                inverse[10][l] = (a30 * s4 - a31 * s2 + a33 * s0) * scale;
+                inverse[11][l] = (-a20 * s4 + a21 * s2 - a23 * s0) * scale;
+                inverse[12][l] = (-a10 * c3 + a11 * c1 - a12 * c0) * scale;
+                inverse[13][l] = (a00 * c3 - a01 * c1 + a02 * c0) * scale;
+                inverse[14][l] = (-a30 * s3 + a31 * s1 - a32 * s0) * scale;
+                inverse[15][l] = (a20 * s3 - a21 * s1 + a22 * s0) * scale;
+            }
+        }
+    }
+}
+
+///@brief Runs closed-form inversion on lanes [firstLane, lastLane) of a batch of n x n matrices
+///@note Lanes are copied into local arrays first, which cannot alias, so the lane loop is vectorized
+template<int n, typename T>
+void invertBatchChunk(MatrixBatch<T>& a, MatrixBatch<T>* result, T* determinants, int firstLane, int lastLane) {
+    T in[n * n][batchLanes];
+    T out[n * n][batchLanes];
+    T det[batchLanes];
+    for(int lane = firstLane; lane < lastLane; lane += batchLanes)
+    {
+        for(int element = 0; element < n * n; element++)
+        {
+            const T* source = a.elementData(element / n, element % n) + lane;
+            std::copy(source, source + batchLanes, in[element]);
+        }
+        if(result == nullptr)
+        {
+            invertLanes<n, false>(in, out, det);
+        }
+        else
+        {
+            invertLanes<n, true>(in, out, det);
+            for(int element = 0; element < n * n; element++)
+            {
+                std::copy(out[element], out[element] + batchLanes, result->elementData(element / n, element % n) + lane);
+            }
+        }
+        std::copy(det, det + batchLanes, determinants + lane);
+    }
+}
+
+///@brief Inverts lanes [firstLane, lastLane) of a batch of matrices larger than 4x4 one by one
+///@note Gauss-Jordan elimination with partial pivoting, singular matrices get NaN elements
+template<typename T>
+void invertBatchGeneric(MatrixBatch<T>& a, MatrixBatch<T>* result, T* determinants, int firstLane, int lastLane) {
+    int n = a.getRowCount();
+    std::vector<T> work(static_cast<std::size_t>(n) * n);
+    std::vector<T> inverse(static_cast<std::size_t>(n) * n);
+    for(int lane = firstLane; lane < lastLane; lane++)
+    {
+        for(int element = 0; element < n * n; element++)
+        {
+            work[element] = a.elementData(element / n, element % n)[lane];
+            inverse[element] = element / n == element % n ? T(1) : T(0);
+        }
+        T det = T(1);
+        for(int column = 0; column < n && det != T(0); column++)
+        {
+            int pivot = column;
+            for(int row = column + 1; row < n; row++)
+            {
+                if(std::abs(work[row * n + column]) > std::abs(work[pivot * n + column]))
+                {
+                    pivot = row;
+                }
+            }
+            if(work[pivot * n + column] == T(0))
+            {
+                det = T(0);
+                break;
+            }
+            if(pivot != column)
+            {
+                std::swap_ranges(work.begin() + pivot * n, work.begin() + (pivot + 1) * n, work.begin() + column * n);
+                std::swap_ranges(inverse.begin() + pivot * n, inverse.begin() + (pivot + 1) * n,
+                                 inverse.begin() + column * n);
+                det = -det;
+            }
+            T diagonal = work[column * n + column];
+            det *= diagonal;
+            for(int index = 0; index < n; index++)
+            {
+                work[column * n + index] /= diagonal;
+                inverse[column * n + index] /= diagonal;
+            }
+            for(int row = 0; row < n; row++)
+            {
+                T factor = work[row * n + column];
+                if(row == column || factor == T(0))
+                {
+                    continue;
+                }
+                for(int index = 0; index < n; index++)
+                {
+                    work[row * n + index] -= factor * work[column * n + index];
+                    inverse[row * n + index] -= factor * inverse[column * n + index];
+                }
+            }
+        }
+        determinants[lane] = det;
+        if(result != nullptr)
+        {
+            for(int element = 0; element < n * n; element++)
+            {
+                result->elementData(element / n, element % n)[lane] =
+                        det == T(0) ? std::numeric_limits<T>::quiet_NaN() : inverse[element];
+            }
+        }
+    }
+}
+
+///@brief Computes determinants and optionally inverses of every matrix of square batch
+///@param determinants Receives getStride() values, padding lanes included
+template<typename T>
+void invertBatch(MatrixBatch<T>& a, MatrixBatch<T>* result, T* determinants) {
+    int n = a.getRowCount();
+    forEachBatchChunk<T>(a.getStride(), 2 * n * n, [&](int firstLane, int lastLane) {
+        switch(n)
+        {
+            case 1:
+                invertBatchChunk<1>(a, result, determinants, firstLane, lastLane);
+                break;
+            case 2:
+                invertBatchChunk<2>(a, result, determinants, firstLane, lastLane);
+                break;
+            case 3:
+                invertBatchChunk<3>(a, result, determinants, firstLane, lastLane);
+                break;
+            case 4:
+                invertBatchChunk<4>(a, result, determinants, firstLane, lastLane);
+                break;
+            default:
+                invertBatchGeneric(a, result, determinants, firstLane, lastLane);
+        }
+    });
+}
+
+}
+
+///@brief Computes C[i] = A[i] * B[i] for every matrix of the batches
+///@note Every element of C accumulates products of whole element streams, batchLanes matrices at a time
+///@param c Batch with row count of A and column count of B, must not be A or B
+template<typename T>
+void batchMultiply(MatrixBatch<T>& a, MatrixBatch<T>& b, MatrixBatch<T>& c) {
+    int m = a.getRowCount();
+    int k = a.getColumnCount();
+    int n = b.getColumnCount();
+    if(b.getRowCount() != k || c.getRowCount() != m || c.getColumnCount() != n ||
+       a.getCount() != b.getCount() || a.getCount() != c.getCount())
+    {
+        throw std::invalid_argument("batchMultiply - batch dimensions do not match");
+    }
+    if(&c == &a || &c == &b)
+    {
+        throw std::invalid_argument("batchMultiply - result must not be an operand");
+    }
+    MATRIX_TRACE_SCOPE("batchMultiply", c.getCount(), m * n,
+                       static_cast<std::int64_t>(c.getStride()) * (m * k + k * n + m * n) * sizeof(T));
+    MatrixKernels::forEachBatchChunk<T>(c.getStride(), m * k + k * n + m * n, [&](int firstLane, int lastLane) {
+        for(int row = 0; row < m; row++)
+        {
+            for(int column = 0; column < n; column++)
+            {
+                T* output = c.elementData(row, column);
+                const T* lhs = a.elementData(row, 0);
+                const T* rhs = b.elementData(0, column);
+                for(int lane = firstLane; lane < lastLane; lane++)
+                {
+                    output[lane] = lhs[lane] * rhs[lane];
+                }
+                for(int index = 1; index < k; index++)
+                {
+                    lhs = a.elementData(row, index);
+                    rhs = b.elementData(index, column);
+                    for(int lane = firstLane; lane < lastLane; lane++)
+                    {
+                        output[lane] += lhs[lane] * rhs[lane];
+                    }
+                }
+            }
+        }
+    });
+}
+
+///@brief Transposes every matrix of the batch
+///@param result Batch with swapped dimensions, must not be a
+template<typename T>
+void batchTranspose(MatrixBatch<T>& a, MatrixBatch<T>& result) {
+    if(result.getRowCount() != a.getColumnCount() || result.getColumnCount() != a.getRowCount() ||
+       result.getCount() != a.getCount() || &result == &a)
+    {
+        throw std::invalid_argument("batchTranspose - result must have transposed dimensions and not be the operand");
+    }
+    int rows = a.getRowCount();
+    int cols = a.getColumnCount();
+    MatrixKernels::forEachBatchChunk<T>(a.getStride(), 2 * rows * cols, [&](int firstLane, int lastLane) {
+        for(int row = 0; row < rows; row++)
+        {
+            for(int column = 0; column < cols; column++)
+            {
+                const T* source = a.elementData(row, column);
+                std::copy(source + firstLane, source + lastLane, result.elementData(column, row) + firstLane);
+            }
+        }
+    });
+}
+
+///@brief Computes determinant of every matrix of square batch
+///@note Matrices up to 4x4 use branch-free closed forms vectorized across the batch,
+/// larger ones are factorized one by one with partial pivoting
+///@param result Receives getCount() determinants
+template<std::floating_point T>
+void batchDeterminant(MatrixBatch<T>& a, std::span<T> result) {
+    if(a.getRowCount() != a.getColumnCount() || static_cast<int>(result.size()) != a.getCount())
+    {
+        throw std::invalid_argument("batchDeterminant - batch must be square and result must hold every matrix");
+    }
+    MATRIX_TRACE_SCOPE("batchDeterminant", a.getCount(), a.getRowCount() * a.getColumnCount(),
+                       static_cast<std::int64_t>(a.getStride()) * a.getRowCount() * a.getColumnCount() * sizeof(T));
+    std::vector<T> determinants(a.getStride());
+    MatrixKernels::invertBatch<T>(a, nullptr, determinants.data());
+    std::copy(determinants.begin(), determinants.begin() + a.getCount(), result.begin());
+}
+
+///@brief Inverts every matrix of square batch
+///@note Matrices up to 4x4 use branch-free closed forms vectorized across the batch,
+/// larger ones are inverted one by one with partial pivoting. Inverses of singular matrices are not finite.
+///@param result Batch with dimensions of a, may be a itself
+///@retval Amount of singular matrices
+template<std::floating_point T>
+int batchInverse(MatrixBatch<T>& a, MatrixBatch<T>& result) {
+    if(a.getRowCount() != a.getColumnCount() || result.getRowCount() != a.getRowCount() ||
+       result.getColumnCount() != a.getColumnCount() || result.getCount() != a.getCount())
+    {
+        throw std::invalid_argument("batchInverse - batches must be square with equal dimensions");
+    }
+    MATRIX_TRACE_SCOPE("batchInverse", a.getCount(), a.getRowCount() * a.getColumnCount(),
+                       2 * static_cast<std::int64_t>(a.getStride()) * a.getRowCount() * a.getColumnCount() * sizeof(T));
+    std::vector<T> determinants(a.getStride());
+    MatrixKernels::invertBatch<T>(a, &result, determinants.data());
+    return static_cast<int>(std::count(determinants.begin(), determinants.begin() + a.getCount(), T(0)));
+}
+
+#endif //MATRIX_MATRIXBATCH_H
@@ -5,137 +5,286 @@
 #include <iterator> //std::forward_iterator_tag
 #include <cstddef>  //std::ptrdiff_t
 #include <functional>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include <memory>
+#include <cstdint>
+#include <limits>
+
+#include "MatrixAllocator.h"
+
+///@brief Signed type of matrix dimensions, indexes and element offsets
+///@note 64 bits wide on 64-bit targets, so matrices may hold more than 2^31 elements
+using MatrixIndex = std::ptrdiff_t;
+
+template <typename T>
+class MatrixImpl;
+
+///@brief Holder of shared matrix data that must be notified when a Matrix drops its reference
+///@note Data with an owner is never modified in place, writers detach a private copy first
+template <typename T>
+class MatrixImplOwner {
+public:
+    virtual void release(MatrixImpl<T>* impl) = 0;
+
+protected:
+    ~MatrixImplOwner() = default;
+};
 
 template <typename T>
 class MatrixImpl {
 private:
-    int dataAllocated;
-    int refCount;
-    int rowCount;
-    int colCount;
+    MatrixIndex dataAllocated;
+    std::atomic<int> refCount;
+    MatrixIndex rowCount;
+    MatrixIndex colCount;
     T* data;
+    std::atomic<std::size_t> cachedHash; //Zero when no hash is cached
+    std::atomic<MatrixImplOwner<T>*> owner;
+    //Row modification tracking, off until trackRowVersions() is called
+    std::uint64_t trackingIdentity; //Zero while rows are not tracked
+    std::atomic<std::uint64_t> version;
+    std::atomic<std::uint64_t> allRowsVersion;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> rowVersions;
+
+    void replaceData(T* newData, MatrixIndex newCapacity);
+    void remapRowVersions(MatrixIndex oldRowCount, MatrixIndex newRowCount, MatrixIndex firstChangedRow);
+    static std::uint64_t nextTrackingIdentity();
 
 public:
-    MatrixImpl(int _row, int _col);
+    static MatrixIndex checkedSize(MatrixIndex row, MatrixIndex col);
+    static MatrixImpl* empty();
+
+    MatrixImpl(MatrixIndex _row, MatrixIndex _col);
     MatrixImpl(MatrixImpl& other); //Copy constructor
     MatrixImpl(MatrixImpl&& other) noexcept; //Move constructor
     ~MatrixImpl();
     void addRef();
-    void removeRef();
+    int removeRef();
     int getRefCount();
+    MatrixImplOwner<T>* getOwner();
+    void setOwner(MatrixImplOwner<T>* newOwner);
     void markUnshareable();
     void markShareable();
     bool isShareable();
-    int getRowCount();
-    int getColumnCount();
-    T& at(int row, int col);
-    T* ptrAt(int row, int col);
-    void setRow(int newRowIndex, std::vector<T*> row);
-    void setRow(int newRowIndex, std::vector<std::reference_wrapper<T>> row);
-    void setColumn(int newColumnIndex, std::vector<T*> column);
-    void setColumn(int newColumnIndex, std::vector<std::reference_wrapper<T>> column);
-    void setRowDirect(int newRowIndex, std::vector<T*> row);
-    void setRowDirect(int newRowIndex, std::vector<std::reference_wrapper<T>> row);
-    void setColumnDirect(int newColumnIndex, std::vector<T*> column);
-    void setColumnDirect(int newColumnIndex, std::vector<std::reference_wrapper<T>> column);
+    MatrixIndex getRowCount();
+    MatrixIndex getColumnCount();
+    MatrixIndex getSize();
+    T* getData();
+    T& at(MatrixIndex row, MatrixIndex col);
+    T* ptrAt(MatrixIndex row, MatrixIndex col);
+    std::size_t getCachedHash();
+    void setCachedHash(std::size_t hash);
+    void invalidateHash();
+    void trackRowVersions();
+    std::uint64_t getTrackingIdentity();
+    std::uint64_t getVersion();
+    std::uint64_t getRowVersion(MatrixIndex row);
+    void markRowModified(MatrixIndex row);
+    void markAllRowsModified();
+    void inheritRowVersions(MatrixImpl& source, MatrixIndex firstChangedRow);
+    void setRow(MatrixIndex newRowIndex, std::vector<T*> row);
+    void setRow(MatrixIndex newRowIndex, std::vector<std::reference_wrapper<T>> row);
+    void setColumn(MatrixIndex newColumnIndex, std::vector<T*> column);
+    void setColumn(MatrixIndex newColumnIndex, std::vector<std::reference_wrapper<T>> column);
+    void setRowDirect(MatrixIndex newRowIndex, std::vector<T*> row);
+    void setRowDirect(MatrixIndex newRowIndex, std::vector<std::reference_wrapper<T>> row);
+    void setColumnDirect(MatrixIndex newColumnIndex, std::vector<T*> column);
+    void setColumnDirect(MatrixIndex newColumnIndex, std::vector<std::reference_wrapper<T>> column);
 
     friend bool operator==(MatrixImpl &lhs, MatrixImpl &rhs) {return lhs.data == rhs.data;};
 
-    void reserve(int row, int col);
+    MatrixIndex getCapacity();
+    void reserve(MatrixIndex row, MatrixIndex col);
+    void resize(MatrixIndex newRowCount, MatrixIndex newColumnCount, const T& fill);
+    void reshape(MatrixIndex newRowCount, MatrixIndex newColumnCount);
 };
 
 #include "MatrixImpl.h"
 
+///@brief Gets 0 x 0 data shared by default constructed and moved-from matrices
+///@note Created once and never freed. Its owner ignores releases, so handles need no reference counting
+/// and writers detach a private copy first, as they do for pooled data.
+template<typename T>
+MatrixImpl<T>* MatrixImpl<T>::empty() {
+    struct EmptyOwner : MatrixImplOwner<T> {
+        void release(MatrixImpl<T>*) override {};
+    };
+    static EmptyOwner emptyOwner;
+    static MatrixImpl<T>* emptyImpl = [] {
+        MatrixImpl<T>* impl = new MatrixImpl<T>(0, 0);
+        //Tracking is switched on up front, so aggregates never write the shared instance
+        impl->trackRowVersions();
+        impl->setOwner(&emptyOwner);
+        return impl;
+    }();
+    return emptyImpl;
+}
+
+///@brief Gets element count of row x col matrix
+///@note Throws std::length_error instead of wrapping around when elements or their bytes do not fit MatrixIndex
+template<typename T>
+MatrixIndex MatrixImpl<T>::checkedSize(MatrixIndex row, MatrixIndex col) {
+    if(row < 0 || col < 0)
+    {
+        throw std::invalid_argument("MatrixImpl - negative dimension");
+    }
+    constexpr MatrixIndex maxElements = std::numeric_limits<MatrixIndex>::max() / static_cast<MatrixIndex>(sizeof(T));
+    if(col != 0 && row > maxElements / col)
+    {
+        throw std::length_error("MatrixImpl - element count overflows");
+    }
+    return row * col;
+}
+
 template<typename T>
-MatrixImpl<T>::MatrixImpl(int _row, int _col) :
-        dataAllocated(_row*_col),
+MatrixImpl<T>::MatrixImpl(MatrixIndex _row, MatrixIndex _col) :
+        dataAllocated(checkedSize(_row, _col)),
         refCount(1),
         rowCount(_row),
         colCount(_col),
-        data(nullptr)
+        data(nullptr),
+        cachedHash(0),
+        owner(nullptr),
+        trackingIdentity(0),
+        version(0),
+        allRowsVersion(0)
 {
-    data = new T[dataAllocated];
+    data = MatrixAllocator<T>::allocate(dataAllocated);
 }
 
 //Copy constructor
 template<typename T>
 MatrixImpl<T>::MatrixImpl(MatrixImpl &other) :
-        dataAllocated(other.dataAllocated),
+        dataAllocated(other.rowCount * other.colCount),
         refCount(1),
         rowCount(other.rowCount),
         colCount(other.colCount),
-        data(nullptr)
+        data(nullptr),
+        cachedHash(other.cachedHash.load()),
+        owner(nullptr),
+        trackingIdentity(0),
+        version(0),
+        allRowsVersion(0)
 {
-    T* tempData = new T[rowCount * colCount];
+    T* tempData = MatrixAllocator<T>::allocate(dataAllocated);
     try
     {
-        std::copy( other.data, other.data + dataAllocated, tempData);
+        std::copy(other.data, other.data + dataAllocated, tempData);
     }
     catch(...)
     {
-        delete[] data;
+        MatrixAllocator<T>::deallocate(tempData, dataAllocated);
         throw;
     }
     data = tempData;
+    //Copy gets its own identity, so aggregates that followed the original recompute it once
+    if(other.trackingIdentity != 0)
+    {
+        trackRowVersions();
+    }
 }
 
 //Move constructor
 template<typename T>
 MatrixImpl<T>::MatrixImpl(MatrixImpl &&other) noexcept :
-        dataAllocated(rowCount * colCount),
+        dataAllocated(other.dataAllocated),
         refCount(1),
         rowCount(other.rowCount),
         colCount(other.colCount),
-        data(other.data)
+        data(other.data),
+        cachedHash(other.cachedHash.load()),
+        owner(nullptr),
+        trackingIdentity(other.trackingIdentity),
+        version(other.version.load()),
+        allRowsVersion(other.allRowsVersion.load()),
+        rowVersions(std::move(other.rowVersions))
 {
     other.data = nullptr;
+    other.trackingIdentity = 0;
 }
 
 template<typename T>
 MatrixImpl<T>::~MatrixImpl() {
-    delete[] data;
+    MatrixAllocator<T>::deallocate(data, dataAllocated);
+}
+
+///@brief Frees current storage and takes ownership of storage returned by MatrixAllocator
+template<typename T>
+void MatrixImpl<T>::replaceData(T *newData, MatrixIndex newCapacity) {
+    MatrixAllocator<T>::deallocate(data, dataAllocated);
+    data = newData;
+    dataAllocated = newCapacity;
 }
 
 ///@brief Increments current reference counter
 template<typename T>
 void MatrixImpl<T>::addRef() {
-    refCount++;
+    refCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 ///@brief Decrements current reference counter
+///@retval Reference count after decrement, zero means caller dropped the last reference
 template<typename T>
-void MatrixImpl<T>::removeRef() {
-    refCount--;
+int MatrixImpl<T>::removeRef() {
+    return refCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
 }
 
 ///@brief Gets current reference count
 template<typename T>
 int MatrixImpl<T>::getRefCount() {
-    return refCount;
+    return refCount.load(std::memory_order_acquire);
+}
+
+///@brief Gets owner notified about released references, nullptr for plain reference counted data
+template<typename T>
+MatrixImplOwner<T>* MatrixImpl<T>::getOwner() {
+    return owner.load(std::memory_order_acquire);
+}
+
+///@brief Sets owner notified about released references
+template<typename T>
+void MatrixImpl<T>::setOwner(MatrixImplOwner<T>* newOwner) {
+    owner.store(newOwner, std::memory_order_release);
 }
 
 ///@brief Gets row count
 template<typename T>
-int MatrixImpl<T>::getRowCount() {
+MatrixIndex MatrixImpl<T>::getRowCount() {
     return rowCount;
 }
 
 ///@brief Gets column count
 template<typename T>
-int MatrixImpl<T>::getColumnCount() {
+MatrixIndex MatrixImpl<T>::getColumnCount() {
     return colCount;
 }
 
+///@brief Gets total element count
+template<typename T>
+MatrixIndex MatrixImpl<T>::getSize() {
+    return rowCount * colCount;
+}
+
+///@brief Gets pointer to contiguous row-major element storage
+template<typename T>
+T* MatrixImpl<T>::getData() {
+    return data;
+}
+
 ///@brief Gets a reference to element at specified row and column
 ///@note Indexes row and col are zero-based
 ///@param row Zero-based row index
 ///@param col Zero-based column index
 template<typename T>
-T& MatrixImpl<T>::at(int row, int col) {
-    if(row >= rowCount || col >= colCount)
+T& MatrixImpl<T>::at(MatrixIndex row, MatrixIndex col) {
+    if(row < 0 || col < 0 || row >= rowCount || col >= colCount)
     {
         throw std::out_of_range("Matrix::at - index out of range");
     }
+    invalidateHash();
+    markRowModified(row);
     return data[colCount * row + col];
 }
 
@@ -144,18 +293,147 @@ T& MatrixImpl<T>::at(int row, int col) {
 ///@param row Zero-based row index
 ///@param col Zero-based column index
 template<typename T>
-T *MatrixImpl<T>::ptrAt(int row, int col) {
-    if (row >= rowCount || col >= colCount) {
+T *MatrixImpl<T>::ptrAt(MatrixIndex row, MatrixIndex col) {
+    if (row < 0 || col < 0 || row >= rowCount || col >= colCount) {
         throw std::out_of_range("Matrix::ptrAt - index out of range");
     }
+    invalidateHash();
+    markRowModified(row);
     return &data[colCount * row + col];
 }
 
+///@brief Gets content hash stored by setCachedHash()
+///@retval Cached hash or zero if contents changed since it was stored
+template<typename T>
+std::size_t MatrixImpl<T>::getCachedHash() {
+    return cachedHash.load(std::memory_order_relaxed);
+}
+
+///@brief Stores content hash until the next mutable access
+///@param hash Non-zero content hash
+template<typename T>
+void MatrixImpl<T>::setCachedHash(std::size_t hash) {
+    cachedHash.store(hash, std::memory_order_relaxed);
+}
+
+///@brief Drops cached content hash, called by every mutable access path
+template<typename T>
+void MatrixImpl<T>::invalidateHash() {
+    if(cachedHash.load(std::memory_order_relaxed) != 0)
+    {
+        cachedHash.store(0, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+std::uint64_t MatrixImpl<T>::nextTrackingIdentity() {
+    static std::atomic<std::uint64_t> lastIdentity{0};
+    return lastIdentity.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+///@brief Starts recording version of every row, does nothing if rows are already tracked
+///@note Untracked data pays a single branch per mutable access
+template<typename T>
+void MatrixImpl<T>::trackRowVersions() {
+    if(trackingIdentity != 0)
+    {
+        return;
+    }
+    rowVersions = std::make_unique<std::atomic<std::uint64_t>[]>(rowCount);
+    trackingIdentity = nextTrackingIdentity();
+}
+
+///@brief Gets process-wide unique identity of row versions, zero while rows are not tracked
+///@note Versions of data with different identities are unrelated
+template<typename T>
+std::uint64_t MatrixImpl<T>::getTrackingIdentity() {
+    return trackingIdentity;
+}
+
+///@brief Gets most recent version assigned to any row
+template<typename T>
+std::uint64_t MatrixImpl<T>::getVersion() {
+    return version.load(std::memory_order_acquire);
+}
+
+///@brief Gets version of last modification of row
+///@param row Zero-based row index
+template<typename T>
+std::uint64_t MatrixImpl<T>::getRowVersion(MatrixIndex row) {
+    return std::max(rowVersions[row].load(std::memory_order_relaxed), allRowsVersion.load(std::memory_order_relaxed));
+}
+
+///@brief Assigns new version to row, called by every mutable access path that knows the modified row
+template<typename T>
+void MatrixImpl<T>::markRowModified(MatrixIndex row) {
+    if(trackingIdentity != 0)
+    {
+        rowVersions[row].store(version.fetch_add(1, std::memory_order_acq_rel) + 1, std::memory_order_relaxed);
+    }
+}
+
+///@brief Assigns new version to all rows in constant time, called by bulk mutable access paths
+template<typename T>
+void MatrixImpl<T>::markAllRowsModified() {
+    if(trackingIdentity != 0)
+    {
+        allRowsVersion.store(version.fetch_add(1, std::memory_order_acq_rel) + 1, std::memory_order_relaxed);
+    }
+}
+
+///@brief Continues row versions of data this instance replaces
+///@note Only exclusively owned source passes its identity on, since it is dropped right after.
+/// Shared source keeps its identity and this instance starts tracking with a new one.
+///@param source Tracked or untracked data replaced by this instance
+///@param firstChangedRow Rows from this index on moved or changed and get new versions
+template<typename T>
+void MatrixImpl<T>::inheritRowVersions(MatrixImpl &source, MatrixIndex firstChangedRow) {
+    if(source.trackingIdentity == 0)
+    {
+        return;
+    }
+    if(source.getRefCount() != 1 || source.getOwner() != nullptr)
+    {
+        trackRowVersions();
+        return;
+    }
+    trackingIdentity = source.trackingIdentity;
+    version.store(source.version.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    allRowsVersion.store(source.allRowsVersion.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    rowVersions = std::move(source.rowVersions);
+    source.trackingIdentity = 0;
+    remapRowVersions(source.rowCount, rowCount, firstChangedRow);
+}
+
+///@brief Resizes row versions from oldRowCount to newRowCount rows, rows from firstChangedRow on get a new version
+template<typename T>
+void MatrixImpl<T>::remapRowVersions(MatrixIndex oldRowCount, MatrixIndex newRowCount, MatrixIndex firstChangedRow) {
+    if(trackingIdentity == 0)
+    {
+        return;
+    }
+    MatrixIndex keptRows = std::min({firstChangedRow, oldRowCount, newRowCount});
+    if(newRowCount != oldRowCount)
+    {
+        auto temp = std::make_unique<std::atomic<std::uint64_t>[]>(newRowCount);
+        for(MatrixIndex row = 0; row < keptRows; row++)
+        {
+            temp[row].store(rowVersions[row].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        rowVersions = std::move(temp);
+    }
+    std::uint64_t changed = version.fetch_add(1, std::memory_order_acq_rel) + 1;
+    for(MatrixIndex row = keptRows; row < newRowCount; row++)
+    {
+        rowVersions[row].store(changed, std::memory_order_relaxed);
+    }
+}
+
 ///@brief Sets row at specified index with objects from row
 ///@param newRowIndex Index at which row will be set
 ///@param row Vector holding pointers to objects that will be set to matrix row
 template<typename T>
-void MatrixImpl<T>::setRow(int newRowIndex, std::vector<T *> row) {
+void MatrixImpl<T>::setRow(MatrixIndex newRowIndex, std::vector<T *> row) {
     if(row.size() != this->colCount)
     {
         throw std::out_of_range("MatrixImpl::setRow row vector does not match internal row size");
@@ -166,41 +444,42 @@ void MatrixImpl<T>::setRow(int newRowIndex, std::vector<T *> row) {
         throw std::out_of_range("MatrixImpl::setRow column index out of range");
     }
 
-    T* temp = new T[this->rowCount * this->colCount];
+    T* temp = MatrixAllocator<T>::allocate(this->rowCount * this->colCount);
 
     try
     {
-        for(int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+        for(MatrixIndex rowIndex = 0; rowIndex < rowCount; rowIndex++)
         {
             if(rowIndex == newRowIndex)
             {
-                for (int colIndex = 0; colIndex < colCount; colIndex++) {
+                for (MatrixIndex colIndex = 0; colIndex < colCount; colIndex++) {
                     temp[colCount * rowIndex + colIndex] = *row.at(colIndex);
                 }
             }
             else
             {
-                for (int colIndex = 0; colIndex < colCount; colIndex++) {
-                    temp[colCount * rowIndex + colIndex] = this->at(rowIndex,colIndex);
+                for (MatrixIndex colIndex = 0; colIndex < colCount; colIndex++) {
+                    temp[colCount * rowIndex + colIndex] = data[colCount * rowIndex + colIndex];
                 }
             }
         }
     }
     catch (...)
     {
-        delete[] temp;
+        MatrixAllocator<T>::deallocate(temp, this->rowCount * this->colCount);
         throw;
     }
 
-    delete[] this->data;
-    this->data = temp;
+    replaceData(temp, this->rowCount * this->colCount);
+    invalidateHash();
+    markRowModified(newRowIndex);
 }
 
 ///@brief Sets row at specified index with objects from row
 ///@param newRowIndex Index at which row will be set
 ///@param row Vector holding references to objects that will be set to matrix row
 template<typename T>
-void MatrixImpl<T>::setRow(int newRowIndex, std::vector<std::reference_wrapper<T>> row) {
+void MatrixImpl<T>::setRow(MatrixIndex newRowIndex, std::vector<std::reference_wrapper<T>> row) {
     if(row.size() != this->colCount)
     {
         throw std::out_of_range("MatrixImpl::setRow row vector does not match internal row size");
@@ -211,41 +490,42 @@ void MatrixImpl<T>::setRow(int newRowIndex, std::vector<std::reference_wrapper<T
         throw std::out_of_range("MatrixImpl::setRow column index out of range");
     }
 
-    T* temp = new T[this->rowCount * this->colCount];
+    T* temp = MatrixAllocator<T>::allocate(this->rowCount * this->colCount);
 
     try
     {
-        for(int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+        for(MatrixIndex rowIndex = 0; rowIndex < rowCount; rowIndex++)
         {
             if(rowIndex == newRowIndex)
             {
-                for (int colIndex = 0; colIndex < colCount; colIndex++) {
+                for (MatrixIndex colIndex = 0; colIndex < colCount; colIndex++) {
                     temp[colCount * rowIndex + colIndex] = row.at(colIndex);
                 }
             }
             else
             {
-                for (int colIndex = 0; colIndex < colCount; colIndex++) {
-                    temp[colCount * rowIndex + colIndex] = this->at(rowIndex,colIndex);
+                for (MatrixIndex colIndex = 0; colIndex < colCount; colIndex++) {
+                    temp[colCount * rowIndex + colIndex] = data[colCount * rowIndex + colIndex];
                 }
             }
         }
     }
     catch (...)
     {
-        delete[] temp;
+        MatrixAllocator<T>::deallocate(temp, this->rowCount * this->colCount);
         throw;
     }
 
-    delete[] this->data;
-    this->data = temp;
+    replaceData(temp, this->rowCount * this->colCount);
+    invalidateHash();
+    markRowModified(newRowIndex);
 }
 
 ///@brief Sets column at specified index with objects from column
 ///@param newColumnIndex Index at which column will be set
 ///@param column Vector holding pointers to objects that will be set to matrix column
 template<typename T>
-void MatrixImpl<T>::setColumn(int newColumnIndex, std::vector<T *> column) {
+void MatrixImpl<T>::setColumn(MatrixIndex newColumnIndex, std::vector<T *> column) {
     if(column.size() != this->rowCount)
     {
         throw std::out_of_range("MatrixImpl::setColumn column vector does not match internal column size");
@@ -256,21 +536,21 @@ void MatrixImpl<T>::setColumn(int newColumnIndex, std::vector<T *> column) {
         throw std::out_of_range("MatrixImpl::setColumn column index out of range");
     }
 
-    T* temp = new T[this->rowCount * this->colCount];
+    T* temp = MatrixAllocator<T>::allocate(this->rowCount * this->colCount);
 
     try
     {
-        for(int columnIndex = 0; columnIndex < rowCount; columnIndex++)
+        for(MatrixIndex columnIndex = 0; columnIndex < rowCount; columnIndex++)
         {
             if(columnIndex == newColumnIndex)
             {
-                for (int rowIndex = 0; rowIndex < colCount; rowIndex++) {
+                for (MatrixIndex rowIndex = 0; rowIndex < colCount; rowIndex++) {
                     temp[colCount * rowIndex + columnIndex] = *column.at(rowIndex);
                 }
             }
             else
             {
-                for (int rowIndex = 0; rowIndex < colCount; rowIndex++) {
+                for (MatrixIndex rowIndex = 0; rowIndex < colCount; rowIndex++) {
                     temp[colCount * rowIndex + columnIndex] = this->at(rowIndex,columnIndex);
                 }
             }
@@ -278,19 +558,20 @@ void MatrixImpl<T>::setColumn(int newColumnIndex, std::vector<T *> column) {
     }
     catch (...)
     {
-        delete[] temp;
+        MatrixAllocator<T>::deallocate(temp, this->rowCount * this->colCount);
         throw;
     }
 
-    delete[] this->data;
-    this->data = temp;
+    replaceData(temp, this->rowCount * this->colCount);
+    invalidateHash();
+    markAllRowsModified();
 }
 
 ///@brief Sets column at specified index with objects from column
 ///@param newColumnIndex Index at which column will be set
 ///@param column Vector holding references to objects that will be set to matrix column
 template<typename T>
-void MatrixImpl<T>::setColumn(int newColumnIndex, std::vector<std::reference_wrapper<T>> column) {
+void MatrixImpl<T>::setColumn(MatrixIndex newColumnIndex, std::vector<std::reference_wrapper<T>> column) {
     if(column.size() != this->rowCount)
     {
         throw std::out_of_range("MatrixImpl::setColumn column vector does not match internal column size");
@@ -301,21 +582,21 @@ void MatrixImpl<T>::setColumn(int newColumnIndex, std::vector<std::reference_wra
         throw std::out_of_range("MatrixImpl::setColumn column index out of range");
     }
 
-    T* temp = new T[this->rowCount * this->colCount];
+    T* temp = MatrixAllocator<T>::allocate(this->rowCount * this->colCount);
 
     try
     {
-        for(int columnIndex = 0; columnIndex < rowCount; columnIndex++)
+        for(MatrixIndex columnIndex = 0; columnIndex < rowCount; columnIndex++)
         {
             if(columnIndex == newColumnIndex)
             {
-                for (int rowIndex = 0; rowIndex < colCount; rowIndex++) {
+                for (MatrixIndex rowIndex = 0; rowIndex < colCount; rowIndex++) {
                     temp[colCount * rowIndex + columnIndex] = column.at(rowIndex);
                 }
             }
             else
             {
-                for (int rowIndex = 0; rowIndex < colCount; rowIndex++) {
+                for (MatrixIndex rowIndex = 0; rowIndex < colCount; rowIndex++) {
                     temp[colCount * rowIndex + columnIndex] = this->at(rowIndex,columnIndex);
                 }
             }
@@ -323,12 +604,13 @@ void MatrixImpl<T>::setColumn(int newColumnIndex, std::vector<std::reference_wra
     }
     catch (...)
     {
-        delete[] temp;
+        MatrixAllocator<T>::deallocate(temp, this->rowCount * this->colCount);
         throw;
     }
 
-    delete[] this->data;
-    this->data = temp;
+    replaceData(temp, this->rowCount * this->colCount);
+    invalidateHash();
+    markAllRowsModified();
 }
 
 ///@brief Sets row at specified index with objects from row directly
@@ -336,7 +618,7 @@ void MatrixImpl<T>::setColumn(int newColumnIndex, std::vector<std::reference_wra
 ///@param newRowIndex Index at which row will be set
 ///@param row Vector holding references to objects that will be set to matrix row
 template<typename T>
-void MatrixImpl<T>::setRowDirect(int newRowIndex, std::vector<T *> row) {
+void MatrixImpl<T>::setRowDirect(MatrixIndex newRowIndex, std::vector<T *> row) {
     if(row.size() != this->colCount)
     {
         throw std::out_of_range("MatrixImpl::setRowDirect row vector size > ");
@@ -347,9 +629,11 @@ void MatrixImpl<T>::setRowDirect(int newRowIndex, std::vector<T *> row) {
         throw std::out_of_range("MatrixImpl::setRowDirect row index out of range");
     }
 
-    for (int columnIndex = 0; columnIndex < colCount; columnIndex++) {
+    for (MatrixIndex columnIndex = 0; columnIndex < colCount; columnIndex++) {
         this->data[colCount * newRowIndex + columnIndex] = *row.at(columnIndex);
     }
+    invalidateHash();
+    markRowModified(newRowIndex);
 }
 
 ///@brief Sets row at specified index with objects from row directly
@@ -357,7 +641,7 @@ void MatrixImpl<T>::setRowDirect(int newRowIndex, std::vector<T *> row) {
 ///@param newRowIndex Index at which row will be set
 ///@param row Vector holding pointers to objects that will be set to matrix row
 template<typename T>
-void MatrixImpl<T>::setRowDirect(int newRowIndex, std::vector<std::reference_wrapper<T>> row) {
+void MatrixImpl<T>::setRowDirect(MatrixIndex newRowIndex, std::vector<std::reference_wrapper<T>> row) {
     if(row.size() != this->colCount)
     {
         throw std::out_of_range("MatrixImpl::setRowDirect row vector size > ");
@@ -368,9 +652,11 @@ void MatrixImpl<T>::setRowDirect(int newRowIndex, std::vector<std::reference_wra
         throw std::out_of_range("MatrixImpl::setRowDirect row index out of range");
     }
 
-    for (int columnIndex = 0; columnIndex < colCount; columnIndex++) {
+    for (MatrixIndex columnIndex = 0; columnIndex < colCount; columnIndex++) {
         this->data[colCount * newRowIndex + columnIndex] = row.at(columnIndex);
     }
+    invalidateHash();
+    markRowModified(newRowIndex);
 }
 
 ///@brief Sets column at specified index with objects from column directly
@@ -378,7 +664,7 @@ void MatrixImpl<T>::setRowDirect(int newRowIndex, std::vector<std::reference_wra
 ///@param newColumnIndex Index at which column will be set
 ///@param column Vector holding pointers to objects that will be set to matrix column
 template<typename T>
-void MatrixImpl<T>::setColumnDirect(int newColumnIndex, std::vector<T *> column) {
+void MatrixImpl<T>::setColumnDirect(MatrixIndex newColumnIndex, std::vector<T *> column) {
     if(column.size() != this->rowCount)
     {
         throw std::out_of_range("MatrixImpl::setColumnDirect row vector size > ");
@@ -389,16 +675,18 @@ void MatrixImpl<T>::setColumnDirect(int newColumnIndex, std::vector<T *> column)
         throw std::out_of_range("MatrixImpl::setColumnDirect row index out of range");
     }
 
-    for (int rowIndex = 0; rowIndex < rowCount; rowIndex++) {
+    for (MatrixIndex rowIndex = 0; rowIndex < rowCount; rowIndex++) {
         this->data[colCount * rowIndex + newColumnIndex] = *column.at(rowIndex);
     }
+    invalidateHash();
+    markAllRowsModified();
 }
 ///@brief Sets column at specified index with objects from column directly
 ///@warning This method is not strong exception-safe and should only be used on temporary objects
 ///@param newColumnIndex Index at which column will be set
 ///@param column Vector holding references to objects that will be set to matrix column
 template<typename T>
-void MatrixImpl<T>::setColumnDirect(int newColumnIndex, std::vector<std::reference_wrapper<T>> column) {
+void MatrixImpl<T>::setColumnDirect(MatrixIndex newColumnIndex, std::vector<std::reference_wrapper<T>> column) {
     if(column.size() != this->colCount)
     {
         throw std::out_of_range("MatrixImpl::setRowDirect row vector size > ");
@@ -409,10 +697,117 @@ void MatrixImpl<T>::setColumnDirect(int newColumnIndex, std::vector<std::referen
         throw std::out_of_range("MatrixImpl::setRowDirect row index out of range");
     }
 
-    for (int rowIndex = 0; rowIndex < colCount; rowIndex++) {
+    for (MatrixIndex rowIndex = 0; rowIndex < colCount; rowIndex++) {
         this->data[colCount * rowIndex + newColumnIndex] = column.at(rowIndex);
     }
+    invalidateHash();
+    markAllRowsModified();
+}
+
+///@brief Gets amount of elements that fit into allocated storage
+template<typename T>
+MatrixIndex MatrixImpl<T>::getCapacity() {
+    return dataAllocated;
 }
 
+///@brief Grows allocated storage to fit row * col elements, keeping current contents
+///@param row Row count to reserve storage for
+///@param col Column count to reserve storage for
+template<typename T>
+void MatrixImpl<T>::reserve(MatrixIndex row, MatrixIndex col) {
+    MatrixIndex capacity = checkedSize(row, col);
+    if(capacity <= dataAllocated)
+    {
+        return;
+    }
+    T* temp = MatrixAllocator<T>::allocate(capacity);
+    try
+    {
+        std::move(data, data + rowCount * colCount, temp);
+    }
+    catch(...)
+    {
+        MatrixAllocator<T>::deallocate(temp, capacity);
+        throw;
+    }
+    replaceData(temp, capacity);
+}
+
+///@brief Changes dimensions keeping elements at their row and column, new elements are set to fill
+///@note Elements are moved inside current storage when it is large enough, otherwise storage is reallocated
+///@param newRowCount Row count after resize
+///@param newColumnCount Column count after resize
+///@param fill Value of elements not present before resize
+template<typename T>
+void MatrixImpl<T>::resize(MatrixIndex newRowCount, MatrixIndex newColumnCount, const T &fill) {
+    MatrixIndex newSize = checkedSize(newRowCount, newColumnCount);
+    MatrixIndex keptRows = std::min(rowCount, newRowCount);
+    MatrixIndex keptColumns = std::min(colCount, newColumnCount);
+    if(newSize > dataAllocated)
+    {
+        T* temp = MatrixAllocator<T>::allocate(newSize);
+        try
+        {
+            for(MatrixIndex row = 0; row < keptRows; row++)
+            {
+                std::move(data + row * colCount, data + row * colCount + keptColumns, temp + row * newColumnCount);
+                std::fill(temp + row * newColumnCount + keptColumns, temp + (row + 1) * newColumnCount, fill);
+            }
+            std::fill(temp + keptRows * newColumnCount, temp + newSize, fill);
+        }
+        catch(...)
+        {
+            MatrixAllocator<T>::deallocate(temp, newSize);
+            throw;
+        }
+        replaceData(temp, newSize);
+    }
+    else if(newColumnCount > colCount)
+    {
+        //Rows move to higher offsets, so the last row goes first. Row 0 stays in place, moving it onto
+        //itself would leave moved-from elements behind.
+        for(MatrixIndex row = keptRows - 1; row >= 0; row--)
+        {
+            if(row != 0)
+            {
+                std::move_backward(data + row * colCount, data + (row + 1) * colCount,
+                                   data + row * newColumnCount + colCount);
+            }
+            std::fill(data + row * newColumnCount + colCount, data + (row + 1) * newColumnCount, fill);
+        }
+        std::fill(data + keptRows * newColumnCount, data + newSize, fill);
+    }
+    else
+    {
+        //Rows move to lower offsets, so the first row goes first. Rows that keep their offset, row 0 and every
+        //row when the column count is unchanged, are not moved onto themselves.
+        for(MatrixIndex row = newColumnCount == colCount ? keptRows : 1; row < keptRows; row++)
+        {
+            std::move(data + row * colCount, data + row * colCount + newColumnCount, data + row * newColumnCount);
+        }
+        std::fill(data + keptRows * newColumnCount, data + newSize, fill);
+    }
+    //Rows keep their versions only if their elements stayed the same
+    remapRowVersions(rowCount, newRowCount, newColumnCount == colCount ? keptRows : 0);
+    rowCount = newRowCount;
+    colCount = newColumnCount;
+    invalidateHash();
+}
+
+///@brief Reinterprets row-major storage with new dimensions without moving elements
+///@param newRowCount Row count after reshape
+///@param newColumnCount Column count after reshape, newRowCount * newColumnCount must equal element count
+template<typename T>
+void MatrixImpl<T>::reshape(MatrixIndex newRowCount, MatrixIndex newColumnCount) {
+    if(newRowCount < 0 || newColumnCount < 0 || (newColumnCount != 0 && newRowCount > getSize() / newColumnCount) ||
+       newRowCount * newColumnCount != getSize())
+    {
+        throw std::invalid_argument("MatrixImpl::reshape - element count does not match");
+    }
+    remapRowVersions(rowCount, newRowCount, 0);
+    rowCount = newRowCount;
+    colCount = newColumnCount;
+    invalidateHash();
+}
 
 #endif //MATRIX_MATRIXIMPL_H
\ No newline at end of file
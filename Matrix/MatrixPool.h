@@ -0,0 +1,107 @@
+#ifndef MATRIX_MATRIXPOOL_H
+#define MATRIX_MATRIXPOOL_H
+
+#include <mutex>
+#include <unordered_map>
+
+#include "Matrix.h"
+#include "MatrixImpl.h"
+
+///@brief Content-addressed pool that makes identical matrices share one MatrixImpl
+///@note Pool does not keep data alive: data is evicted when the last Matrix referring to it is destroyed.
+/// Interned data is never written in place, writing through any handle detaches a private copy.
+/// Lookups and releases are thread-safe. Pool must outlive every interned Matrix that is in concurrent use.
+template<typename T>
+class MatrixPool : public MatrixImplOwner<T> {
+private:
+    std::mutex mutex;
+    std::unordered_multimap<std::size_t, MatrixImpl<T>*> entries;
+
+public:
+    MatrixPool() = default;
+    MatrixPool(const MatrixPool& other) = delete;
+    MatrixPool& operator=(const MatrixPool& other) = delete;
+    ~MatrixPool();
+
+    Matrix<T> intern(Matrix<T>& matrix);
+    int getSize();
+    void release(MatrixImpl<T>* impl) override;
+};
+
+///@brief Detaches all pooled data, remaining matrices keep it alive with plain reference counting
+template<typename T>
+MatrixPool<T>::~MatrixPool() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto& entry : entries)
+    {
+        entry.second->setOwner(nullptr);
+    }
+    entries.clear();
+}
+
+///@brief Gets matrix sharing data with an identical pooled matrix, adding matrix to pool if there is none
+///@note Exclusively owned data of matrix is adopted by the pool, data shared with other handles is copied
+///@param matrix Matrix to look up
+///@retval Handle to pooled data equal to matrix
+template<typename T>
+Matrix<T> MatrixPool<T>::intern(Matrix<T>& matrix) {
+    MATRIX_TRACE_SCOPE("MatrixPool::intern", matrix.getRowCount(), matrix.getColumnCount(),
+                       static_cast<std::int64_t>(matrix.getSize()) * sizeof(T));
+    std::size_t key = matrix.hash();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto range = entries.equal_range(key);
+    for(auto entry = range.first; entry != range.second; entry++)
+    {
+        if(Matrix<T>::contentEquals(entry->second, matrix.impl))
+        {
+            entry->second->addRef();
+            return Matrix<T>(entry->second);
+        }
+    }
+
+    MatrixImpl<T>* impl = matrix.impl;
+    if(impl->getRefCount() == 1 && impl->getOwner() == nullptr)
+    {
+        impl->addRef();
+    }
+    else
+    {
+        //Other handles may be used concurrently, so they keep their data and pool gets its own copy
+        impl = new MatrixImpl<T>(*impl);
+    }
+    impl->setOwner(this);
+    //Hash is only cached once data has an owner, release() finds the entry by it
+    impl->setCachedHash(key);
+    entries.emplace(key, impl);
+    return Matrix<T>(impl);
+}
+
+///@brief Gets amount of distinct matrices in pool
+template<typename T>
+int MatrixPool<T>::getSize() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(entries.size());
+}
+
+///@brief Drops reference to pooled data, evicting it when that was the last one
+template<typename T>
+void MatrixPool<T>::release(MatrixImpl<T>* impl) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(impl->removeRef() != 0)
+    {
+        return;
+    }
+    auto range = entries.equal_range(impl->getCachedHash());
+    auto found = std::find_if(range.first, range.second, [impl](auto& entry) {return entry.second == impl;});
+    if(found == range.second)
+    {
+        found = std::find_if(entries.begin(), entries.end(), [impl](auto& entry) {return entry.second == impl;});
+    }
+    if(found != entries.end())
+    {
+        entries.erase(found);
+    }
+    delete impl;
+}
+
+#endif //MATRIX_MATRIXPOOL_H
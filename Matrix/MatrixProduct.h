@@ -0,0 +1,309 @@
+#ifndef MATRIX_MATRIXPRODUCT_H
+#define MATRIX_MATRIXPRODUCT_H
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixAlgebra.h"
+
+///@brief Lazy product of a chain of matrices
+///@note Nothing is computed until the product is assigned to a Matrix or evaluate() is called.
+/// Evaluation picks the parenthesization with fewest scalar multiplications using the classic
+/// matrix-chain dynamic program and reuses scratch buffers between intermediate products.
+/// Operands are held by reference counted handles, so temporaries may be used as operands.
+template<typename T>
+class MatrixProduct {
+private:
+    struct Operand {
+        const T* data;
+        int buffer; //Index of scratch buffer holding data, -1 for operand data
+    };
+
+    std::vector<Matrix<T>> operands;
+    std::vector<std::vector<T>> buffers;
+    std::vector<bool> bufferBusy;
+
+    std::vector<MatrixIndex> getDimensions();
+    std::vector<std::vector<int>> getSplits(long long* cost);
+    std::string describe(std::vector<std::vector<int>>& splits, int first, int last);
+    Operand multiply(std::vector<std::vector<int>>& splits, std::vector<MatrixIndex>& dimensions, int first,
+                     int last, T* destination);
+    int acquireBuffer(MatrixIndex size);
+    static long long productCost(MatrixIndex m, MatrixIndex k, MatrixIndex n);
+    void releaseBuffer(int buffer);
+
+public:
+    MatrixProduct(const Matrix<T>& lhs, const Matrix<T>& rhs);
+    MatrixProduct& append(const Matrix<T>& rhs);
+    MatrixProduct& append(MatrixProduct&& rhs);
+    MatrixProduct& prepend(const Matrix<T>& lhs);
+    int getOperandCount();
+    long long getCost();
+    std::string getOrder();
+    Matrix<T> evaluate();
+};
+
+template<typename T>
+MatrixProduct<T>::MatrixProduct(const Matrix<T> &lhs, const Matrix<T> &rhs) {
+    operands.push_back(lhs);
+    operands.push_back(rhs);
+}
+
+///@brief Appends operand to the right end of the chain
+template<typename T>
+MatrixProduct<T>& MatrixProduct<T>::append(const Matrix<T> &rhs) {
+    operands.push_back(rhs);
+    return *this;
+}
+
+///@brief Appends all operands of other chain to the right end of the chain
+template<typename T>
+MatrixProduct<T>& MatrixProduct<T>::append(MatrixProduct<T> &&rhs) {
+    for(Matrix<T>& operand : rhs.operands)
+    {
+        operands.push_back(operand);
+    }
+    return *this;
+}
+
+///@brief Prepends operand to the left end of the chain
+template<typename T>
+MatrixProduct<T>& MatrixProduct<T>::prepend(const Matrix<T> &lhs) {
+    operands.insert(operands.begin(), lhs);
+    return *this;
+}
+
+///@brief Gets amount of matrices in the chain
+template<typename T>
+int MatrixProduct<T>::getOperandCount() {
+    return static_cast<int>(operands.size());
+}
+
+///@brief Gets amount of scalar multiplications needed by optimal parenthesization
+template<typename T>
+long long MatrixProduct<T>::getCost() {
+    long long cost = 0;
+    getSplits(&cost);
+    return cost;
+}
+
+///@brief Gets optimal parenthesization with operands numbered from zero, e.g. "((0*(1*2))*3)"
+template<typename T>
+std::string MatrixProduct<T>::getOrder() {
+    std::vector<std::vector<int>> splits = getSplits(nullptr);
+    return describe(splits, 0, getOperandCount() - 1);
+}
+
+///@brief Computes the product in optimal order
+///@retval Matrix with row count of first operand and column count of last operand
+template<typename T>
+Matrix<T> MatrixProduct<T>::evaluate() {
+    MATRIX_TRACE_SCOPE("MatrixProduct::evaluate", getOperandCount(), 0, 0);
+    std::vector<MatrixIndex> dimensions = getDimensions();
+    std::vector<std::vector<int>> splits = getSplits(nullptr);
+    int last = getOperandCount() - 1;
+    Matrix<T> result(dimensions.front(), dimensions.back());
+    multiply(splits, dimensions, 0, last, result.begin());
+    buffers.clear();
+    bufferBusy.clear();
+    return result;
+}
+
+///@brief Gets chain dimensions, operand i has dimensions[i] rows and dimensions[i + 1] columns
+template<typename T>
+std::vector<MatrixIndex> MatrixProduct<T>::getDimensions() {
+    std::vector<MatrixIndex> dimensions;
+    dimensions.push_back(operands.front().getRowCount());
+    for(Matrix<T>& operand : operands)
+    {
+        if(operand.getRowCount() != dimensions.back())
+        {
+            throw std::invalid_argument("MatrixProduct - matrix dimensions do not match");
+        }
+        dimensions.push_back(operand.getColumnCount());
+    }
+    return dimensions;
+}
+
+///@brief Gets amount of scalar multiplications of m x k times k x n product, saturating at the long long maximum
+template<typename T>
+long long MatrixProduct<T>::productCost(MatrixIndex m, MatrixIndex k, MatrixIndex n) {
+    constexpr long long maximum = std::numeric_limits<long long>::max();
+    if(k != 0 && m > maximum / k)
+    {
+        return maximum;
+    }
+    long long cost = static_cast<long long>(m) * k;
+    return n != 0 && cost > maximum / n ? maximum : cost * n;
+}
+
+///@brief Runs matrix-chain dynamic program
+///@note Costs saturate at the long long maximum, chains that large cannot be evaluated anyway
+///@param cost Receives amount of scalar multiplications of the whole chain if not nullptr
+///@retval Table where splits[first][last] is the last operand of left factor of optimal split
+template<typename T>
+std::vector<std::vector<int>> MatrixProduct<T>::getSplits(long long* cost) {
+    std::vector<MatrixIndex> dimensions = getDimensions();
+    int count = getOperandCount();
+    std::vector<std::vector<long long>> costs(count, std::vector<long long>(count, 0));
+    std::vector<std::vector<int>> splits(count, std::vector<int>(count, 0));
+    for(int length = 2; length <= count; length++)
+    {
+        for(int first = 0; first + length - 1 < count; first++)
+        {
+            int last = first + length - 1;
+            costs[first][last] = std::numeric_limits<long long>::max();
+            splits[first][last] = first;
+            for(int split = first; split < last; split++)
+            {
+                long long parts[3] = {costs[first][split], costs[split + 1][last],
+                                      productCost(dimensions[first], dimensions[split + 1], dimensions[last + 1])};
+                long long candidate = 0;
+                for(long long part : parts)
+                {
+                    candidate = part > std::numeric_limits<long long>::max() - candidate ?
+                            std::numeric_limits<long long>::max() : candidate + part;
+                }
+                if(candidate < costs[first][last])
+                {
+                    costs[first][last] = candidate;
+                    splits[first][last] = split;
+                }
+            }
+        }
+    }
+    if(cost != nullptr)
+    {
+        *cost = costs[0][count - 1];
+    }
+    return splits;
+}
+
+template<typename T>
+std::string MatrixProduct<T>::describe(std::vector<std::vector<int>> &splits, int first, int last) {
+    if(first == last)
+    {
+        return std::to_string(first);
+    }
+    int split = splits[first][last];
+    return "(" + describe(splits, first, split) + "*" + describe(splits, split + 1, last) + ")";
+}
+
+///@brief Computes product of operands [first, last]
+///@param destination Memory receiving the product, nullptr to use a scratch buffer
+template<typename T>
+typename MatrixProduct<T>::Operand MatrixProduct<T>::multiply(std::vector<std::vector<int>> &splits,
+                                                              std::vector<MatrixIndex> &dimensions, int first,
+                                                              int last, T *destination) {
+    if(first == last)
+    {
+        return Operand{operands[first].cbegin(), -1};
+    }
+    int split = splits[first][last];
+    Operand lhs = multiply(splits, dimensions, first, split, nullptr);
+    Operand rhs = multiply(splits, dimensions, split + 1, last, nullptr);
+    MatrixIndex m = dimensions[first];
+    MatrixIndex k = dimensions[split + 1];
+    MatrixIndex n = dimensions[last + 1];
+    Operand result{destination, -1};
+    if(destination == nullptr)
+    {
+        result.buffer = acquireBuffer(MatrixImpl<T>::checkedSize(m, n));
+        destination = buffers[result.buffer].data();
+        result.data = destination;
+    }
+    MatrixKernels::parallelGemm(m, n, k, T(1), lhs.data, k, rhs.data, n, T(0), destination, n);
+    releaseBuffer(lhs.buffer);
+    releaseBuffer(rhs.buffer);
+    return result;
+}
+
+///@brief Gets index of an idle scratch buffer holding at least size elements
+///@note Prefers the smallest idle buffer that is large enough, then grows the largest idle one
+template<typename T>
+int MatrixProduct<T>::acquireBuffer(MatrixIndex size) {
+    int smallestFitting = -1;
+    int largest = -1;
+    for(int index = 0; index < static_cast<int>(buffers.size()); index++)
+    {
+        if(bufferBusy[index])
+        {
+            continue;
+        }
+        MatrixIndex capacity = static_cast<MatrixIndex>(buffers[index].size());
+        if(capacity >= size &&
+           (smallestFitting < 0 || capacity < static_cast<MatrixIndex>(buffers[smallestFitting].size())))
+        {
+            smallestFitting = index;
+        }
+        if(largest < 0 || capacity > static_cast<MatrixIndex>(buffers[largest].size()))
+        {
+            largest = index;
+        }
+    }
+    int chosen = smallestFitting >= 0 ? smallestFitting : largest;
+    if(chosen < 0)
+    {
+        buffers.emplace_back();
+        bufferBusy.push_back(false);
+        chosen = static_cast<int>(buffers.size()) - 1;
+    }
+    if(static_cast<MatrixIndex>(buffers[chosen].size()) < size)
+    {
+        buffers[chosen].resize(size);
+    }
+    bufferBusy[chosen] = true;
+    return chosen;
+}
+
+template<typename T>
+void MatrixProduct<T>::releaseBuffer(int buffer) {
+    if(buffer >= 0)
+    {
+        bufferBusy[buffer] = false;
+    }
+}
+
+///@brief Builds lazy product of two matrices
+template<typename T>
+MatrixProduct<T> operator*(const Matrix<T>& lhs, const Matrix<T>& rhs) {
+    return MatrixProduct<T>(lhs, rhs);
+}
+
+///@brief Extends lazy product with matrix on the right
+template<typename T>
+MatrixProduct<T> operator*(MatrixProduct<T>&& lhs, const Matrix<T>& rhs) {
+    return std::move(lhs.append(rhs));
+}
+
+///@brief Extends lazy product with matrix on the left
+template<typename T>
+MatrixProduct<T> operator*(const Matrix<T>& lhs, MatrixProduct<T>&& rhs) {
+    return std::move(rhs.prepend(lhs));
+}
+
+///@brief Concatenates two lazy products
+template<typename T>
+MatrixProduct<T> operator*(MatrixProduct<T>&& lhs, MatrixProduct<T>&& rhs) {
+    return std::move(lhs.append(std::move(rhs)));
+}
+
+///@brief Evaluates lazy product into new matrix
+template<typename T>
+Matrix<T>::Matrix(MatrixProduct<T>&& product) :
+        Matrix(product.evaluate())
+{
+}
+
+///@brief Evaluates lazy product and replaces matrix data with result
+template<typename T>
+Matrix<T>& Matrix<T>::operator=(MatrixProduct<T>&& product) {
+    Matrix<T> result = product.evaluate();
+    swap(result);
+    return *this;
+}
+
+#endif //MATRIX_MATRIXPRODUCT_H
@@ -0,0 +1,219 @@
+#ifndef MATRIX_MATRIXTRACE_H
+#define MATRIX_MATRIXTRACE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+///@brief Records a trace event covering the rest of the enclosing scope
+///@note Expands to nothing unless MATRIX_ENABLE_TRACING is defined, so disabled tracing costs nothing.
+/// name must be a string literal, bytes is the amount of matrix data the operation reads or writes.
+#ifdef MATRIX_ENABLE_TRACING
+#define MATRIX_TRACE_CONCAT_INNER(lhs, rhs) lhs##rhs
+#define MATRIX_TRACE_CONCAT(lhs, rhs) MATRIX_TRACE_CONCAT_INNER(lhs, rhs)
+#define MATRIX_TRACE_SCOPE(name, rows, cols, bytes) \
+    MatrixTraceScope MATRIX_TRACE_CONCAT(matrixTraceScope, __LINE__)(name, rows, cols, bytes)
+#else
+#define MATRIX_TRACE_SCOPE(name, rows, cols, bytes) ((void)0)
+#endif
+
+///@brief Process-wide collector of matrix operation trace events
+///@note Every thread writes into its own ring buffer without locks, the oldest events are overwritten
+/// when a buffer is full. Buffers outlive their threads, so events of finished threads are still dumped.
+/// Events written while a dump is running may be skipped.
+class MatrixTrace {
+private:
+    static constexpr std::size_t bufferCapacity = 8192;
+
+    //Fields are relaxed atomics so that a concurrent dump never reads a torn value,
+    //sequence holds event index + 1 once the slot is completely written
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<std::int64_t> start{0};
+        std::atomic<std::int64_t> duration{0};
+        std::atomic<std::int64_t> rows{0};
+        std::atomic<std::int64_t> cols{0};
+        std::atomic<std::int64_t> bytes{0};
+    };
+
+    struct Buffer {
+        int threadId;
+        std::atomic<std::uint64_t> written{0};
+        std::array<Slot, bufferCapacity> slots;
+    };
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    std::chrono::steady_clock::time_point epoch;
+
+    MatrixTrace() : epoch(std::chrono::steady_clock::now()) {};
+    Buffer& localBuffer();
+    static void writeEscaped(std::ostream& stream, const char* text);
+
+public:
+    MatrixTrace(const MatrixTrace& other) = delete;
+    MatrixTrace& operator=(const MatrixTrace& other) = delete;
+
+    static MatrixTrace& instance();
+    std::int64_t now();
+    void record(const char* name, std::int64_t start, std::int64_t end, std::int64_t rows, std::int64_t cols,
+                std::int64_t bytes);
+    void writeChromeTrace(std::ostream& stream);
+    void writeChromeTrace(const std::string& path);
+    void clear();
+};
+
+///@brief Records one trace event from construction to destruction, see MATRIX_TRACE_SCOPE
+class MatrixTraceScope {
+private:
+    const char* name;
+    std::int64_t rows;
+    std::int64_t cols;
+    std::int64_t bytes;
+    std::int64_t start;
+
+public:
+    MatrixTraceScope(const char* _name, std::int64_t _rows, std::int64_t _cols, std::int64_t _bytes) :
+            name(_name), rows(_rows), cols(_cols), bytes(_bytes), start(MatrixTrace::instance().now()) {};
+    MatrixTraceScope(const MatrixTraceScope& other) = delete;
+    MatrixTraceScope& operator=(const MatrixTraceScope& other) = delete;
+    ~MatrixTraceScope() {
+        MatrixTrace& trace = MatrixTrace::instance();
+        trace.record(name, start, trace.now(), rows, cols, bytes);
+    };
+};
+
+inline MatrixTrace& MatrixTrace::instance() {
+    static MatrixTrace trace;
+    return trace;
+}
+
+///@brief Gets nanoseconds since the trace epoch
+inline std::int64_t MatrixTrace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+///@brief Gets ring buffer of calling thread, registering it on first use
+inline MatrixTrace::Buffer& MatrixTrace::localBuffer() {
+    thread_local std::shared_ptr<Buffer> buffer;
+    if(!buffer)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer = std::make_shared<Buffer>();
+        buffer->threadId = static_cast<int>(buffers.size());
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+///@brief Appends complete event to ring buffer of calling thread
+///@param name String literal naming the operation
+///@param start Begin time returned by now()
+///@param end End time returned by now()
+inline void MatrixTrace::record(const char* name, std::int64_t start, std::int64_t end, std::int64_t rows,
+                                std::int64_t cols, std::int64_t bytes) {
+    Buffer& buffer = localBuffer();
+    std::uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[index % bufferCapacity];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.rows.store(rows, std::memory_order_relaxed);
+    slot.cols.store(cols, std::memory_order_relaxed);
+    slot.bytes.store(bytes, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+///@brief Writes buffered events as Chrome trace_event JSON, loadable by Perfetto and chrome://tracing
+inline void MatrixTrace::writeChromeTrace(std::ostream &stream) {
+    std::vector<std::shared_ptr<Buffer>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = buffers;
+    }
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    for(std::shared_ptr<Buffer>& buffer : snapshot)
+    {
+        std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+        std::uint64_t oldest = written > bufferCapacity ? written - bufferCapacity : 0;
+        for(std::uint64_t index = oldest; index < written; index++)
+        {
+            Slot& slot = buffer->slots[index % bufferCapacity];
+            if(slot.sequence.load(std::memory_order_acquire) != index + 1)
+            {
+                continue;
+            }
+            const char* name = slot.name.load(std::memory_order_relaxed);
+            std::int64_t start = slot.start.load(std::memory_order_relaxed);
+            std::int64_t duration = slot.duration.load(std::memory_order_relaxed);
+            std::int64_t rows = slot.rows.load(std::memory_order_relaxed);
+            std::int64_t cols = slot.cols.load(std::memory_order_relaxed);
+            std::int64_t bytes = slot.bytes.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(slot.sequence.load(std::memory_order_relaxed) != index + 1)
+            {
+                continue; //Overwritten while reading
+            }
+            stream << (first ? "\n" : ",\n") << "{\"name\":\"";
+            writeEscaped(stream, name);
+            //Chrome trace timestamps are microseconds
+            stream << "\",\"cat\":\"matrix\",\"ph\":\"X\",\"ts\":" << start / 1000 << '.' << start % 1000 / 100
+                   << start % 100 / 10 << start % 10 << ",\"dur\":" << duration / 1000 << '.'
+                   << duration % 1000 / 100 << duration % 100 / 10 << duration % 10
+                   << ",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"rows\":" << rows
+                   << ",\"cols\":" << cols << ",\"bytes\":" << bytes << "}}";
+            first = false;
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+///@brief Writes buffered events as Chrome trace_event JSON file
+inline void MatrixTrace::writeChromeTrace(const std::string &path) {
+    std::ofstream file(path);
+    if(!file)
+    {
+        throw std::runtime_error("MatrixTrace::writeChromeTrace - cannot open " + path);
+    }
+    writeChromeTrace(file);
+}
+
+///@brief Drops buffered events of all threads
+///@note Must not run concurrently with traced operations
+inline void MatrixTrace::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for(std::shared_ptr<Buffer>& buffer : buffers)
+    {
+        buffer->written.store(0, std::memory_order_relaxed);
+        for(Slot& slot : buffer->slots)
+        {
+            slot.sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline void MatrixTrace::writeEscaped(std::ostream &stream, const char *text) {
+    for(; text != nullptr && *text != '\0'; text++)
+    {
+        if(*text == '"' || *text == '\\')
+        {
+            stream << '\\';
+        }
+        stream << *text;
+    }
+}
+
+#endif //MATRIX_MATRIXTRACE_H
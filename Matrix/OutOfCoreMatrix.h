@@ -0,0 +1,731 @@
+#ifndef MATRIX_OUTOFCOREMATRIX_H
+#define MATRIX_OUTOFCOREMATRIX_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "Matrix.h"
+#include "MatrixAlgebra.h"
+#include "MatrixTrace.h"
+
+///@brief Default amount of memory an out-of-core matrix keeps tiles in
+constexpr std::size_t outOfCoreCacheBytes = std::size_t(64) << 20;
+///@brief Default edge length of square out-of-core tiles
+constexpr int outOfCoreTileSize = 256;
+
+template<typename T>
+class OutOfCoreMatrix;
+
+template<typename T>
+void gemm(OutOfCoreMatrix<T>& a, OutOfCoreMatrix<T>& b, OutOfCoreMatrix<T>& c, std::type_identity_t<T> alpha = T(1),
+          std::type_identity_t<T> beta = T(0));
+
+///@brief Matrix stored as square tiles in a local file, with a bounded LRU cache of resident tiles
+///@note Tile (i, j) holds rows [i * tileSize, (i + 1) * tileSize) and the matching columns in row-major order and
+/// lives at a fixed file offset, edge tiles are padded to full size. The file is created sparse, so a new matrix
+/// reads as zeros and only written tiles take disk space. At most max(2, cacheBytes / tile bytes) tiles are resident,
+/// the least recently used one is evicted and written back first if it was modified.
+/// When consecutive tile switches move with a constant stride, as row, column or file order scans do, the tiles
+/// further along the stride are announced to the kernel with posix_fadvise so they are read in the background.
+/// Row and column iterators yield copies of whole rows and columns. Elements are reached through at() only while
+/// their tile stays resident, so references are invalidated by the access of another tile.
+/// gemm() and reduce() stream whole tiles and should be preferred to element loops.
+///@warning Not thread-safe, the file is kept after destruction and must not be used by other matrices meanwhile
+template<typename T>
+class OutOfCoreMatrix {
+private:
+    static_assert(std::is_trivially_copyable_v<T>, "OutOfCoreMatrix - elements are written to file as raw bytes");
+
+    static constexpr int prefetchDistance = 4;
+
+    struct Tile {
+        MatrixIndex index;
+        std::unique_ptr<T[]> data;
+        bool dirty;
+    };
+
+    MatrixIndex rowCount;
+    MatrixIndex colCount;
+    int tileSize;
+    MatrixIndex tileRowCount;
+    MatrixIndex tileColumnCount;
+    std::size_t maxResidentTiles;
+    std::string path;
+    int file;
+
+    std::list<Tile> tiles;
+    std::unordered_map<MatrixIndex, typename std::list<Tile>::iterator> residentTiles;
+    MatrixIndex previousTile;
+    MatrixIndex previousStride;
+
+    std::int64_t tileLoadCount;
+    std::int64_t tileStoreCount;
+    std::int64_t prefetchCount;
+
+    MatrixIndex tileElements();
+    std::size_t tileBytes();
+    off_t tileOffset(MatrixIndex tileIndex);
+    MatrixIndex tileIndexOf(MatrixIndex row, MatrixIndex column);
+    void checkIndex(MatrixIndex row, MatrixIndex column, const char* message);
+    void loadTile(MatrixIndex tileIndex, T* data);
+    void storeTile(MatrixIndex tileIndex, const T* data);
+    void prefetchAlong(MatrixIndex tileIndex);
+    T* tileData(MatrixIndex tileIndex, bool write, bool load = true);
+
+    template<typename U>
+    friend void gemm(OutOfCoreMatrix<U>& a, OutOfCoreMatrix<U>& b, OutOfCoreMatrix<U>& c,
+                     std::type_identity_t<U> alpha, std::type_identity_t<U> beta);
+    template<typename U, typename BinaryOperation>
+    friend U reduce(OutOfCoreMatrix<U>& matrix, U init, BinaryOperation operation);
+    template<typename U, typename BinaryOperation>
+    friend std::vector<U> reduceRows(OutOfCoreMatrix<U>& matrix, U init, BinaryOperation operation);
+
+public:
+    ///@brief Iterates over rows of the matrix, dereferencing reads a copy of the row
+    class ConstOutOfCoreRowIterator {
+    protected:
+        MatrixIndex index;
+        OutOfCoreMatrix<T>* matrix;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<T>;
+        using pointer           = void;
+        using reference         = std::vector<T>;
+
+        ConstOutOfCoreRowIterator(MatrixIndex _index, OutOfCoreMatrix<T>* _matrix) : index(_index), matrix(_matrix) {};
+
+        ConstOutOfCoreRowIterator& operator++() {index++; return *this;};
+        ConstOutOfCoreRowIterator operator++(int) {ConstOutOfCoreRowIterator temp = *this; index++; return temp;};
+        reference operator*() const {return matrix->getRow(index);};
+        MatrixIndex getIndex() {return index;};
+        friend bool operator==(const ConstOutOfCoreRowIterator& lhs, const ConstOutOfCoreRowIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!=(const ConstOutOfCoreRowIterator& lhs, const ConstOutOfCoreRowIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    ///@brief Iterates over columns of the matrix, dereferencing reads a copy of the column
+    class ConstOutOfCoreColumnIterator {
+    protected:
+        MatrixIndex index;
+        OutOfCoreMatrix<T>* matrix;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::vector<T>;
+        using pointer           = void;
+        using reference         = std::vector<T>;
+
+        ConstOutOfCoreColumnIterator(MatrixIndex _index, OutOfCoreMatrix<T>* _matrix) : index(_index), matrix(_matrix) {};
+
+        ConstOutOfCoreColumnIterator& operator++() {index++; return *this;};
+        ConstOutOfCoreColumnIterator operator++(int) {ConstOutOfCoreColumnIterator temp = *this; index++; return temp;};
+        reference operator*() const {return matrix->getColumn(index);};
+        MatrixIndex getIndex() {return index;};
+        friend bool operator==(const ConstOutOfCoreColumnIterator& lhs, const ConstOutOfCoreColumnIterator& rhs) {return lhs.index == rhs.index;};
+        friend bool operator!=(const ConstOutOfCoreColumnIterator& lhs, const ConstOutOfCoreColumnIterator& rhs) {return lhs.index != rhs.index;};
+    };
+
+    typedef ConstOutOfCoreRowIterator const_rowIterator;
+    typedef ConstOutOfCoreColumnIterator const_columnIterator;
+
+    OutOfCoreMatrix(MatrixIndex row, MatrixIndex col, const std::string& _path,
+                    std::size_t cacheBytes = outOfCoreCacheBytes, int _tileSize = outOfCoreTileSize);
+    OutOfCoreMatrix(Matrix<T>& source, const std::string& _path,
+                    std::size_t cacheBytes = outOfCoreCacheBytes, int _tileSize = outOfCoreTileSize);
+    OutOfCoreMatrix(const OutOfCoreMatrix&) = delete;
+    OutOfCoreMatrix& operator=(const OutOfCoreMatrix&) = delete;
+    ~OutOfCoreMatrix();
+
+    MatrixIndex getColumnCount();
+    MatrixIndex getRowCount();
+    MatrixIndex getSize();
+    int getTileSize();
+    std::size_t getResidentTileCount();
+    std::int64_t getTileLoadCount();
+    std::int64_t getTileStoreCount();
+    std::int64_t getPrefetchCount();
+
+    T& at(MatrixIndex row, MatrixIndex column);
+    T get(MatrixIndex row, MatrixIndex column);
+    std::vector<T> getRow(MatrixIndex row);
+    std::vector<T> getColumn(MatrixIndex column);
+    void setRow(MatrixIndex row, const std::vector<T>& values);
+    void setColumn(MatrixIndex column, const std::vector<T>& values);
+    void flush();
+    Matrix<T> toMatrix();
+
+    const_rowIterator beginConstRow();
+    const_rowIterator endConstRow();
+    const_columnIterator beginConstColumn();
+    const_columnIterator endConstColumn();
+};
+
+///@brief Creates matrix of zeros backed by a new file
+///@param _path File holding the tiles, truncated if it exists
+///@param cacheBytes Memory for resident tiles, at least two tiles are kept
+///@param _tileSize Edge length of square tiles
+template<typename T>
+OutOfCoreMatrix<T>::OutOfCoreMatrix(MatrixIndex row, MatrixIndex col, const std::string& _path, std::size_t cacheBytes,
+                                    int _tileSize) :
+        rowCount(row),
+        colCount(col),
+        tileSize(_tileSize),
+        tileRowCount(0),
+        tileColumnCount(0),
+        maxResidentTiles(2),
+        path(_path),
+        file(-1),
+        previousTile(-1),
+        previousStride(0),
+        tileLoadCount(0),
+        tileStoreCount(0),
+        prefetchCount(0)
+{
+    if(row < 0 || col < 0 || _tileSize <= 0)
+    {
+        throw std::invalid_argument("OutOfCoreMatrix - negative dimension or tile size");
+    }
+    tileRowCount = (row + tileSize - 1) / tileSize;
+    tileColumnCount = (col + tileSize - 1) / tileSize;
+    MatrixImpl<T>::checkedSize(tileRowCount * tileSize, tileColumnCount * tileSize);
+    maxResidentTiles = std::max<std::size_t>(2, cacheBytes / tileBytes());
+
+    file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if(file < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "OutOfCoreMatrix - cannot open " + path);
+    }
+    if(::ftruncate(file, tileOffset(tileRowCount * tileColumnCount)) != 0)
+    {
+        int error = errno;
+        ::close(file);
+        throw std::system_error(error, std::generic_category(), "OutOfCoreMatrix - cannot size " + path);
+    }
+}
+
+///@brief Creates file-backed copy of matrix, tiles are written directly without passing through the cache
+template<typename T>
+OutOfCoreMatrix<T>::OutOfCoreMatrix(Matrix<T>& source, const std::string& _path, std::size_t cacheBytes,
+                                    int _tileSize) :
+        OutOfCoreMatrix(source.getRowCount(), source.getColumnCount(), _path, cacheBytes, _tileSize)
+{
+    const T* sourceData = source.cbegin();
+    std::vector<T> buffer(tileElements(), T());
+    for(MatrixIndex tileRow = 0; tileRow < tileRowCount; tileRow++)
+    {
+        MatrixIndex firstRow = tileRow * tileSize;
+        MatrixIndex rows = std::min<MatrixIndex>(tileSize, rowCount - firstRow);
+        for(MatrixIndex tileColumn = 0; tileColumn < tileColumnCount; tileColumn++)
+        {
+            MatrixIndex firstColumn = tileColumn * tileSize;
+            MatrixIndex columns = std::min<MatrixIndex>(tileSize, colCount - firstColumn);
+            for(MatrixIndex row = 0; row < rows; row++)
+            {
+                const T* sourceRow = sourceData + (firstRow + row) * colCount + firstColumn;
+                std::copy(sourceRow, sourceRow + columns, buffer.data() + row * tileSize);
+            }
+            storeTile(tileRow * tileColumnCount + tileColumn, buffer.data());
+        }
+    }
+}
+
+///@brief Writes back modified tiles and closes the file
+template<typename T>
+OutOfCoreMatrix<T>::~OutOfCoreMatrix() {
+    try
+    {
+        flush();
+    }
+    catch(const std::exception&)
+    {
+        //Destructor must not throw, call flush() first to see write errors
+    }
+    ::close(file);
+}
+
+template<typename T>
+MatrixIndex OutOfCoreMatrix<T>::tileElements() {
+    return static_cast<MatrixIndex>(tileSize) * tileSize;
+}
+
+template<typename T>
+std::size_t OutOfCoreMatrix<T>::tileBytes() {
+    return static_cast<std::size_t>(tileElements()) * sizeof(T);
+}
+
+template<typename T>
+off_t OutOfCoreMatrix<T>::tileOffset(MatrixIndex tileIndex) {
+    return static_cast<off_t>(tileIndex) * static_cast<off_t>(tileBytes());
+}
+
+template<typename T>
+MatrixIndex OutOfCoreMatrix<T>::tileIndexOf(MatrixIndex row, MatrixIndex column) {
+    return (row / tileSize) * tileColumnCount + column / tileSize;
+}
+
+template<typename T>
+void OutOfCoreMatrix<T>::checkIndex(MatrixIndex row, MatrixIndex column, const char* message) {
+    if(row < 0 || column < 0 || row >= rowCount || column >= colCount)
+    {
+        throw std::out_of_range(message);
+    }
+}
+
+///@brief Reads tile from file, retrying partial reads
+template<typename T>
+void OutOfCoreMatrix<T>::loadTile(MatrixIndex tileIndex, T* data) {
+    char* bytes = reinterpret_cast<char*>(data);
+    std::size_t remaining = tileBytes();
+    off_t offset = tileOffset(tileIndex);
+    while(remaining > 0)
+    {
+        ssize_t count = ::pread(file, bytes, remaining, offset);
+        if(count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(count <= 0)
+        {
+            throw std::system_error(count < 0 ? errno : EIO, std::generic_category(), "OutOfCoreMatrix - tile read failed");
+        }
+        bytes += count;
+        offset += count;
+        remaining -= static_cast<std::size_t>(count);
+    }
+    tileLoadCount++;
+}
+
+///@brief Writes tile to file, retrying partial writes
+template<typename T>
+void OutOfCoreMatrix<T>::storeTile(MatrixIndex tileIndex, const T* data) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    std::size_t remaining = tileBytes();
+    off_t offset = tileOffset(tileIndex);
+    while(remaining > 0)
+    {
+        ssize_t count = ::pwrite(file, bytes, remaining, offset);
+        if(count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(count <= 0)
+        {
+            throw std::system_error(count < 0 ? errno : EIO, std::generic_category(), "OutOfCoreMatrix - tile write failed");
+        }
+        bytes += count;
+        offset += count;
+        remaining -= static_cast<std::size_t>(count);
+    }
+    tileStoreCount++;
+}
+
+///@brief Announces the next tiles of a constant stride scan to the kernel
+///@note Called on every switch to another tile, two equal strides in a row count as a scan
+template<typename T>
+void OutOfCoreMatrix<T>::prefetchAlong(MatrixIndex tileIndex) {
+    MatrixIndex stride = previousTile < 0 ? 0 : tileIndex - previousTile;
+    if(stride != 0 && stride == previousStride)
+    {
+        MatrixIndex tileCount = tileRowCount * tileColumnCount;
+        for(int step = 1; step <= prefetchDistance; step++)
+        {
+            MatrixIndex next = tileIndex + step * stride;
+            if(next < 0 || next >= tileCount)
+            {
+                break;
+            }
+            if(residentTiles.find(next) == residentTiles.end())
+            {
+#ifdef POSIX_FADV_WILLNEED
+                ::posix_fadvise(file, tileOffset(next), static_cast<off_t>(tileBytes()), POSIX_FADV_WILLNEED);
+#endif
+                prefetchCount++;
+            }
+        }
+    }
+    previousTile = tileIndex;
+    previousStride = stride;
+}
+
+///@brief Gets resident data of tile, loading it and evicting the least recently used tile when needed
+///@param write Marks the tile to be written back
+///@param load Reads the tile from file, otherwise a newly resident tile has unspecified contents
+template<typename T>
+T* OutOfCoreMatrix<T>::tileData(MatrixIndex tileIndex, bool write, bool load) {
+    if(!tiles.empty() && tiles.front().index == tileIndex)
+    {
+        tiles.front().dirty = tiles.front().dirty || write;
+        return tiles.front().data.get();
+    }
+    prefetchAlong(tileIndex);
+    auto resident = residentTiles.find(tileIndex);
+    if(resident != residentTiles.end())
+    {
+        tiles.splice(tiles.begin(), tiles, resident->second);
+    }
+    else
+    {
+        if(tiles.size() < maxResidentTiles)
+        {
+            tiles.push_front(Tile{tileIndex, std::make_unique<T[]>(tileElements()), false});
+        }
+        else
+        {
+            //Buffer of the evicted tile is reused for the new one
+            Tile& victim = tiles.back();
+            if(victim.dirty)
+            {
+                storeTile(victim.index, victim.data.get());
+            }
+            residentTiles.erase(victim.index);
+            victim.index = tileIndex;
+            victim.dirty = false;
+            tiles.splice(tiles.begin(), tiles, std::prev(tiles.end()));
+        }
+        residentTiles[tileIndex] = tiles.begin();
+        if(load)
+        {
+            try
+            {
+                loadTile(tileIndex, tiles.front().data.get());
+            }
+            catch(...)
+            {
+                residentTiles.erase(tileIndex);
+                tiles.pop_front();
+                throw;
+            }
+        }
+    }
+    tiles.front().dirty = tiles.front().dirty || write;
+    return tiles.front().data.get();
+}
+
+template<typename T>
+MatrixIndex OutOfCoreMatrix<T>::getColumnCount() {
+    return colCount;
+}
+
+template<typename T>
+MatrixIndex OutOfCoreMatrix<T>::getRowCount() {
+    return rowCount;
+}
+
+template<typename T>
+MatrixIndex OutOfCoreMatrix<T>::getSize() {
+    return rowCount * colCount;
+}
+
+template<typename T>
+int OutOfCoreMatrix<T>::getTileSize() {
+    return tileSize;
+}
+
+///@brief Gets amount of tiles currently held in memory
+template<typename T>
+std::size_t OutOfCoreMatrix<T>::getResidentTileCount() {
+    return tiles.size();
+}
+
+///@brief Gets amount of tiles read from file so far
+template<typename T>
+std::int64_t OutOfCoreMatrix<T>::getTileLoadCount() {
+    return tileLoadCount;
+}
+
+///@brief Gets amount of tiles written to file so far
+template<typename T>
+std::int64_t OutOfCoreMatrix<T>::getTileStoreCount() {
+    return tileStoreCount;
+}
+
+///@brief Gets amount of tiles announced ahead of scans so far
+template<typename T>
+std::int64_t OutOfCoreMatrix<T>::getPrefetchCount() {
+    return prefetchCount;
+}
+
+///@brief Returns reference to element at specified row and column, its tile is written back later
+///@note Reference is valid until an element of another tile is accessed
+template<typename T>
+T& OutOfCoreMatrix<T>::at(MatrixIndex row, MatrixIndex column) {
+    checkIndex(row, column, "OutOfCoreMatrix::at - index out of range");
+    T* data = tileData(tileIndexOf(row, column), true);
+    return data[(row % tileSize) * tileSize + column % tileSize];
+}
+
+///@brief Reads element at specified row and column without marking its tile modified
+template<typename T>
+T OutOfCoreMatrix<T>::get(MatrixIndex row, MatrixIndex column) {
+    checkIndex(row, column, "OutOfCoreMatrix::get - index out of range");
+    T* data = tileData(tileIndexOf(row, column), false);
+    return data[(row % tileSize) * tileSize + column % tileSize];
+}
+
+///@brief Reads copy of row, one tile slice at a time
+template<typename T>
+std::vector<T> OutOfCoreMatrix<T>::getRow(MatrixIndex row) {
+    checkIndex(row, 0, "OutOfCoreMatrix::getRow - index out of range");
+    std::vector<T> values(colCount);
+    MatrixIndex tileRow = row / tileSize;
+    MatrixIndex rowOffset = (row % tileSize) * tileSize;
+    for(MatrixIndex tileColumn = 0; tileColumn < tileColumnCount; tileColumn++)
+    {
+        const T* data = tileData(tileRow * tileColumnCount + tileColumn, false) + rowOffset;
+        MatrixIndex firstColumn = tileColumn * tileSize;
+        std::copy(data, data + std::min<MatrixIndex>(tileSize, colCount - firstColumn), values.begin() + firstColumn);
+    }
+    return values;
+}
+
+///@brief Reads copy of column, one tile slice at a time
+template<typename T>
+std::vector<T> OutOfCoreMatrix<T>::getColumn(MatrixIndex column) {
+    checkIndex(0, column, "OutOfCoreMatrix::getColumn - index out of range");
+    std::vector<T> values(rowCount);
+    MatrixIndex tileColumn = column / tileSize;
+    MatrixIndex columnOffset = column % tileSize;
+    for(MatrixIndex tileRow = 0; tileRow < tileRowCount; tileRow++)
+    {
+        const T* data = tileData(tileRow * tileColumnCount + tileColumn, false) + columnOffset;
+        MatrixIndex firstRow = tileRow * tileSize;
+        MatrixIndex rows = std::min<MatrixIndex>(tileSize, rowCount - firstRow);
+        for(MatrixIndex row = 0; row < rows; row++)
+        {
+            values[firstRow + row] = data[row * tileSize];
+        }
+    }
+    return values;
+}
+
+///@brief Overwrites row with values, which must hold one element per column
+template<typename T>
+void OutOfCoreMatrix<T>::setRow(MatrixIndex row, const std::vector<T>& values) {
+    checkIndex(row, 0, "OutOfCoreMatrix::setRow - index out of range");
+    if(static_cast<MatrixIndex>(values.size()) != colCount)
+    {
+        throw std::invalid_argument("OutOfCoreMatrix::setRow - row size does not match");
+    }
+    MatrixIndex tileRow = row / tileSize;
+    MatrixIndex rowOffset = (row % tileSize) * tileSize;
+    for(MatrixIndex tileColumn = 0; tileColumn < tileColumnCount; tileColumn++)
+    {
+        T* data = tileData(tileRow * tileColumnCount + tileColumn, true) + rowOffset;
+        MatrixIndex firstColumn = tileColumn * tileSize;
+        MatrixIndex columns = std::min<MatrixIndex>(tileSize, colCount - firstColumn);
+        std::copy(values.begin() + firstColumn, values.begin() + firstColumn + columns, data);
+    }
+}
+
+///@brief Overwrites column with values, which must hold one element per row
+template<typename T>
+void OutOfCoreMatrix<T>::setColumn(MatrixIndex column, const std::vector<T>& values) {
+    checkIndex(0, column, "OutOfCoreMatrix::setColumn - index out of range");
+    if(static_cast<MatrixIndex>(values.size()) != rowCount)
+    {
+        throw std::invalid_argument("OutOfCoreMatrix::setColumn - column size does not match");
+    }
+    MatrixIndex tileColumn = column / tileSize;
+    MatrixIndex columnOffset = column % tileSize;
+    for(MatrixIndex tileRow = 0; tileRow < tileRowCount; tileRow++)
+    {
+        T* data = tileData(tileRow * tileColumnCount + tileColumn, true) + columnOffset;
+        MatrixIndex firstRow = tileRow * tileSize;
+        MatrixIndex rows = std::min<MatrixIndex>(tileSize, rowCount - firstRow);
+        for(MatrixIndex row = 0; row < rows; row++)
+        {
+            data[row * tileSize] = values[firstRow + row];
+        }
+    }
+}
+
+///@brief Writes modified resident tiles back to file, they stay resident
+template<typename T>
+void OutOfCoreMatrix<T>::flush() {
+    MATRIX_TRACE_SCOPE("OutOfCoreMatrix::flush", rowCount, colCount,
+                       static_cast<std::int64_t>(tiles.size() * tileBytes()));
+    for(Tile& tile : tiles)
+    {
+        if(tile.dirty)
+        {
+            storeTile(tile.index, tile.data.get());
+            tile.dirty = false;
+        }
+    }
+}
+
+///@brief Reads whole matrix into memory
+template<typename T>
+Matrix<T> OutOfCoreMatrix<T>::toMatrix() {
+    Matrix<T> result(rowCount, colCount);
+    T* resultData = result.begin();
+    for(MatrixIndex tileRow = 0; tileRow < tileRowCount; tileRow++)
+    {
+        MatrixIndex firstRow = tileRow * tileSize;
+        MatrixIndex rows = std::min<MatrixIndex>(tileSize, rowCount - firstRow);
+        for(MatrixIndex tileColumn = 0; tileColumn < tileColumnCount; tileColumn++)
+        {
+            const T* data = tileData(tileRow * tileColumnCount + tileColumn, false);
+            MatrixIndex firstColumn = tileColumn * tileSize;
+            MatrixIndex columns = std::min<MatrixIndex>(tileSize, colCount - firstColumn);
+            for(MatrixIndex row = 0; row < rows; row++)
+            {
+                std::copy(data + row * tileSize, data + row * tileSize + columns,
+                          resultData + (firstRow + row) * colCount + firstColumn);
+            }
+        }
+    }
+    return result;
+}
+
+template<typename T>
+typename OutOfCoreMatrix<T>::const_rowIterator OutOfCoreMatrix<T>::beginConstRow() {
+    return const_rowIterator(0, this);
+}
+
+template<typename T>
+typename OutOfCoreMatrix<T>::const_rowIterator OutOfCoreMatrix<T>::endConstRow() {
+    return const_rowIterator(rowCount, this);
+}
+
+template<typename T>
+typename OutOfCoreMatrix<T>::const_columnIterator OutOfCoreMatrix<T>::beginConstColumn() {
+    return const_columnIterator(0, this);
+}
+
+template<typename T>
+typename OutOfCoreMatrix<T>::const_columnIterator OutOfCoreMatrix<T>::endConstColumn() {
+    return const_columnIterator(colCount, this);
+}
+
+///@brief Computes C = alpha * A * B + beta * C one tile of C at a time
+///@note For every tile of C the matching tile row of A and tile column of B are streamed through the caches and
+/// multiplied with the in-memory kernel, so every element is read from file in whole tiles.
+/// A tile row of A is reused for a whole tile row of C when the cache of A holds it.
+/// With beta zero tiles of C are not read from file.
+///@param a Left operand
+///@param b Right operand with as many rows as A has columns, may be A
+///@param c Result with as many rows as A and as many columns as B, must be another matrix than operands
+template<typename T>
+void gemm(OutOfCoreMatrix<T>& a, OutOfCoreMatrix<T>& b, OutOfCoreMatrix<T>& c, std::type_identity_t<T> alpha,
+          std::type_identity_t<T> beta) {
+    MATRIX_TRACE_SCOPE("gemm", c.getRowCount(), c.getColumnCount(),
+                       (a.getSize() + b.getSize() + c.getSize()) * static_cast<std::int64_t>(sizeof(T)));
+    if(a.colCount != b.rowCount || c.rowCount != a.rowCount || c.colCount != b.colCount)
+    {
+        throw std::invalid_argument("gemm - matrix dimensions do not match");
+    }
+    if(a.tileSize != b.tileSize || a.tileSize != c.tileSize)
+    {
+        throw std::invalid_argument("gemm - tile sizes do not match");
+    }
+    if(&c == &a || &c == &b)
+    {
+        throw std::invalid_argument("gemm - result must be another matrix than operands");
+    }
+    int tileSize = c.tileSize;
+    for(MatrixIndex tileRow = 0; tileRow < c.tileRowCount; tileRow++)
+    {
+        int rows = static_cast<int>(std::min<MatrixIndex>(tileSize, c.rowCount - tileRow * tileSize));
+        for(MatrixIndex tileColumn = 0; tileColumn < c.tileColumnCount; tileColumn++)
+        {
+            int columns = static_cast<int>(std::min<MatrixIndex>(tileSize, c.colCount - tileColumn * tileSize));
+            T* cTile = c.tileData(tileRow * c.tileColumnCount + tileColumn, true, beta != T(0));
+            if(beta == T(0))
+            {
+                std::fill(cTile, cTile + c.tileElements(), T(0));
+            }
+            else
+            {
+                for(int row = 0; row < rows; row++)
+                {
+                    MatrixKernels::scale(beta, cTile + row * tileSize, columns);
+                }
+            }
+            for(MatrixIndex tileDepth = 0; tileDepth < a.tileColumnCount; tileDepth++)
+            {
+                int depth = static_cast<int>(std::min<MatrixIndex>(tileSize, a.colCount - tileDepth * tileSize));
+                //A is fetched first, so when B is A the second fetch evicts another tile
+                const T* aTile = a.tileData(tileRow * a.tileColumnCount + tileDepth, false);
+                const T* bTile = b.tileData(tileDepth * b.tileColumnCount + tileColumn, false);
+                MatrixKernels::parallelGemm(rows, columns, depth, T(alpha), aTile, tileSize, bTile, tileSize, T(1),
+                                            cTile, tileSize);
+            }
+        }
+    }
+}
+
+///@brief Folds every element into init with operation, streaming tiles in file order
+///@param operation Callable taking accumulated value and element, called in row-major order within each tile
+template<typename T, typename BinaryOperation>
+T reduce(OutOfCoreMatrix<T>& matrix, T init, BinaryOperation operation) {
+    MATRIX_TRACE_SCOPE("reduce", matrix.getRowCount(), matrix.getColumnCount(),
+                       matrix.getSize() * static_cast<std::int64_t>(sizeof(T)));
+    int tileSize = matrix.tileSize;
+    for(MatrixIndex tileRow = 0; tileRow < matrix.tileRowCount; tileRow++)
+    {
+        MatrixIndex rows = std::min<MatrixIndex>(tileSize, matrix.rowCount - tileRow * tileSize);
+        for(MatrixIndex tileColumn = 0; tileColumn < matrix.tileColumnCount; tileColumn++)
+        {
+            MatrixIndex columns = std::min<MatrixIndex>(tileSize, matrix.colCount - tileColumn * tileSize);
+            const T* data = matrix.tileData(tileRow * matrix.tileColumnCount + tileColumn, false);
+            for(MatrixIndex row = 0; row < rows; row++)
+            {
+                for(MatrixIndex column = 0; column < columns; column++)
+                {
+                    init = operation(init, data[row * tileSize + column]);
+                }
+            }
+        }
+    }
+    return init;
+}
+
+///@brief Folds every row into its own value starting from init, streaming tiles in file order
+///@retval Value of every row, elements of a row are folded from left to right
+template<typename T, typename BinaryOperation>
+std::vector<T> reduceRows(OutOfCoreMatrix<T>& matrix, T init, BinaryOperation operation) {
+    MATRIX_TRACE_SCOPE("reduceRows", matrix.getRowCount(), matrix.getColumnCount(),
+                       matrix.getSize() * static_cast<std::int64_t>(sizeof(T)));
+    std::vector<T> values(matrix.rowCount, init);
+    int tileSize = matrix.tileSize;
+    for(MatrixIndex tileRow = 0; tileRow < matrix.tileRowCount; tileRow++)
+    {
+        MatrixIndex firstRow = tileRow * tileSize;
+        MatrixIndex rows = std::min<MatrixIndex>(tileSize, matrix.rowCount - firstRow);
+        for(MatrixIndex tileColumn = 0; tileColumn < matrix.tileColumnCount; tileColumn++)
+        {
+            MatrixIndex columns = std::min<MatrixIndex>(tileSize, matrix.colCount - tileColumn * tileSize);
+            const T* data = matrix.tileData(tileRow * matrix.tileColumnCount + tileColumn, false);
+            for(MatrixIndex row = 0; row < rows; row++)
+            {
+                T& value = values[firstRow + row];
+                for(MatrixIndex column = 0; column < columns; column++)
+                {
+                    value = operation(value, data[row * tileSize + column]);
+                }
+            }
+        }
+    }
+    return values;
+}
+
+#endif //MATRIX_OUTOFCOREMATRIX_H
@@ -0,0 +1,696 @@
+#ifndef MATRIX_PACKEDMATRIX_H
+#define MATRIX_PACKEDMATRIX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixAlgebra.h"
+#include "ThreadPool.h"
+
+///@brief Selects stored half of a triangular matrix
+enum class Triangle {
+    Lower, ///< Elements on and below the diagonal
+    Upper  ///< Elements on and above the diagonal
+};
+
+///@brief Columns of B and C processed by one task of structured matrix products and multi-vector solves
+constexpr int packedPanelColumns = 256;
+
+namespace MatrixKernels {
+
+///@brief Gets offset of the first stored element of row in row-major packed triangle of size x size matrix
+inline std::size_t packedRowOffset(int row, int size, Triangle triangle) {
+    std::size_t index = static_cast<std::size_t>(row);
+    if(triangle == Triangle::Lower)
+    {
+        return index * (index + 1) / 2;
+    }
+    return index * static_cast<std::size_t>(size) - index * (index - 1) / 2;
+}
+
+///@brief Gets size of square dense matrix converted to a packed matrix, which indexes rows and columns with int
+///@param message Message of std::length_error thrown when row count exceeds int range
+template<typename T>
+int packedSize(Matrix<T>& dense, const char* message) {
+    if(dense.getRowCount() > std::numeric_limits<int>::max())
+    {
+        throw std::length_error(message);
+    }
+    return static_cast<int>(dense.getRowCount());
+}
+
+}
+
+///@brief Square triangular matrix storing only one triangle, packed row by row
+///@note Row r of a lower matrix stores columns [0, r], row r of an upper matrix stores columns [r, size),
+/// so stored part of every row is contiguous and about half of the dense memory is used
+template<typename T>
+class TriangularMatrix {
+private:
+    int size;
+    Triangle triangle;
+    std::vector<T> data;
+
+public:
+    TriangularMatrix(int _size, Triangle _triangle);
+    TriangularMatrix(Matrix<T>& dense, Triangle _triangle);
+
+    int getRowCount();
+    int getColumnCount();
+    Triangle getTriangle();
+    int firstColumn(int row);
+    int lastColumn(int row);
+    T* rowData(int row);
+    T& at(int row, int column);
+    T get(int row, int column);
+    Matrix<T> toMatrix();
+};
+
+///@brief Square symmetric matrix storing its lower triangle packed row by row
+///@note Element (r, c) and (c, r) are the same stored element
+template<typename T>
+class SymmetricMatrix {
+private:
+    int size;
+    std::vector<T> data;
+
+public:
+    explicit SymmetricMatrix(int _size);
+    explicit SymmetricMatrix(Matrix<T>& dense);
+
+    int getRowCount();
+    int getColumnCount();
+    T* rowData(int row);
+    T& at(int row, int column);
+    Matrix<T> toMatrix();
+};
+
+///@brief Square band matrix storing lowerBandwidth diagonals below and upperBandwidth diagonals above the main one
+///@note Every row stores a window of lowerBandwidth + upperBandwidth + 1 elements centered on its diagonal element,
+/// so stored part of a row is contiguous. Window elements outside the matrix stay zero.
+template<typename T>
+class BandedMatrix {
+private:
+    int size;
+    int lowerBandwidth;
+    int upperBandwidth;
+    int width;
+    std::vector<T> data;
+
+public:
+    BandedMatrix(int _size, int _lowerBandwidth, int _upperBandwidth);
+    BandedMatrix(Matrix<T>& dense, int _lowerBandwidth, int _upperBandwidth);
+
+    int getRowCount();
+    int getColumnCount();
+    int getLowerBandwidth();
+    int getUpperBandwidth();
+    int firstColumn(int row);
+    int lastColumn(int row);
+    T* rowData(int row);
+    T& at(int row, int column);
+    T get(int row, int column);
+    Matrix<T> toMatrix();
+};
+
+///@brief Creates zero size x size triangular matrix
+template<typename T>
+TriangularMatrix<T>::TriangularMatrix(int _size, Triangle _triangle) :
+        size(_size),
+        triangle(_triangle)
+{
+    if(_size < 0)
+    {
+        throw std::invalid_argument("TriangularMatrix - negative size");
+    }
+    data.resize(static_cast<std::size_t>(size) * (size + 1) / 2);
+}
+
+///@brief Creates triangular matrix from triangle of square dense matrix, other elements are ignored
+template<typename T>
+TriangularMatrix<T>::TriangularMatrix(Matrix<T>& dense, Triangle _triangle) :
+        TriangularMatrix(MatrixKernels::packedSize(dense, "TriangularMatrix - dense size exceeds int range"), _triangle)
+{
+    if(dense.getColumnCount() != size)
+    {
+        throw std::invalid_argument("TriangularMatrix - dense matrix is not square");
+    }
+    const T* source = dense.cbegin();
+    for(int row = 0; row < size; row++)
+    {
+        const T* sourceRow = source + static_cast<MatrixIndex>(row) * size;
+        std::copy(sourceRow + firstColumn(row), sourceRow + lastColumn(row), rowData(row));
+    }
+}
+
+template<typename T>
+int TriangularMatrix<T>::getRowCount() {
+    return size;
+}
+
+template<typename T>
+int TriangularMatrix<T>::getColumnCount() {
+    return size;
+}
+
+template<typename T>
+Triangle TriangularMatrix<T>::getTriangle() {
+    return triangle;
+}
+
+///@brief Gets first stored column of row
+template<typename T>
+int TriangularMatrix<T>::firstColumn(int row) {
+    return triangle == Triangle::Lower ? 0 : row;
+}
+
+///@brief Gets column after the last stored column of row
+template<typename T>
+int TriangularMatrix<T>::lastColumn(int row) {
+    return triangle == Triangle::Lower ? row + 1 : size;
+}
+
+///@brief Gets pointer to stored part of row, element (row, firstColumn(row)) comes first
+template<typename T>
+T* TriangularMatrix<T>::rowData(int row) {
+    return data.data() + MatrixKernels::packedRowOffset(row, size, triangle);
+}
+
+///@brief Gets a reference to stored element at specified row and column
+///@note Elements outside the stored triangle are always zero and cannot be referenced
+template<typename T>
+T& TriangularMatrix<T>::at(int row, int column) {
+    if(row < 0 || row >= size || column < firstColumn(row) || column >= lastColumn(row))
+    {
+        throw std::out_of_range("TriangularMatrix::at - index out of range or outside stored triangle");
+    }
+    return rowData(row)[column - firstColumn(row)];
+}
+
+///@brief Gets value of element at specified row and column, zero outside the stored triangle
+template<typename T>
+T TriangularMatrix<T>::get(int row, int column) {
+    if(row < 0 || row >= size || column < 0 || column >= size)
+    {
+        throw std::out_of_range("TriangularMatrix::get - index out of range");
+    }
+    return column < firstColumn(row) || column >= lastColumn(row) ? T() : rowData(row)[column - firstColumn(row)];
+}
+
+///@brief Copies matrix into dense storage
+template<typename T>
+Matrix<T> TriangularMatrix<T>::toMatrix() {
+    Matrix<T> dense(size, size);
+    dense.fill(T());
+    T* destination = dense.begin();
+    for(int row = 0; row < size; row++)
+    {
+        std::copy(rowData(row), rowData(row) + lastColumn(row) - firstColumn(row),
+                  destination + static_cast<MatrixIndex>(row) * size + firstColumn(row));
+    }
+    return dense;
+}
+
+///@brief Creates zero size x size symmetric matrix
+template<typename T>
+SymmetricMatrix<T>::SymmetricMatrix(int _size) :
+        size(_size)
+{
+    if(_size < 0)
+    {
+        throw std::invalid_argument("SymmetricMatrix - negative size");
+    }
+    data.resize(static_cast<std::size_t>(size) * (size + 1) / 2);
+}
+
+///@brief Creates symmetric matrix from lower triangle of square dense matrix, upper triangle is ignored
+template<typename T>
+SymmetricMatrix<T>::SymmetricMatrix(Matrix<T>& dense) :
+        SymmetricMatrix(MatrixKernels::packedSize(dense, "SymmetricMatrix - dense size exceeds int range"))
+{
+    if(dense.getColumnCount() != size)
+    {
+        throw std::invalid_argument("SymmetricMatrix - dense matrix is not square");
+    }
+    const T* source = dense.cbegin();
+    for(int row = 0; row < size; row++)
+    {
+        const T* sourceRow = source + static_cast<MatrixIndex>(row) * size;
+        std::copy(sourceRow, sourceRow + row + 1, rowData(row));
+    }
+}
+
+template<typename T>
+int SymmetricMatrix<T>::getRowCount() {
+    return size;
+}
+
+template<typename T>
+int SymmetricMatrix<T>::getColumnCount() {
+    return size;
+}
+
+///@brief Gets pointer to elements (row, 0) to (row, row)
+template<typename T>
+T* SymmetricMatrix<T>::rowData(int row) {
+    return data.data() + MatrixKernels::packedRowOffset(row, size, Triangle::Lower);
+}
+
+///@brief Gets a reference to element at specified row and column, shared with element at column and row
+template<typename T>
+T& SymmetricMatrix<T>::at(int row, int column) {
+    if(row < 0 || row >= size || column < 0 || column >= size)
+    {
+        throw std::out_of_range("SymmetricMatrix::at - index out of range");
+    }
+    return row >= column ? rowData(row)[column] : rowData(column)[row];
+}
+
+///@brief Copies matrix into dense storage, filling both triangles
+template<typename T>
+Matrix<T> SymmetricMatrix<T>::toMatrix() {
+    Matrix<T> dense(size, size);
+    T* destination = dense.begin();
+    for(int row = 0; row < size; row++)
+    {
+        const T* source = rowData(row);
+        for(int column = 0; column <= row; column++)
+        {
+            destination[static_cast<MatrixIndex>(row) * size + column] = source[column];
+            destination[static_cast<MatrixIndex>(column) * size + row] = source[column];
+        }
+    }
+    return dense;
+}
+
+///@brief Creates zero size x size band matrix
+template<typename T>
+BandedMatrix<T>::BandedMatrix(int _size, int _lowerBandwidth, int _upperBandwidth) :
+        size(_size),
+        lowerBandwidth(_lowerBandwidth),
+        upperBandwidth(_upperBandwidth),
+        width(_lowerBandwidth + _upperBandwidth + 1)
+{
+    if(_size < 0 || _lowerBandwidth < 0 || _upperBandwidth < 0)
+    {
+        throw std::invalid_argument("BandedMatrix - negative size or bandwidth");
+    }
+    data.resize(static_cast<std::size_t>(size) * width);
+}
+
+///@brief Creates band matrix from band of square dense matrix, elements outside the band are ignored
+template<typename T>
+BandedMatrix<T>::BandedMatrix(Matrix<T>& dense, int _lowerBandwidth, int _upperBandwidth) :
+        BandedMatrix(MatrixKernels::packedSize(dense, "BandedMatrix - dense size exceeds int range"), _lowerBandwidth,
+                     _upperBandwidth)
+{
+    if(dense.getColumnCount() != size)
+    {
+        throw std::invalid_argument("BandedMatrix - dense matrix is not square");
+    }
+    const T* source = dense.cbegin();
+    for(int row = 0; row < size; row++)
+    {
+        const T* sourceRow = source + static_cast<MatrixIndex>(row) * size;
+        std::copy(sourceRow + firstColumn(row), sourceRow + lastColumn(row), rowData(row));
+    }
+}
+
+template<typename T>
+int BandedMatrix<T>::getRowCount() {
+    return size;
+}
+
+template<typename T>
+int BandedMatrix<T>::getColumnCount() {
+    return size;
+}
+
+template<typename T>
+int BandedMatrix<T>::getLowerBandwidth() {
+    return lowerBandwidth;
+}
+
+template<typename T>
+int BandedMatrix<T>::getUpperBandwidth() {
+    return upperBandwidth;
+}
+
+///@brief Gets first column of row inside the band and the matrix
+template<typename T>
+int BandedMatrix<T>::firstColumn(int row) {
+    return std::max(0, row - lowerBandwidth);
+}
+
+///@brief Gets column after the last column of row inside the band and the matrix
+template<typename T>
+int BandedMatrix<T>::lastColumn(int row) {
+    return std::min(size, row + upperBandwidth + 1);
+}
+
+///@brief Gets pointer to band part of row, element (row, firstColumn(row)) comes first
+template<typename T>
+T* BandedMatrix<T>::rowData(int row) {
+    return data.data() + static_cast<std::size_t>(row) * width + (firstColumn(row) - row + lowerBandwidth);
+}
+
+///@brief Gets a reference to element at specified row and column inside the band
+///@note Elements outside the band are always zero and cannot be referenced
+template<typename T>
+T& BandedMatrix<T>::at(int row, int column) {
+    if(row < 0 || row >= size || column < firstColumn(row) || column >= lastColumn(row))
+    {
+        throw std::out_of_range("BandedMatrix::at - index out of range or outside band");
+    }
+    return data[static_cast<std::size_t>(row) * width + (column - row + lowerBandwidth)];
+}
+
+///@brief Gets value of element at specified row and column, zero outside the band
+template<typename T>
+T BandedMatrix<T>::get(int row, int column) {
+    if(row < 0 || row >= size || column < 0 || column >= size)
+    {
+        throw std::out_of_range("BandedMatrix::get - index out of range");
+    }
+    return column < firstColumn(row) || column >= lastColumn(row) ? T() :
+           data[static_cast<std::size_t>(row) * width + (column - row + lowerBandwidth)];
+}
+
+///@brief Copies matrix into dense storage
+template<typename T>
+Matrix<T> BandedMatrix<T>::toMatrix() {
+    Matrix<T> dense(size, size);
+    dense.fill(T());
+    T* destination = dense.begin();
+    for(int row = 0; row < size; row++)
+    {
+        std::copy(rowData(row), rowData(row) + lastColumn(row) - firstColumn(row),
+                  destination + static_cast<MatrixIndex>(row) * size + firstColumn(row));
+    }
+    return dense;
+}
+
+namespace MatrixKernels {
+
+///@brief Computes rows [rowBegin, rowEnd) of y = alpha * A * x + beta * y for matrix storing a contiguous range of every row
+template<typename Structured, typename T>
+void structuredGemvRows(Structured& a, const T* x, T* y, T alpha, T beta, int rowBegin, int rowEnd) {
+    for(int row = rowBegin; row < rowEnd; row++)
+    {
+        int first = a.firstColumn(row);
+        T product = alpha * dot(a.rowData(row), x + first, a.lastColumn(row) - first);
+        y[row] = beta == T(0) ? product : product + beta * y[row];
+    }
+}
+
+///@brief Computes y = alpha * A * x + beta * y for triangular or band matrix, row blocks run on ThreadPool
+template<typename Structured, typename T>
+void structuredGemv(Structured& a, std::span<const T> x, std::span<T> y, T alpha, T beta, std::size_t storedSize,
+                    const char* message) {
+    int size = a.getRowCount();
+    if(static_cast<MatrixIndex>(x.size()) != size || static_cast<MatrixIndex>(y.size()) != size)
+    {
+        throw std::invalid_argument(message);
+    }
+    if(storedSize < static_cast<std::size_t>(gemvParallelThreshold))
+    {
+        structuredGemvRows(a, x.data(), y.data(), alpha, beta, 0, size);
+        return;
+    }
+    int grain = std::max<int>(1, static_cast<int>((std::size_t(1) << 14) * size / storedSize));
+    ThreadPool::instance().parallelFor(0, size, grain, [&](int rowBegin, int rowEnd) {
+        structuredGemvRows(a, x.data(), y.data(), alpha, beta, rowBegin, rowEnd);
+    });
+}
+
+///@brief Adds alpha * A(rows [rowBegin, rowEnd)) * x to y[0, rowEnd) for packed lower triangle of symmetric A
+///@note Every stored element is read once and used for both of its positions
+template<typename T>
+void symmetricGemvRows(SymmetricMatrix<T>& a, const T* x, T* y, T alpha, int rowBegin, int rowEnd) {
+    for(int row = rowBegin; row < rowEnd; row++)
+    {
+        const T* elements = a.rowData(row);
+        y[row] += alpha * dot(elements, x, row + 1);
+        axpy(alpha * x[row], elements, y, row);
+    }
+}
+
+}
+
+///@brief Computes y = alpha * A * x + beta * y for symmetric A
+///@note Reads half of the elements a dense product reads. Large products split rows into a few blocks per
+/// thread holding equal amounts of stored elements. Each block accumulates into its own vector covering the
+/// rows it touches, and these are summed into y in parallel.
+template<typename T>
+void gemv(SymmetricMatrix<T>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y,
+          std::type_identity_t<T> alpha = T(1), std::type_identity_t<T> beta = T(0)) {
+    int size = a.getRowCount();
+    std::size_t storedSize = static_cast<std::size_t>(size) * (size + 1) / 2;
+    MATRIX_TRACE_SCOPE("gemv", size, size, static_cast<std::int64_t>(storedSize * sizeof(T)));
+    if(static_cast<MatrixIndex>(x.size()) != size || static_cast<MatrixIndex>(y.size()) != size)
+    {
+        throw std::invalid_argument("gemv - vector sizes do not match matrix dimensions");
+    }
+    MatrixKernels::scale(beta, y.data(), size);
+    if(storedSize < static_cast<std::size_t>(gemvParallelThreshold))
+    {
+        MatrixKernels::symmetricGemvRows(a, x.data(), y.data(), alpha, 0, size);
+        return;
+    }
+    ThreadPool& pool = ThreadPool::instance();
+    int blockCount = std::min<int>(size, 4 * static_cast<int>(pool.getThreadCount()));
+    //Rows [0, r) of the packed triangle hold r * (r + 1) / 2 elements, so equal shares end at size * sqrt(i / n)
+    std::vector<int> boundaries(blockCount + 1);
+    for(int block = 0; block <= blockCount; block++)
+    {
+        boundaries[block] = static_cast<int>(std::llround(size * std::sqrt(static_cast<double>(block) / blockCount)));
+    }
+    std::vector<std::vector<T>> partial(blockCount);
+    pool.parallelFor(0, blockCount, 1, [&](MatrixIndex firstBlock, MatrixIndex lastBlock) {
+        for(MatrixIndex block = firstBlock; block < lastBlock; block++)
+        {
+            std::vector<T>& sum = partial[block];
+            sum.assign(boundaries[block + 1], T(0));
+            MatrixKernels::symmetricGemvRows(a, x.data(), sum.data(), alpha, boundaries[block], boundaries[block + 1]);
+        }
+    });
+    pool.parallelFor(0, size, 4096, [&](MatrixIndex begin, MatrixIndex end) {
+        for(const std::vector<T>& sum : partial)
+        {
+            MatrixIndex last = std::min<MatrixIndex>(end, static_cast<MatrixIndex>(sum.size()));
+            if(last > begin)
+            {
+                MatrixKernels::axpy(T(1), sum.data() + begin, y.data() + begin, last - begin);
+            }
+        }
+    });
+}
+
+///@brief Computes y = alpha * A * x + beta * y for triangular A, only the stored triangle is read
+template<typename T>
+void gemv(TriangularMatrix<T>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y,
+          std::type_identity_t<T> alpha = T(1), std::type_identity_t<T> beta = T(0)) {
+    std::size_t storedSize = static_cast<std::size_t>(a.getRowCount()) * (a.getRowCount() + 1) / 2;
+    MATRIX_TRACE_SCOPE("gemv", a.getRowCount(), a.getColumnCount(), static_cast<std::int64_t>(storedSize * sizeof(T)));
+    MatrixKernels::structuredGemv<TriangularMatrix<T>, T>(a, x, y, alpha, beta, storedSize,
+                                                         "gemv - vector sizes do not match matrix dimensions");
+}
+
+///@brief Computes y = alpha * A * x + beta * y for band matrix A, only the band is read
+template<typename T>
+void gemv(BandedMatrix<T>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y,
+          std::type_identity_t<T> alpha = T(1), std::type_identity_t<T> beta = T(0)) {
+    std::size_t storedSize = static_cast<std::size_t>(a.getRowCount()) *
+            (a.getLowerBandwidth() + a.getUpperBandwidth() + 1);
+    MATRIX_TRACE_SCOPE("gemv", a.getRowCount(), a.getColumnCount(), static_cast<std::int64_t>(storedSize * sizeof(T)));
+    MatrixKernels::structuredGemv<BandedMatrix<T>, T>(a, x, y, alpha, beta, storedSize,
+                                                     "gemv - vector sizes do not match matrix dimensions");
+}
+
+///@brief Computes C = alpha * A * B + beta * C for symmetric A and dense B
+///@note Every stored element of A is read once per panel of packedPanelColumns columns and used for both
+/// of its positions. Panels run on ThreadPool.
+template<typename T>
+void gemm(SymmetricMatrix<T>& a, Matrix<T>& b, Matrix<T>& c, std::type_identity_t<T> alpha = T(1),
+          std::type_identity_t<T> beta = T(0)) {
+    int size = a.getRowCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != size || c.getRowCount() != size || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("gemm - matrix dimensions do not match");
+    }
+    MATRIX_TRACE_SCOPE("gemm", size, n, (static_cast<std::int64_t>(size) * (size + 1) / 2 +
+                                         2 * static_cast<std::int64_t>(size) * n) * sizeof(T));
+    const T* bData = b.cbegin();
+    T* cData = c.begin();
+    if(cData == bData)
+    {
+        throw std::invalid_argument("gemm - result must not share data with operands");
+    }
+    ThreadPool::instance().parallelFor(0, n, packedPanelColumns, [&](MatrixIndex colBegin, MatrixIndex colEnd) {
+        MatrixIndex panelWidth = colEnd - colBegin;
+        for(int row = 0; row < size; row++)
+        {
+            MatrixKernels::scale(beta, cData + row * n + colBegin, panelWidth);
+        }
+        for(int row = 0; row < size; row++)
+        {
+            const T* elements = a.rowData(row);
+            T* cRow = cData + row * n + colBegin;
+            const T* bRow = bData + row * n + colBegin;
+            for(int column = 0; column < row; column++)
+            {
+                T weight = alpha * elements[column];
+                MatrixKernels::axpy(weight, bData + column * n + colBegin, cRow, panelWidth);
+                MatrixKernels::axpy(weight, bRow, cData + column * n + colBegin, panelWidth);
+            }
+            MatrixKernels::axpy(alpha * elements[row], bRow, cRow, panelWidth);
+        }
+    });
+}
+
+///@brief Computes C = alpha * A * B + beta * C for triangular A and dense B, zero triangle of A is skipped
+template<typename T>
+void gemm(TriangularMatrix<T>& a, Matrix<T>& b, Matrix<T>& c, std::type_identity_t<T> alpha = T(1),
+          std::type_identity_t<T> beta = T(0)) {
+    int size = a.getRowCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != size || c.getRowCount() != size || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("gemm - matrix dimensions do not match");
+    }
+    MATRIX_TRACE_SCOPE("gemm", size, n, (static_cast<std::int64_t>(size) * (size + 1) / 2 +
+                                         2 * static_cast<std::int64_t>(size) * n) * sizeof(T));
+    const T* bData = b.cbegin();
+    T* cData = c.begin();
+    if(cData == bData)
+    {
+        throw std::invalid_argument("gemm - result must not share data with operands");
+    }
+    ThreadPool::instance().parallelFor(0, n, packedPanelColumns, [&](MatrixIndex colBegin, MatrixIndex colEnd) {
+        MatrixIndex panelWidth = colEnd - colBegin;
+        for(int row = 0; row < size; row++)
+        {
+            T* cRow = cData + row * n + colBegin;
+            MatrixKernels::scale(beta, cRow, panelWidth);
+            const T* elements = a.rowData(row);
+            for(int column = a.firstColumn(row); column < a.lastColumn(row); column++)
+            {
+                MatrixKernels::axpy(alpha * elements[column - a.firstColumn(row)], bData + column * n + colBegin,
+                                    cRow, panelWidth);
+            }
+        }
+    });
+}
+
+///@brief Solves A * x = b for triangular A by forward or backward substitution
+///@param b Right-hand side, overwritten with x
+template<typename T>
+void triangularSolve(TriangularMatrix<T>& a, std::type_identity_t<std::span<T>> b) {
+    int size = a.getRowCount();
+    if(static_cast<MatrixIndex>(b.size()) != size)
+    {
+        throw std::invalid_argument("triangularSolve - vector size does not match matrix dimensions");
+    }
+    MATRIX_TRACE_SCOPE("triangularSolve", size, 1, static_cast<std::int64_t>(size) * (size + 1) / 2 * sizeof(T));
+    T* x = b.data();
+    if(a.getTriangle() == Triangle::Lower)
+    {
+        for(int row = 0; row < size; row++)
+        {
+            const T* elements = a.rowData(row);
+            x[row] = (x[row] - MatrixKernels::dot(elements, x, row)) / elements[row];
+        }
+        return;
+    }
+    for(int row = size - 1; row >= 0; row--)
+    {
+        const T* elements = a.rowData(row);
+        x[row] = (x[row] - MatrixKernels::dot(elements + 1, x + row + 1, size - row - 1)) / elements[0];
+    }
+}
+
+///@brief Solves A * X = B for triangular A and every column of dense B
+///@note Panels of packedPanelColumns columns of B are solved independently on ThreadPool
+///@param b Right-hand sides, overwritten with X
+template<typename T>
+void triangularSolve(TriangularMatrix<T>& a, Matrix<T>& b) {
+    int size = a.getRowCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != size)
+    {
+        throw std::invalid_argument("triangularSolve - matrix dimensions do not match");
+    }
+    MATRIX_TRACE_SCOPE("triangularSolve", size, n, (static_cast<std::int64_t>(size) * (size + 1) / 2 +
+                                                    2 * static_cast<std::int64_t>(size) * n) * sizeof(T));
+    bool lower = a.getTriangle() == Triangle::Lower;
+    T* x = b.begin();
+    ThreadPool::instance().parallelFor(0, n, packedPanelColumns, [&](MatrixIndex colBegin, MatrixIndex colEnd) {
+        MatrixIndex panelWidth = colEnd - colBegin;
+        for(int step = 0; step < size; step++)
+        {
+            int row = lower ? step : size - 1 - step;
+            const T* elements = a.rowData(row);
+            T* xRow = x + row * n + colBegin;
+            int first = a.firstColumn(row);
+            for(int column = first; column < a.lastColumn(row); column++)
+            {
+                if(column != row)
+                {
+                    MatrixKernels::axpy(-elements[column - first], x + column * n + colBegin, xRow, panelWidth);
+                }
+            }
+            MatrixKernels::scale(T(1) / elements[row - first], xRow, panelWidth);
+        }
+    });
+}
+
+///@brief Solves A * x = b for band matrix A by band LU factorization without pivoting
+///@note Without pivoting the factors stay inside the band, so work is proportional to size times bandwidths.
+/// Suited for diagonally dominant or positive definite systems such as PDE discretizations. A is not modified.
+///@param b Right-hand side, overwritten with x
+template<typename T>
+void bandedSolve(BandedMatrix<T>& a, std::type_identity_t<std::span<T>> b) {
+    int size = a.getRowCount();
+    if(static_cast<MatrixIndex>(b.size()) != size)
+    {
+        throw std::invalid_argument("bandedSolve - vector size does not match matrix dimensions");
+    }
+    int lowerBandwidth = a.getLowerBandwidth();
+    MATRIX_TRACE_SCOPE("bandedSolve", size, lowerBandwidth + a.getUpperBandwidth() + 1,
+                       2 * static_cast<std::int64_t>(size) * (lowerBandwidth + a.getUpperBandwidth() + 1) * sizeof(T));
+    BandedMatrix<T> factors = a;
+    T* x = b.data();
+    for(int pivotRow = 0; pivotRow < size; pivotRow++)
+    {
+        T* pivotElements = factors.rowData(pivotRow) + (pivotRow - factors.firstColumn(pivotRow));
+        if(pivotElements[0] == T(0))
+        {
+            throw std::invalid_argument("bandedSolve - zero pivot, matrix needs pivoting");
+        }
+        int pivotWidth = factors.lastColumn(pivotRow) - pivotRow;
+        for(int row = pivotRow + 1; row < std::min(size, pivotRow + lowerBandwidth + 1); row++)
+        {
+            T* elements = factors.rowData(row) + (pivotRow - factors.firstColumn(row));
+            T factor = elements[0] / pivotElements[0];
+            MatrixKernels::axpy(-factor, pivotElements, elements, pivotWidth);
+            x[row] -= factor * x[pivotRow];
+        }
+    }
+    for(int row = size - 1; row >= 0; row--)
+    {
+        const T* elements = factors.rowData(row) + (row - factors.firstColumn(row));
+        int width = factors.lastColumn(row) - row;
+        x[row] = (x[row] - MatrixKernels::dot(elements + 1, x + row + 1, width - 1)) / elements[0];
+    }
+}
+
+#endif //MATRIX_PACKEDMATRIX_H
@@ -0,0 +1,256 @@
+#ifndef MATRIX_PERMUTEDMATRIX_H
+#define MATRIX_PERMUTEDMATRIX_H
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "Matrix.h"
+#include "ThreadPool.h"
+
+///@brief View of a matrix with rows and columns reordered through index maps
+///@note Reordering only touches the maps, elements stay where they are in the viewed matrix.
+/// Viewed data is shared with the source handle, writing through at() detaches it like any other Matrix write,
+/// get() and the read-only algorithms read the shared data without detaching.
+/// Index maps hold int, so each dimension of the viewed matrix is limited to int range.
+template<typename T>
+class PermutedMatrix {
+private:
+    static constexpr int sortGrain = 4096;
+    static constexpr int materializeBytes = 32 * 1024;
+
+    Matrix<T> source;
+    std::vector<int> rowMap;
+    std::vector<int> colMap;
+
+    static void checkPermutation(const std::vector<int>& permutation, int size);
+
+public:
+    explicit PermutedMatrix(const Matrix<T>& matrix);
+
+    int getRowCount();
+    int getColumnCount();
+    const std::vector<int>& getRowMap();
+    const std::vector<int>& getColumnMap();
+    T& at(int row, int column);
+    T get(int row, int column);
+
+    void swapRows(int lhs, int rhs);
+    void swapColumns(int lhs, int rhs);
+    void permuteRows(const std::vector<int>& permutation);
+    void permuteColumns(const std::vector<int>& permutation);
+    template<typename Compare = std::less<T>>
+    void sortRowsBy(int column, Compare compare = Compare());
+
+    Matrix<T> materialize();
+};
+
+///@brief Creates identity view of matrix, sharing its data
+template<typename T>
+PermutedMatrix<T>::PermutedMatrix(const Matrix<T> &matrix) :
+        source(matrix)
+{
+    if(source.getRowCount() > std::numeric_limits<int>::max() || source.getColumnCount() > std::numeric_limits<int>::max())
+    {
+        throw std::length_error("PermutedMatrix - dimension exceeds int range of index maps");
+    }
+    rowMap.resize(source.getRowCount());
+    colMap.resize(source.getColumnCount());
+    std::iota(rowMap.begin(), rowMap.end(), 0);
+    std::iota(colMap.begin(), colMap.end(), 0);
+}
+
+template<typename T>
+int PermutedMatrix<T>::getRowCount() {
+    return static_cast<int>(rowMap.size());
+}
+
+template<typename T>
+int PermutedMatrix<T>::getColumnCount() {
+    return static_cast<int>(colMap.size());
+}
+
+///@brief Gets row map, row i of the view is row getRowMap()[i] of the viewed matrix
+template<typename T>
+const std::vector<int>& PermutedMatrix<T>::getRowMap() {
+    return rowMap;
+}
+
+///@brief Gets column map, column i of the view is column getColumnMap()[i] of the viewed matrix
+template<typename T>
+const std::vector<int>& PermutedMatrix<T>::getColumnMap() {
+    return colMap;
+}
+
+///@brief Returns reference to object at specified row and column coordinates of the view
+template<typename T>
+T& PermutedMatrix<T>::at(int row, int column) {
+    if(row < 0 || column < 0 || row >= getRowCount() || column >= getColumnCount())
+    {
+        throw std::out_of_range("PermutedMatrix::at - index out of range");
+    }
+    return source.at(rowMap[row], colMap[column]);
+}
+
+///@brief Gets value of element at specified row and column coordinates of the view without detaching shared data
+template<typename T>
+T PermutedMatrix<T>::get(int row, int column) {
+    if(row < 0 || column < 0 || row >= getRowCount() || column >= getColumnCount())
+    {
+        throw std::out_of_range("PermutedMatrix::get - index out of range");
+    }
+    return source.cbegin()[static_cast<MatrixIndex>(rowMap[row]) * source.getColumnCount() + colMap[column]];
+}
+
+template<typename T>
+void PermutedMatrix<T>::swapRows(int lhs, int rhs) {
+    if(lhs < 0 || rhs < 0 || lhs >= getRowCount() || rhs >= getRowCount())
+    {
+        throw std::out_of_range("PermutedMatrix::swapRows - index out of range");
+    }
+    std::swap(rowMap[lhs], rowMap[rhs]);
+}
+
+template<typename T>
+void PermutedMatrix<T>::swapColumns(int lhs, int rhs) {
+    if(lhs < 0 || rhs < 0 || lhs >= getColumnCount() || rhs >= getColumnCount())
+    {
+        throw std::out_of_range("PermutedMatrix::swapColumns - index out of range");
+    }
+    std::swap(colMap[lhs], colMap[rhs]);
+}
+
+///@brief Reorders rows of the view
+///@param permutation Row i of the result is row permutation[i] of the current view
+template<typename T>
+void PermutedMatrix<T>::permuteRows(const std::vector<int> &permutation) {
+    checkPermutation(permutation, getRowCount());
+    std::vector<int> permuted(rowMap.size());
+    for(std::size_t i = 0; i < permutation.size(); i++)
+    {
+        permuted[i] = rowMap[permutation[i]];
+    }
+    rowMap.swap(permuted);
+}
+
+///@brief Reorders columns of the view
+///@param permutation Column i of the result is column permutation[i] of the current view
+template<typename T>
+void PermutedMatrix<T>::permuteColumns(const std::vector<int> &permutation) {
+    checkPermutation(permutation, getColumnCount());
+    std::vector<int> permuted(colMap.size());
+    for(std::size_t i = 0; i < permutation.size(); i++)
+    {
+        permuted[i] = colMap[permutation[i]];
+    }
+    colMap.swap(permuted);
+}
+
+///@brief Stably sorts rows of the view by values in one column
+///@note Runs of rows are sorted on the thread pool and then merged pairwise in parallel rounds
+///@param column Column of the view holding sort keys
+///@param compare Strict weak ordering of keys
+template<typename T>
+template<typename Compare>
+void PermutedMatrix<T>::sortRowsBy(int column, Compare compare) {
+    MATRIX_TRACE_SCOPE("PermutedMatrix::sortRowsBy", getRowCount(), getColumnCount(),
+                       static_cast<std::int64_t>(getRowCount()) * sizeof(T));
+    if(column < 0 || column >= getColumnCount())
+    {
+        throw std::out_of_range("PermutedMatrix::sortRowsBy - column index out of range");
+    }
+    const T* data = source.cbegin();
+    MatrixIndex stride = source.getColumnCount();
+    int keyColumn = colMap[column];
+    auto less = [&](int lhs, int rhs) {
+        return compare(data[lhs * stride + keyColumn], data[rhs * stride + keyColumn]);
+    };
+
+    ThreadPool& pool = ThreadPool::instance();
+    MatrixIndex count = getRowCount();
+    MatrixIndex threadCount = pool.getThreadCount();
+    MatrixIndex runLength = std::max<MatrixIndex>(sortGrain, (count + threadCount - 1) / std::max<MatrixIndex>(1, threadCount));
+    MatrixIndex runCount = (count + runLength - 1) / runLength;
+    pool.parallelFor(0, runCount, 1, [&](MatrixIndex firstRun, MatrixIndex lastRun) {
+        for(MatrixIndex run = firstRun; run < lastRun; run++)
+        {
+            auto first = rowMap.begin() + run * runLength;
+            std::stable_sort(first, first + std::min(runLength, count - run * runLength), less);
+        }
+    });
+
+    std::vector<int> merged(rowMap.size());
+    for(MatrixIndex width = runLength; width < count; width *= 2)
+    {
+        MatrixIndex pairCount = (count + 2 * width - 1) / (2 * width);
+        pool.parallelFor(0, pairCount, 1, [&](MatrixIndex firstPair, MatrixIndex lastPair) {
+            for(MatrixIndex pair = firstPair; pair < lastPair; pair++)
+            {
+                MatrixIndex begin = pair * 2 * width;
+                MatrixIndex middle = std::min(count, begin + width);
+                MatrixIndex end = std::min(count, begin + 2 * width);
+                std::merge(rowMap.begin() + begin, rowMap.begin() + middle, rowMap.begin() + middle,
+                           rowMap.begin() + end, merged.begin() + begin, less);
+            }
+        });
+        rowMap.swap(merged);
+    }
+}
+
+///@brief Copies the view into a new contiguous matrix
+///@note Destination is written sequentially row by row, rows are copied whole when columns are not permuted
+template<typename T>
+Matrix<T> PermutedMatrix<T>::materialize() {
+    MATRIX_TRACE_SCOPE("PermutedMatrix::materialize", getRowCount(), getColumnCount(),
+                       2 * static_cast<std::int64_t>(getRowCount()) * getColumnCount() * sizeof(T));
+    Matrix<T> result(getRowCount(), getColumnCount());
+    const T* data = source.cbegin();
+    T* destination = result.begin();
+    MatrixIndex stride = source.getColumnCount();
+    MatrixIndex colCount = getColumnCount();
+    bool columnsInOrder = true;
+    for(MatrixIndex column = 0; column < colCount; column++)
+    {
+        columnsInOrder = columnsInOrder && colMap[column] == column;
+    }
+    MatrixIndex grain = std::max<MatrixIndex>(1, materializeBytes / (sizeof(T) * std::max<MatrixIndex>(1, colCount)));
+    ThreadPool::instance().parallelFor(0, getRowCount(), grain, [&](MatrixIndex firstRow, MatrixIndex lastRow) {
+        for(MatrixIndex row = firstRow; row < lastRow; row++)
+        {
+            const T* sourceRow = data + rowMap[row] * stride;
+            T* destinationRow = destination + row * colCount;
+            if(columnsInOrder)
+            {
+                std::copy(sourceRow, sourceRow + colCount, destinationRow);
+                continue;
+            }
+            for(MatrixIndex column = 0; column < colCount; column++)
+            {
+                destinationRow[column] = sourceRow[colMap[column]];
+            }
+        }
+    });
+    return result;
+}
+
+template<typename T>
+void PermutedMatrix<T>::checkPermutation(const std::vector<int> &permutation, int size) {
+    if(static_cast<int>(permutation.size()) != size)
+    {
+        throw std::invalid_argument("PermutedMatrix - permutation size does not match");
+    }
+    std::vector<bool> seen(size, false);
+    for(int index : permutation)
+    {
+        if(index < 0 || index >= size || seen[index])
+        {
+            throw std::invalid_argument("PermutedMatrix - not a permutation");
+        }
+        seen[index] = true;
+    }
+}
+
+#endif //MATRIX_PERMUTEDMATRIX_H
@@ -0,0 +1,466 @@
+#ifndef MATRIX_REDUCEDPRECISION_H
+#define MATRIX_REDUCEDPRECISION_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixAlgebra.h"
+#include "ThreadPool.h"
+
+///@brief IEEE 754 binary16 value emulated in software
+///@note Arithmetic is done by converting to float, conversion from float rounds to nearest even.
+/// Comparison follows float, so +0 equals -0 and NaN differs from itself.
+class Half {
+private:
+    std::uint16_t bits;
+
+public:
+    Half() : bits(0) {};
+    Half(float value);
+    operator float() const;
+    std::uint16_t getBits() const {return bits;};
+    static Half fromBits(std::uint16_t bits);
+    friend bool operator==(Half lhs, Half rhs) {return static_cast<float>(lhs) == static_cast<float>(rhs);};
+};
+
+///@brief Brain floating point value (upper half of IEEE 754 binary32) emulated in software
+///@note Arithmetic is done by converting to float, conversion from float rounds to nearest even.
+/// Comparison follows float, so +0 equals -0 and NaN differs from itself.
+class BFloat16 {
+private:
+    std::uint16_t bits;
+
+public:
+    BFloat16() : bits(0) {};
+    BFloat16(float value);
+    operator float() const;
+    std::uint16_t getBits() const {return bits;};
+    static BFloat16 fromBits(std::uint16_t bits);
+    friend bool operator==(BFloat16 lhs, BFloat16 rhs) {return static_cast<float>(lhs) == static_cast<float>(rhs);};
+};
+
+///@brief Element types stored with 16 bits and computed with float accumulation
+template<typename T>
+concept ReducedFloat = std::same_as<T, Half> || std::same_as<T, BFloat16>;
+
+///@brief Matrices of reduced precision values are compared by value, since -0 and +0 have different bits
+template<ReducedFloat T>
+struct BytewiseComparable<T> : std::false_type {};
+
+///@brief Hashes reduced precision value consistently with its operator==, -0 and +0 hash equal
+template<ReducedFloat T>
+struct std::hash<T> {
+    std::size_t operator()(T value) const {
+        float widened = static_cast<float>(value);
+        return std::hash<float>()(widened == 0.0f ? 0.0f : widened);
+    }
+};
+
+///@brief Granularity of int8 quantization scale
+enum class QuantizationScale {
+    PerTensor,
+    PerRow
+};
+
+///@brief Matrix of symmetric int8 quantized values, element value is stored value times scale of its row
+class QuantizedMatrix {
+private:
+    Matrix<std::int8_t> values;
+    std::vector<float> scales;
+    QuantizationScale granularity;
+
+public:
+    QuantizedMatrix(Matrix<float>& source, QuantizationScale _granularity);
+    MatrixIndex getRowCount();
+    MatrixIndex getColumnCount();
+    float getScale(MatrixIndex row);
+    QuantizationScale getGranularity();
+    Matrix<std::int8_t>& getValues();
+    Matrix<float> dequantize();
+};
+
+inline Half::Half(float value) {
+    std::uint32_t floatBits = std::bit_cast<std::uint32_t>(value);
+    std::uint32_t sign = (floatBits >> 16) & 0x8000u;
+    std::uint32_t magnitude = floatBits & 0x7fffffffu;
+    if(magnitude >= 0x7f800000u) //Infinity or NaN, NaN stays quiet
+    {
+        bits = static_cast<std::uint16_t>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u));
+        return;
+    }
+    if(magnitude >= 0x477ff000u) //Rounds above largest finite half
+    {
+        bits = static_cast<std::uint16_t>(sign | 0x7c00u);
+        return;
+    }
+    if(magnitude < 0x33000000u) //Below half of smallest subnormal half
+    {
+        bits = static_cast<std::uint16_t>(sign);
+        return;
+    }
+    std::uint32_t exponent = magnitude >> 23;
+    std::uint32_t result;
+    std::uint32_t remainder;
+    std::uint32_t halfway;
+    if(exponent < 113) //Subnormal half, implicit bit becomes explicit
+    {
+        std::uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+        std::uint32_t shift = 126 - exponent;
+        result = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else
+    {
+        result = ((exponent - 112) << 10) | ((magnitude & 0x7fffffu) >> 13);
+        remainder = magnitude & 0x1fffu;
+        halfway = 0x1000u;
+    }
+    //Carry out of mantissa correctly increments exponent
+    if(remainder > halfway || (remainder == halfway && (result & 1u)))
+    {
+        result++;
+    }
+    bits = static_cast<std::uint16_t>(sign | result);
+}
+
+inline Half::operator float() const {
+    std::uint32_t sign = static_cast<std::uint32_t>(bits & 0x8000u) << 16;
+    std::uint32_t exponent = (bits >> 10) & 0x1fu;
+    std::uint32_t mantissa = bits & 0x3ffu;
+    std::uint32_t floatBits;
+    if(exponent == 0x1fu)
+    {
+        floatBits = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else if(exponent != 0)
+    {
+        floatBits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if(mantissa == 0)
+    {
+        floatBits = sign;
+    }
+    else //Subnormal half is a normal float
+    {
+        exponent = 113;
+        while(!(mantissa & 0x400u))
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        floatBits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+    }
+    return std::bit_cast<float>(floatBits);
+}
+
+inline Half Half::fromBits(std::uint16_t bits) {
+    Half result;
+    result.bits = bits;
+    return result;
+}
+
+inline BFloat16::BFloat16(float value) {
+    std::uint32_t floatBits = std::bit_cast<std::uint32_t>(value);
+    if((floatBits & 0x7fffffffu) > 0x7f800000u)
+    {
+        bits = static_cast<std::uint16_t>((floatBits >> 16) | 0x40u);
+        return;
+    }
+    floatBits += 0x7fffu + ((floatBits >> 16) & 1u);
+    bits = static_cast<std::uint16_t>(floatBits >> 16);
+}
+
+inline BFloat16::operator float() const {
+    return std::bit_cast<float>(static_cast<std::uint32_t>(bits) << 16);
+}
+
+inline BFloat16 BFloat16::fromBits(std::uint16_t bits) {
+    BFloat16 result;
+    result.bits = bits;
+    return result;
+}
+
+///@brief Converts float matrix to reduced precision storage, rounding to nearest even
+///@param source Matrix to convert
+///@retval Matrix of the same dimensions holding Half or BFloat16 elements
+template<ReducedFloat T>
+Matrix<T> toReducedPrecision(Matrix<float>& source) {
+    Matrix<T> result(source.getRowCount(), source.getColumnCount());
+    result.parallelTransform(source, [](float element) {return T(element);});
+    return result;
+}
+
+///@brief Converts matrix of any element type convertible to float into float matrix
+template<typename T>
+Matrix<float> toFloat(Matrix<T>& source) {
+    Matrix<float> result(source.getRowCount(), source.getColumnCount());
+    result.parallelTransform(source, [](T element) {return static_cast<float>(element);});
+    return result;
+}
+
+namespace MatrixKernels {
+
+///@brief Amount of reduced precision elements widened to float at once, sized to stay in L1 cache
+constexpr int widenBlock = 1024;
+
+///@brief Converts reduced precision elements to float
+template<ReducedFloat T>
+void widen(const T* source, float* destination, MatrixIndex size) {
+    for(MatrixIndex index = 0; index < size; index++)
+    {
+        destination[index] = static_cast<float>(source[index]);
+    }
+}
+
+///@brief Computes dot product of int8 vectors with int32 accumulation
+inline std::int32_t dot(const std::int8_t* lhs, const std::int8_t* rhs, MatrixIndex size) {
+    std::int32_t sum = 0;
+    for(MatrixIndex index = 0; index < size; index++)
+    {
+        sum += static_cast<std::int32_t>(lhs[index]) * static_cast<std::int32_t>(rhs[index]);
+    }
+    return sum;
+}
+
+///@brief Quantizes float vector symmetrically to int8
+///@retval Scale that multiplies stored values back to floats
+inline float quantize(const float* source, std::int8_t* destination, MatrixIndex size) {
+    float maximum = 0;
+    for(MatrixIndex index = 0; index < size; index++)
+    {
+        maximum = std::max(maximum, std::abs(source[index]));
+    }
+    float scale = maximum > 0 ? maximum / 127.0f : 1.0f;
+    float inverse = 1.0f / scale;
+    for(MatrixIndex index = 0; index < size; index++)
+    {
+        float scaled = std::nearbyint(source[index] * inverse);
+        destination[index] = static_cast<std::int8_t>(std::clamp(scaled, -127.0f, 127.0f));
+    }
+    return scale;
+}
+
+}
+
+///@brief Quantizes float matrix to int8 with symmetric scale per tensor or per row
+///@param source Matrix to quantize
+///@param _granularity Whether one scale covers whole matrix or each row has own scale
+inline QuantizedMatrix::QuantizedMatrix(Matrix<float>& source, QuantizationScale _granularity) :
+        values(source.getRowCount(), source.getColumnCount()),
+        scales(source.getRowCount()),
+        granularity(_granularity)
+{
+    MatrixIndex rowCount = source.getRowCount();
+    MatrixIndex colCount = source.getColumnCount();
+    const float* sourceData = source.cbegin();
+    std::int8_t* valueData = values.begin();
+    if(granularity == QuantizationScale::PerTensor)
+    {
+        float scale = MatrixKernels::quantize(sourceData, valueData, rowCount * colCount);
+        std::fill(scales.begin(), scales.end(), scale);
+        return;
+    }
+    ThreadPool::instance().parallelFor(0, rowCount, 64, [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+        {
+            scales[row] = MatrixKernels::quantize(sourceData + row * colCount, valueData + row * colCount, colCount);
+        }
+    });
+}
+
+///@brief Gets row count
+inline MatrixIndex QuantizedMatrix::getRowCount() {
+    return values.getRowCount();
+}
+
+///@brief Gets column count
+inline MatrixIndex QuantizedMatrix::getColumnCount() {
+    return values.getColumnCount();
+}
+
+///@brief Gets scale of specified row, equal for every row of per-tensor quantized matrix
+inline float QuantizedMatrix::getScale(MatrixIndex row) {
+    return scales.at(row);
+}
+
+///@brief Gets quantization scale granularity
+inline QuantizationScale QuantizedMatrix::getGranularity() {
+    return granularity;
+}
+
+///@brief Gets stored int8 values
+inline Matrix<std::int8_t>& QuantizedMatrix::getValues() {
+    return values;
+}
+
+///@brief Converts quantized values back to floats
+inline Matrix<float> QuantizedMatrix::dequantize() {
+    MatrixIndex colCount = values.getColumnCount();
+    const std::int8_t* valueData = values.cbegin();
+    Matrix<float> result(values.getRowCount(), colCount);
+    result.generate([&](MatrixIndex row, MatrixIndex col) {return valueData[row * colCount + col] * scales[row];});
+    return result;
+}
+
+///@brief Computes y = alpha * A * x + beta * y for Half or BFloat16 matrix with float accumulation
+///@note Matrix rows are widened to float block by block, so A is read from memory at 16 bits per element
+template<ReducedFloat T>
+void gemv(Matrix<T>& a, std::span<const float> x, std::span<float> y, float alpha = 1.0f, float beta = 0.0f) {
+    MATRIX_TRACE_SCOPE("gemv", a.getRowCount(), a.getColumnCount(), static_cast<std::int64_t>(a.getSize()) * sizeof(T));
+    MatrixIndex rowCount = a.getRowCount();
+    MatrixIndex colCount = a.getColumnCount();
+    if(static_cast<MatrixIndex>(x.size()) != colCount || static_cast<MatrixIndex>(y.size()) != rowCount)
+    {
+        throw std::invalid_argument("gemv - vector sizes do not match matrix dimensions");
+    }
+    const T* data = a.cbegin();
+    auto rows = [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        float widened[MatrixKernels::widenBlock];
+        for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+        {
+            float sum = 0;
+            for(MatrixIndex colBegin = 0; colBegin < colCount; colBegin += MatrixKernels::widenBlock)
+            {
+                int width = static_cast<int>(std::min<MatrixIndex>(MatrixKernels::widenBlock, colCount - colBegin));
+                MatrixKernels::widen(data + row * colCount + colBegin, widened, width);
+                sum += MatrixKernels::dot(widened, x.data() + colBegin, width);
+            }
+            y[row] = beta == 0.0f ? alpha * sum : alpha * sum + beta * y[row];
+        }
+    };
+    if(rowCount * colCount < gemvParallelThreshold)
+    {
+        rows(0, rowCount);
+        return;
+    }
+    MatrixIndex grain = std::max<MatrixIndex>(1, (1 << 14) / std::max<MatrixIndex>(1, colCount));
+    ThreadPool::instance().parallelFor(0, rowCount, grain, rows);
+}
+
+///@brief Computes C = alpha * A * B + beta * C for Half or BFloat16 operands with float accumulation
+///@note Panels of B are widened to float once and shared by all threads computing row blocks of C
+template<ReducedFloat T>
+void gemm(Matrix<T>& a, Matrix<T>& b, Matrix<float>& c, float alpha = 1.0f, float beta = 0.0f) {
+    MATRIX_TRACE_SCOPE("gemm", c.getRowCount(), c.getColumnCount(),
+                       (static_cast<std::int64_t>(a.getSize()) + b.getSize()) * sizeof(T) +
+                       2 * static_cast<std::int64_t>(c.getSize()) * sizeof(float));
+    MatrixIndex m = a.getRowCount();
+    MatrixIndex k = a.getColumnCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != k || c.getRowCount() != m || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("gemm - matrix dimensions do not match");
+    }
+    constexpr int blockK = 256;
+    const T* aData = a.cbegin();
+    const T* bData = b.cbegin();
+    float* cData = c.begin();
+    std::vector<float> panel(static_cast<std::size_t>(std::min<MatrixIndex>(k, blockK)) * n);
+    for(MatrixIndex row = 0; row < m; row++)
+    {
+        MatrixKernels::scale(beta, cData + row * n, n);
+    }
+    for(MatrixIndex depthBegin = 0; depthBegin < k; depthBegin += blockK)
+    {
+        int depth = static_cast<int>(std::min<MatrixIndex>(blockK, k - depthBegin));
+        MatrixKernels::widen(bData + depthBegin * n, panel.data(), depth * n);
+        ThreadPool::instance().parallelFor(0, m, 64, [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+            float widened[blockK];
+            for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+            {
+                MatrixKernels::widen(aData + row * k + depthBegin, widened, depth);
+                MatrixKernels::gemm(1, n, depth, alpha, widened, depth, panel.data(), n, 1.0f, cData + row * n, n);
+            }
+        });
+    }
+}
+
+///@brief Computes y = alpha * A * x + beta * y for quantized A with int32 accumulation
+///@note x is quantized to int8 with per-tensor scale before the product
+inline void gemv(QuantizedMatrix& a, std::span<const float> x, std::span<float> y, float alpha = 1.0f,
+          float beta = 0.0f) {
+    MATRIX_TRACE_SCOPE("gemv", a.getRowCount(), a.getColumnCount(),
+                       static_cast<std::int64_t>(a.getRowCount()) * a.getColumnCount());
+    MatrixIndex rowCount = a.getRowCount();
+    MatrixIndex colCount = a.getColumnCount();
+    if(static_cast<MatrixIndex>(x.size()) != colCount || static_cast<MatrixIndex>(y.size()) != rowCount)
+    {
+        throw std::invalid_argument("gemv - vector sizes do not match matrix dimensions");
+    }
+    std::vector<std::int8_t> quantizedX(colCount);
+    float xScale = MatrixKernels::quantize(x.data(), quantizedX.data(), colCount);
+    const std::int8_t* data = a.getValues().cbegin();
+    auto rows = [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+        {
+            std::int32_t sum = MatrixKernels::dot(data + row * colCount, quantizedX.data(), colCount);
+            float product = alpha * a.getScale(row) * xScale * static_cast<float>(sum);
+            y[row] = beta == 0.0f ? product : product + beta * y[row];
+        }
+    };
+    if(rowCount * colCount < gemvParallelThreshold)
+    {
+        rows(0, rowCount);
+        return;
+    }
+    MatrixIndex grain = std::max<MatrixIndex>(1, (1 << 14) / std::max<MatrixIndex>(1, colCount));
+    ThreadPool::instance().parallelFor(0, rowCount, grain, rows);
+}
+
+///@brief Computes C = alpha * A * B + beta * C for quantized operands with int32 accumulation
+///@note B must be quantized per tensor, since per-row scales of B do not factor out of the sum over k
+inline void gemm(QuantizedMatrix& a, QuantizedMatrix& b, Matrix<float>& c, float alpha = 1.0f, float beta = 0.0f) {
+    MATRIX_TRACE_SCOPE("gemm", c.getRowCount(), c.getColumnCount(),
+                       static_cast<std::int64_t>(a.getRowCount()) * a.getColumnCount() +
+                       static_cast<std::int64_t>(b.getRowCount()) * b.getColumnCount() +
+                       2 * static_cast<std::int64_t>(c.getSize()) * sizeof(float));
+    MatrixIndex m = a.getRowCount();
+    MatrixIndex k = a.getColumnCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != k || c.getRowCount() != m || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("gemm - matrix dimensions do not match");
+    }
+    if(b.getGranularity() != QuantizationScale::PerTensor)
+    {
+        throw std::invalid_argument("gemm - right operand must be quantized per tensor");
+    }
+    const std::int8_t* aData = a.getValues().cbegin();
+    const std::int8_t* bData = b.getValues().cbegin();
+    float* cData = c.begin();
+    float bScale = k > 0 ? b.getScale(0) : 1.0f;
+    ThreadPool::instance().parallelFor(0, m, 16, [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        std::vector<std::int32_t> accumulator(n);
+        for(MatrixIndex row = rowBegin; row < rowEnd; row++)
+        {
+            std::fill(accumulator.begin(), accumulator.end(), 0);
+            for(MatrixIndex depth = 0; depth < k; depth++)
+            {
+                std::int32_t multiplier = aData[row * k + depth];
+                const std::int8_t* bRow = bData + depth * n;
+                for(MatrixIndex col = 0; col < n; col++)
+                {
+                    accumulator[col] += multiplier * static_cast<std::int32_t>(bRow[col]);
+                }
+            }
+            float scale = alpha * a.getScale(row) * bScale;
+            float* cRow = cData + row * n;
+            for(MatrixIndex col = 0; col < n; col++)
+            {
+                float product = scale * static_cast<float>(accumulator[col]);
+                cRow[col] = beta == 0.0f ? product : product + beta * cRow[col];
+            }
+        }
+    });
+}
+
+#endif //MATRIX_REDUCEDPRECISION_H
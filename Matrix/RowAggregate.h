@@ -0,0 +1,114 @@
+#ifndef MATRIX_ROWAGGREGATE_H
+#define MATRIX_ROWAGGREGATE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Matrix.h"
+#include "ThreadPool.h"
+
+///@brief Value computed from every row of a matrix, kept up to date incrementally
+///@note update() revisits only rows written since the previous update, using row versions that MatrixImpl records
+/// once an aggregate has looked at it. Writes through at(), ptrAt() and row iterators mark their row, insertions
+/// and erasures mark the rows that moved, bulk writes such as fill() or begin() mark all rows. After the matrix
+/// is detached from shared data or assigned other data, the next update recomputes every row once.
+/// Column statistics are aggregated the same way, with each row giving its contribution, e.g. squared elements.
+///@warning The aggregate keeps a pointer to the matrix handle, which must outlive it. update() must not run
+/// concurrently with writes to the matrix.
+template<typename T, typename R>
+class RowAggregate {
+private:
+    static_assert(!std::is_same_v<R, bool>, "RowAggregate - rows are updated concurrently, use char instead of bool");
+
+    static constexpr int updateBytes = 32 * 1024;
+
+    Matrix<T>* matrix;
+    std::function<R(std::span<const T>)> function;
+    std::vector<R> values;
+    std::uint64_t identity;
+    std::uint64_t seenVersion;
+    MatrixIndex recomputedRowCount;
+
+public:
+    template<typename Function>
+    RowAggregate(Matrix<T>& _matrix, Function _function);
+
+    const std::vector<R>& update();
+    MatrixIndex getRecomputedRowCount();
+};
+
+template<typename T, typename Function>
+RowAggregate(Matrix<T>&, Function) -> RowAggregate<T, std::invoke_result_t<Function, std::span<const T>>>;
+
+///@brief Creates aggregate of matrix, values are computed by the first update()
+///@param _matrix Matrix handle followed by the aggregate
+///@param _function Callable taking row as std::span<const T> and returning its value, called concurrently
+template<typename T, typename R>
+template<typename Function>
+RowAggregate<T, R>::RowAggregate(Matrix<T>& _matrix, Function _function) :
+        matrix(&_matrix),
+        function(std::move(_function)),
+        identity(0),
+        seenVersion(0),
+        recomputedRowCount(0)
+{
+}
+
+///@brief Recomputes values of rows modified since the previous update
+///@retval Value of every matrix row, valid until the next update
+template<typename T, typename R>
+const std::vector<R>& RowAggregate<T, R>::update() {
+    MatrixImpl<T>* impl = matrix->impl;
+    impl->trackRowVersions();
+    MatrixIndex rowCount = impl->getRowCount();
+    std::uint64_t version = impl->getVersion();
+    std::vector<MatrixIndex> modifiedRows;
+    if(impl->getTrackingIdentity() != identity)
+    {
+        modifiedRows.resize(rowCount);
+        std::iota(modifiedRows.begin(), modifiedRows.end(), 0);
+    }
+    else
+    {
+        for(MatrixIndex row = 0; row < rowCount; row++)
+        {
+            if(impl->getRowVersion(row) > seenVersion)
+            {
+                modifiedRows.push_back(row);
+            }
+        }
+    }
+    MATRIX_TRACE_SCOPE("RowAggregate::update", static_cast<std::int64_t>(modifiedRows.size()), impl->getColumnCount(),
+                       static_cast<std::int64_t>(modifiedRows.size()) * impl->getColumnCount() * sizeof(T));
+    values.resize(rowCount);
+
+    const T* data = impl->getData();
+    MatrixIndex colCount = impl->getColumnCount();
+    MatrixIndex grain = std::max<MatrixIndex>(1, updateBytes / (sizeof(T) * std::max<MatrixIndex>(1, colCount)));
+    ThreadPool::instance().parallelFor(0, static_cast<MatrixIndex>(modifiedRows.size()), grain,
+                                       [&](MatrixIndex begin, MatrixIndex end) {
+        for(MatrixIndex index = begin; index < end; index++)
+        {
+            MatrixIndex row = modifiedRows[index];
+            values[row] = function(std::span<const T>(data + row * colCount, colCount));
+        }
+    });
+
+    identity = impl->getTrackingIdentity();
+    seenVersion = version;
+    recomputedRowCount = static_cast<MatrixIndex>(modifiedRows.size());
+    return values;
+}
+
+///@brief Gets amount of rows recomputed by the last update()
+template<typename T, typename R>
+MatrixIndex RowAggregate<T, R>::getRecomputedRowCount() {
+    return recomputedRowCount;
+}
+
+#endif //MATRIX_ROWAGGREGATE_H
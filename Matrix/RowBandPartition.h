@@ -0,0 +1,128 @@
+#ifndef MATRIX_ROWBANDPARTITION_H
+#define MATRIX_ROWBANDPARTITION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Matrix.h"
+
+///@brief Unchecked write access to a band of consecutive rows of a matrix split by RowBandPartition
+///@note Plain pointer and bounds, copying is free. Row indexes are rows of the whole matrix. Nothing is checked,
+/// synchronized or tracked, writers of different bands never touch the same element.
+///@warning Valid until the partition is sealed or destroyed
+template<typename T>
+class RowBandWriter {
+private:
+    T* data;
+    MatrixIndex firstRow;
+    MatrixIndex endRow;
+    MatrixIndex colCount;
+
+public:
+    RowBandWriter(T* _data, MatrixIndex _firstRow, MatrixIndex _endRow, MatrixIndex _colCount) :
+            data(_data), firstRow(_firstRow), endRow(_endRow), colCount(_colCount) {};
+
+    MatrixIndex getFirstRow() {return firstRow;};
+    MatrixIndex getEndRow() {return endRow;};
+    MatrixIndex getColumnCount() {return colCount;};
+    T& at(MatrixIndex row, MatrixIndex column) {return data[(row - firstRow) * colCount + column];};
+    std::span<T> row(MatrixIndex row) {return std::span<T>(data + (row - firstRow) * colCount, colCount);};
+    T* begin() {return data;};
+    T* end() {return data + (endRow - firstRow) * colCount;};
+};
+
+///@brief Splits matrix into bands of rows that threads fill concurrently without synchronization
+///@note The matrix is detached once on construction, which copies shared data, drops the cached hash and marks
+/// every row modified. The partition then holds the only handle, so writers need no checks until seal() hands
+/// the data back as an ordinary matrix that can be shared again.
+template<typename T>
+class RowBandPartition {
+private:
+    Matrix<T> matrix;
+    std::vector<MatrixIndex> boundaries;
+
+    void prepare();
+
+public:
+    RowBandPartition(Matrix<T> _matrix, int bandCount);
+    RowBandPartition(Matrix<T> _matrix, std::vector<MatrixIndex> _boundaries);
+
+    int getBandCount();
+    RowBandWriter<T> writer(int band);
+    Matrix<T> seal();
+};
+
+///@brief Splits matrix into bandCount bands of equal row counts, differing by at most one row
+///@param _matrix Matrix to fill, pass std::move of a handle to avoid copying its data
+template<typename T>
+RowBandPartition<T>::RowBandPartition(Matrix<T> _matrix, int bandCount) :
+        matrix(std::move(_matrix))
+{
+    if(bandCount <= 0)
+    {
+        throw std::invalid_argument("RowBandPartition - band count must be positive");
+    }
+    MatrixIndex rowCount = matrix.getRowCount();
+    boundaries.resize(bandCount + 1);
+    for(int band = 0; band <= bandCount; band++)
+    {
+        boundaries[band] = rowCount * band / bandCount;
+    }
+    prepare();
+}
+
+///@brief Splits matrix into bands starting at given rows
+///@param _boundaries First row of every band followed by row count, ascending from zero
+template<typename T>
+RowBandPartition<T>::RowBandPartition(Matrix<T> _matrix, std::vector<MatrixIndex> _boundaries) :
+        matrix(std::move(_matrix)),
+        boundaries(std::move(_boundaries))
+{
+    prepare();
+}
+
+///@brief Validates band boundaries and detaches matrix data for the writers
+template<typename T>
+void RowBandPartition<T>::prepare() {
+    if(boundaries.size() < 2 || boundaries.front() != 0 || boundaries.back() != matrix.getRowCount() ||
+       !std::is_sorted(boundaries.begin(), boundaries.end()))
+    {
+        throw std::invalid_argument("RowBandPartition - band boundaries must ascend from zero to row count");
+    }
+    MATRIX_TRACE_SCOPE("RowBandPartition", matrix.getRowCount(), matrix.getColumnCount(),
+                       static_cast<std::int64_t>(matrix.getSize()) * sizeof(T));
+    matrix.detach();
+}
+
+///@brief Gets amount of bands, zero after seal()
+template<typename T>
+int RowBandPartition<T>::getBandCount() {
+    return static_cast<int>(boundaries.size()) - 1;
+}
+
+///@brief Gets writer of band, called once per band and handed to the thread filling it
+template<typename T>
+RowBandWriter<T> RowBandPartition<T>::writer(int band) {
+    if(band < 0 || band >= getBandCount())
+    {
+        throw std::out_of_range("RowBandPartition::writer - band out of range");
+    }
+    MatrixIndex colCount = matrix.getColumnCount();
+    return RowBandWriter<T>(matrix.impl->getData() + boundaries[band] * colCount, boundaries[band],
+                            boundaries[band + 1], colCount);
+}
+
+///@brief Ends writing and returns the filled matrix
+///@note Every writer must have finished, e.g. by joining the producer threads. Hash and row versions were reset
+/// by the detach on construction and nothing could read them since, so the data is handed over as it is.
+template<typename T>
+Matrix<T> RowBandPartition<T>::seal() {
+    boundaries.assign(1, 0);
+    return std::move(matrix);
+}
+
+#endif //MATRIX_ROWBANDPARTITION_H
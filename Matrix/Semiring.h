@@ -0,0 +1,246 @@
+#ifndef MATRIX_SEMIRING_H
+#define MATRIX_SEMIRING_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "CpuDispatch.h"
+#include "Matrix.h"
+#include "MatrixAlgebra.h"
+#include "ThreadPool.h"
+
+//Semiring policies supply value_type, zero() (identity of add that annihilates multiply), one() (identity of
+//multiply), add(), multiply() and accumulate(weight, row, result, size) computing
+//result[j] = add(result[j], multiply(weight, row[j])) for a row slice, which is the inner loop of semiringMultiply
+
+namespace MatrixKernels {
+
+///@brief Computes result[j] = add(result[j], multiply(weight, row[j])) element by element
+template<typename Semiring, typename T>
+void semiringAccumulate(T weight, const T* row, T* result, int size) {
+    if(weight == Semiring::zero())
+    {
+        return;
+    }
+    for(int index = 0; index < size; index++)
+    {
+        result[index] = Semiring::add(result[index], Semiring::multiply(weight, row[index]));
+    }
+}
+
+}
+
+///@brief Ordinary arithmetic, semiringMultiply() with it computes the same product as gemm()
+template<typename T>
+struct PlusTimes {
+    using value_type = T;
+    static T zero() {return T(0);};
+    static T one() {return T(1);};
+    static T add(T lhs, T rhs) {return lhs + rhs;};
+    static T multiply(T lhs, T rhs) {return lhs * rhs;};
+    static void accumulate(T weight, const T* row, T* result, int size) {
+        MatrixKernels::axpy(weight, row, result, size);
+    };
+};
+
+///@brief Tropical semiring of shortest paths, add is minimum and multiply is sum
+///@note Zero is infinity, or max() for types without infinity. Sums with an integer max() operand stay max(),
+/// so missing edges never overflow into short paths. float and int rows use dispatched SIMD kernels.
+template<typename T>
+struct MinPlus {
+    using value_type = T;
+    static T zero() {
+        if constexpr(std::numeric_limits<T>::has_infinity)
+        {
+            return std::numeric_limits<T>::infinity();
+        }
+        else
+        {
+            return std::numeric_limits<T>::max();
+        }
+    };
+    static T one() {return T(0);};
+    static T add(T lhs, T rhs) {return std::min(lhs, rhs);};
+    static T multiply(T lhs, T rhs) {
+        if constexpr(!std::numeric_limits<T>::has_infinity)
+        {
+            if(lhs == zero() || rhs == zero())
+            {
+                return zero();
+            }
+        }
+        return lhs + rhs;
+    };
+    static void accumulate(T weight, const T* row, T* result, int size) {
+        if constexpr(std::is_same_v<T, float>)
+        {
+            cpuKernels().minPlusFloat(weight, row, result, size);
+        }
+        else if constexpr(std::is_same_v<T, int>)
+        {
+            cpuKernels().minPlusInt(weight, row, result, size);
+        }
+        else
+        {
+            MatrixKernels::semiringAccumulate<MinPlus<T>>(weight, row, result, size);
+        }
+    };
+};
+
+///@brief Tropical semiring of longest paths, add is maximum and multiply is sum
+///@note Zero is minus infinity, or lowest() for types without infinity, and integer sums with it stay lowest()
+template<typename T>
+struct MaxPlus {
+    using value_type = T;
+    static T zero() {
+        if constexpr(std::numeric_limits<T>::has_infinity)
+        {
+            return -std::numeric_limits<T>::infinity();
+        }
+        else
+        {
+            return std::numeric_limits<T>::lowest();
+        }
+    };
+    static T one() {return T(0);};
+    static T add(T lhs, T rhs) {return std::max(lhs, rhs);};
+    static T multiply(T lhs, T rhs) {
+        if constexpr(!std::numeric_limits<T>::has_infinity)
+        {
+            if(lhs == zero() || rhs == zero())
+            {
+                return zero();
+            }
+        }
+        return lhs + rhs;
+    };
+    static void accumulate(T weight, const T* row, T* result, int size) {
+        MatrixKernels::semiringAccumulate<MaxPlus<T>>(weight, row, result, size);
+    };
+};
+
+///@brief Boolean semiring of reachability over numeric elements, add is OR and multiply is AND
+///@note Bit-packed Matrix<bool> has its own booleanMultiply() and transitiveClosure()
+template<typename T>
+struct OrAnd {
+    using value_type = T;
+    static T zero() {return T(0);};
+    static T one() {return T(1);};
+    static T add(T lhs, T rhs) {return lhs != T(0) || rhs != T(0) ? T(1) : T(0);};
+    static T multiply(T lhs, T rhs) {return lhs != T(0) && rhs != T(0) ? T(1) : T(0);};
+    static void accumulate(T weight, const T* row, T* result, int size) {
+        if(weight == T(0))
+        {
+            return;
+        }
+        for(int index = 0; index < size; index++)
+        {
+            result[index] = result[index] != T(0) || row[index] != T(0) ? T(1) : T(0);
+        }
+    };
+};
+
+///@brief Computes product C = A * B with add and multiply of Semiring
+///@note Uses the cache blocking of gemm(), row blocks of C run on ThreadPool
+///@param a Left operand
+///@param b Right operand with as many rows as A has columns
+///@param c Result with as many rows as A and as many columns as B, must not share data with operands
+template<typename Semiring, typename T>
+void semiringMultiply(Matrix<T>& a, Matrix<T>& b, Matrix<T>& c) {
+    static_assert(std::is_same_v<typename Semiring::value_type, T>, "semiringMultiply - semiring of other element type");
+    MATRIX_TRACE_SCOPE("semiringMultiply", c.getRowCount(), c.getColumnCount(),
+                       (static_cast<std::int64_t>(a.getSize()) + b.getSize() + 2 * c.getSize()) * sizeof(T));
+    MatrixIndex m = a.getRowCount();
+    MatrixIndex k = a.getColumnCount();
+    MatrixIndex n = b.getColumnCount();
+    if(b.getRowCount() != k || c.getRowCount() != m || c.getColumnCount() != n)
+    {
+        throw std::invalid_argument("semiringMultiply - matrix dimensions do not match");
+    }
+    const T* aData = a.cbegin();
+    const T* bData = b.cbegin();
+    T* cData = c.begin();
+    if(cData == aData || cData == bData)
+    {
+        throw std::invalid_argument("semiringMultiply - result must not share data with operands");
+    }
+    constexpr int blockM = 64;
+    ThreadPool::instance().parallelFor(0, m, blockM, [&](MatrixIndex rowBegin, MatrixIndex rowEnd) {
+        std::fill(cData + rowBegin * n, cData + rowEnd * n, Semiring::zero());
+        MatrixKernels::blockedGemm(rowEnd - rowBegin, n, k, aData + rowBegin * k, k, bData, n, cData + rowBegin * n, n,
+                                   [](T weight, const T* bRow, T* cRow, int width) {
+            Semiring::accumulate(weight, bRow, cRow, width);
+        });
+    });
+}
+
+///@brief Computes closure I + A + A^2 + ... of square matrix with add and multiply of Semiring
+///@note Starts from I + A and squares it, after s squarings paths of up to 2^s edges are covered, so at most
+/// ceil(log2(n - 1)) products are needed. Squaring stops early once the result no longer changes.
+/// Min-plus closure gives all-pairs shortest path lengths when there are no negative cycles,
+/// Boolean closure gives reflexive transitive reachability.
+template<typename Semiring, typename T>
+Matrix<T> semiringClosure(Matrix<T>& a) {
+    MatrixIndex n = a.getRowCount();
+    if(a.getColumnCount() != n)
+    {
+        throw std::invalid_argument("semiringClosure - matrix is not square");
+    }
+    MATRIX_TRACE_SCOPE("semiringClosure", n, n, static_cast<std::int64_t>(a.getSize()) * sizeof(T));
+    Matrix<T> result = a;
+    for(MatrixIndex index = 0; index < n; index++)
+    {
+        result.at(index, index) = Semiring::add(result.at(index, index), Semiring::one());
+    }
+    Matrix<T> square(n, n);
+    for(MatrixIndex pathLength = 1; pathLength < n - 1; pathLength *= 2)
+    {
+        semiringMultiply<Semiring>(result, result, square);
+        if(square == result)
+        {
+            break;
+        }
+        result.swap(square);
+    }
+    return result;
+}
+
+///@brief Computes lengths of shortest paths between all pairs of vertices
+///@param weights Edge lengths, weights(i, j) is the edge from i to j and MinPlus<T>::zero() marks a missing edge
+///@retval Path lengths, MinPlus<T>::zero() for unreachable pairs
+template<typename T>
+Matrix<T> shortestPaths(Matrix<T>& weights) {
+    return semiringClosure<MinPlus<T>>(weights);
+}
+
+///@brief Computes reflexive transitive closure of bit-packed adjacency matrix
+///@note Repeated squaring as in semiringClosure(), each product is a word-wide booleanMultiply()
+inline Matrix<bool> transitiveClosure(Matrix<bool>& adjacency) {
+    MatrixIndex n = adjacency.getRowCount();
+    if(adjacency.getColumnCount() != n)
+    {
+        throw std::invalid_argument("transitiveClosure - matrix is not square");
+    }
+    MATRIX_TRACE_SCOPE("transitiveClosure", n, n, static_cast<std::int64_t>(n) * adjacency.getRowWordCount() * 8);
+    Matrix<bool> result = adjacency;
+    for(MatrixIndex index = 0; index < n; index++)
+    {
+        result.at(index, index) = true;
+    }
+    Matrix<bool> square(n, n);
+    for(MatrixIndex pathLength = 1; pathLength < n - 1; pathLength *= 2)
+    {
+        booleanMultiply(result, result, square);
+        if(square == result)
+        {
+            break;
+        }
+        result.swap(square);
+    }
+    return result;
+}
+
+#endif //MATRIX_SEMIRING_H
@@ -0,0 +1,236 @@
+#ifndef MATRIX_THREADPOOL_H
+#define MATRIX_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///@brief Work-stealing thread pool used by parallel matrix algorithms
+///@note Every worker owns a task deque. Owners take tasks from the front of their deque,
+/// idle workers steal from the back of other deques, so uneven chunk costs balance out.
+/// Threads waiting in parallelFor() help executing queued tasks instead of blocking,
+/// which makes nested parallelFor() calls safe.
+class ThreadPool {
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    std::atomic<int> pendingTasks;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+
+    bool popTask(unsigned queueIndex, std::function<void()>& task);
+    bool stealTask(unsigned thiefIndex, std::function<void()>& task);
+    bool runPendingTask(unsigned queueIndex);
+    void workerLoop(unsigned queueIndex);
+    void push(unsigned queueIndex, std::function<void()> task);
+
+public:
+    explicit ThreadPool(unsigned threadCount);
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+    ~ThreadPool();
+
+    static ThreadPool& instance();
+    unsigned getThreadCount();
+
+    template<typename Function>
+    void parallelFor(std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain, Function body);
+};
+
+///@brief Creates pool with specified amount of worker threads
+///@param threadCount Amount of worker threads, zero makes every parallelFor() run on calling thread
+inline ThreadPool::ThreadPool(unsigned threadCount) :
+        pendingTasks(0),
+        nextQueue(0),
+        stopping(false)
+{
+    //One extra queue is shared by threads that are not pool workers
+    for(unsigned i = 0; i <= threadCount; i++)
+    {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for(unsigned i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCondition.notify_all();
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+///@brief Gets process-wide pool sized to hardware concurrency
+///@note Calling thread participates in parallelFor(), so one worker less than core count is started
+inline ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+///@brief Gets amount of threads that execute parallelFor() chunks, including calling thread
+inline unsigned ThreadPool::getThreadCount() {
+    return static_cast<unsigned>(workers.size()) + 1;
+}
+
+inline bool ThreadPool::popTask(unsigned queueIndex, std::function<void()>& task) {
+    WorkQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+inline bool ThreadPool::stealTask(unsigned thiefIndex, std::function<void()>& task) {
+    unsigned queueCount = static_cast<unsigned>(queues.size());
+    for(unsigned offset = 1; offset < queueCount; offset++)
+    {
+        WorkQueue& queue = *queues[(thiefIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+///@brief Runs one task from own queue or stolen from other queue
+///@retval True if a task was executed
+inline bool ThreadPool::runPendingTask(unsigned queueIndex) {
+    std::function<void()> task;
+    if(popTask(queueIndex, task) || stealTask(queueIndex, task))
+    {
+        pendingTasks--;
+        task();
+        return true;
+    }
+    return false;
+}
+
+inline void ThreadPool::workerLoop(unsigned queueIndex) {
+    while(true)
+    {
+        if(runPendingTask(queueIndex))
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this]() { return stopping || pendingTasks.load() > 0; });
+        if(stopping)
+        {
+            return;
+        }
+    }
+}
+
+inline void ThreadPool::push(unsigned queueIndex, std::function<void()> task) {
+    {
+        WorkQueue& queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingTasks++;
+    }
+    sleepCondition.notify_one();
+}
+
+///@brief Calls body(chunkBegin, chunkEnd) for consecutive chunks covering [begin, end)
+///@note Blocks until every chunk has been processed, first exception thrown by body is rethrown
+///@param begin First index of the range
+///@param end Index past the last index of the range
+///@param grain Maximum amount of indexes in one chunk
+///@param body Callable taking chunk bounds as std::ptrdiff_t
+template<typename Function>
+void ThreadPool::parallelFor(std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain, Function body) {
+    if(end <= begin)
+    {
+        return;
+    }
+    grain = std::max<std::ptrdiff_t>(1, grain);
+    std::ptrdiff_t chunkCount = (end - begin + grain - 1) / grain;
+    if(chunkCount == 1 || workers.empty())
+    {
+        for(std::ptrdiff_t chunkBegin = begin; chunkBegin < end; chunkBegin += grain)
+        {
+            body(chunkBegin, std::min(end, chunkBegin + grain));
+        }
+        return;
+    }
+
+    std::atomic<std::ptrdiff_t> remaining(chunkCount);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    //Chunks are dealt to worker queues in contiguous runs to keep neighbouring chunks on one core
+    unsigned queueCount = static_cast<unsigned>(workers.size());
+    unsigned firstQueue = nextQueue++ % queueCount;
+    std::ptrdiff_t chunksPerQueue = (chunkCount + static_cast<std::ptrdiff_t>(queueCount) - 1) / static_cast<std::ptrdiff_t>(queueCount);
+    for(std::ptrdiff_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        std::ptrdiff_t chunkBegin = begin + chunk * grain;
+        std::ptrdiff_t chunkEnd = std::min(end, chunkBegin + grain);
+        push((firstQueue + static_cast<unsigned>(chunk / chunksPerQueue)) % queueCount,
+             [&body, &remaining, &error, &errorMutex, chunkBegin, chunkEnd]() {
+            try
+            {
+                body(chunkBegin, chunkEnd);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+            remaining--;
+        });
+    }
+
+    //Calling thread steals work until all chunks of this call are done
+    unsigned helperQueue = static_cast<unsigned>(workers.size());
+    while(remaining.load() > 0)
+    {
+        if(!runPendingTask(helperQueue))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif //MATRIX_THREADPOOL_H
@@ -0,0 +1,464 @@
+#include <Matrix.h>
+#include <MatrixAlgebra.h>
+#include <Convolution.h>
+#include <MatrixBatch.h>
+#include <Semiring.h>
+#include <OutOfCoreMatrix.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//Build with CMAKE_BUILD_TYPE=Release for meaningful numbers.
+//Pass a substring as first argument to run only benchmarks whose name contains it.
+
+///@brief Runs body repeatedly for at least minimumSeconds and returns mean seconds per run
+template<typename Function>
+static double measure(Function body, double minimumSeconds = 0.2) {
+    using clock = std::chrono::steady_clock;
+    body(); //Warm-up run touches every page and fills caches
+    int iterations = 0;
+    auto start = clock::now();
+    double elapsed = 0;
+    do
+    {
+        body();
+        iterations++;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while(elapsed < minimumSeconds);
+    return elapsed / iterations;
+}
+
+///@brief Counts data TLB load misses of this thread, reports -1 when perf events are unavailable
+class TlbMissCounter {
+private:
+    int descriptor;
+
+public:
+    TlbMissCounter() : descriptor(-1) {
+#ifdef __linux__
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HW_CACHE;
+        attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    };
+    TlbMissCounter(const TlbMissCounter& other) = delete;
+    ~TlbMissCounter() {
+#ifdef __linux__
+        if(descriptor >= 0)
+        {
+            close(descriptor);
+        }
+#endif
+    };
+
+    template<typename Function>
+    long long count(Function body) {
+#ifdef __linux__
+        if(descriptor >= 0)
+        {
+            ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+            body();
+            ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+            long long misses = 0;
+            return read(descriptor, &misses, sizeof(misses)) == sizeof(misses) ? misses : -1;
+        }
+#endif
+        body();
+        return -1;
+    };
+};
+
+static void benchmarkGemv() {
+    std::printf("%-16s %7s %7s %12s %10s\n", "gemv", "rows", "cols", "time, us", "GB/s");
+    for(int size : {64, 256, 1024, 4096})
+    {
+        Matrix<float> a(size, size);
+        a.generate([](int row, int col) {return static_cast<float>((row + col) % 7) * 0.25f;});
+        std::vector<float> x(size, 1.0f);
+        std::vector<float> y(size, 0.0f);
+        //Matrix is read once, x is read and y is written per product
+        double bytes = (static_cast<double>(size) * size + 2.0 * size) * sizeof(float);
+
+        double seconds = measure([&]() {gemv(a, x, y, 1.0f, 0.0f);});
+        std::printf("%-16s %7d %7d %12.2f %10.2f\n", "A*x", size, size, seconds * 1e6, bytes / seconds * 1e-9);
+
+        seconds = measure([&]() {gemvTransposed(a, x, y, 1.0f, 0.0f);});
+        std::printf("%-16s %7d %7d %12.2f %10.2f\n", "A^T*x", size, size, seconds * 1e6, bytes / seconds * 1e-9);
+    }
+}
+
+static void benchmarkStrassen() {
+    //One recursion level (cutoff n/2) against blocked GEMM shows the crossover size,
+    //full recursion down to strassenCutoff shows the tuned configuration
+    std::printf("%-16s %7s %12s %12s %12s %12s\n", "strassen", "n", "gemm, ms", "1 level, ms", "tuned, ms",
+                "rel. error");
+    for(int size : {128, 256, 512, 1024, 2048})
+    {
+        Matrix<float> a(size, size);
+        Matrix<float> b(size, size);
+        a.generate([](int row, int col) {return std::sin(static_cast<float>(row * 7 + col));});
+        b.generate([](int row, int col) {return std::cos(static_cast<float>(row + col * 3));});
+        Matrix<float> reference(size, size);
+        Matrix<float> result(size, size);
+
+        double gemmSeconds = measure([&]() {gemm(a, b, reference);});
+        double oneLevelSeconds = measure([&]() {strassenMultiply(a, b, result, size / 2);});
+        double tunedSeconds = measure([&]() {strassenMultiply(a, b, result);});
+
+        float maxError = 0;
+        float maxValue = 0;
+        for(auto expected = reference.cbegin(), actual = result.cbegin(); expected != reference.cend(); expected++, actual++)
+        {
+            maxError = std::max(maxError, std::abs(*expected - *actual));
+            maxValue = std::max(maxValue, std::abs(*expected));
+        }
+        std::printf("%-16s %7d %12.2f %12.2f %12.2f %12.2e\n", "A*B", size, gemmSeconds * 1e3, oneLevelSeconds * 1e3,
+                    tunedSeconds * 1e3, maxError / maxValue);
+    }
+}
+
+static void benchmarkConvolution() {
+    //Naive loop reads source through at() with zero border, as hand-written filters did
+    std::printf("%-16s %7s %7s %12s %12s\n", "convolution", "n", "kernel", "naive, ms", "tiled, ms");
+    int size = 1024;
+    Matrix<float> source(size, size);
+    source.generate([](int row, int col) {return static_cast<float>((row * 3 + col) % 17);});
+    Matrix<float> destination(size, size);
+    for(int kernelSize : {3, 5, 11})
+    {
+        for(bool separable : {false, true})
+        {
+            Matrix<float> kernel(kernelSize, kernelSize);
+            kernel.generate([separable](int row, int col) {
+                return separable ? (1.0f + row) * (2.0f + col) : static_cast<float>((row * 5 + col * 3) % 7) - 3.0f;
+            });
+            double naiveSeconds = measure([&]() {
+                int radius = kernelSize / 2;
+                for(int row = 0; row < size; row++)
+                {
+                    for(int col = 0; col < size; col++)
+                    {
+                        float sum = 0;
+                        for(int i = 0; i < kernelSize; i++)
+                        {
+                            for(int j = 0; j < kernelSize; j++)
+                            {
+                                int sourceRow = row + i - radius;
+                                int sourceCol = col + j - radius;
+                                if(sourceRow >= 0 && sourceRow < size && sourceCol >= 0 && sourceCol < size)
+                                {
+                                    sum += kernel.at(i, j) * source.at(sourceRow, sourceCol);
+                                }
+                            }
+                        }
+                        destination.at(row, col) = sum;
+                    }
+                }
+            });
+            double tiledSeconds = measure([&]() {convolve(source, kernel, destination);});
+            std::printf("%-16s %7d %4dx%-2d %12.2f %12.2f\n", separable ? "separable" : "general", size, kernelSize,
+                        kernelSize, naiveSeconds * 1e3, tiledSeconds * 1e3);
+        }
+    }
+}
+
+static void benchmarkHugePages() {
+    //Walking down the first columns reads one cache line per row, so data stays in L2 cache
+    //while every access lands on a different 4 KB page, and 32 rows share one 2 MB page
+    std::printf("%-16s %7s %12s %12s %14s\n", "hugepages", "MB", "init, ms", "walk, ms", "dTLB misses");
+    //Row length is not a power of two, so rows of physically contiguous huge pages do not alias in cache sets
+    int size = 8192;
+    int rowLength = size + 8;
+    std::size_t count = static_cast<std::size_t>(size) * rowLength;
+    int walkRepetitions = 64;
+    TlbMissCounter counter;
+    auto walk = [&](const double* data) {
+        double sum = 0;
+        for(int repetition = 0; repetition < walkRepetitions; repetition++)
+        {
+            for(int row = 0; row < size; row++)
+            {
+                sum += data[static_cast<std::size_t>(row) * rowLength + repetition % 8];
+            }
+        }
+        if(sum != 0)
+        {
+            std::printf("unexpected sum\n");
+        }
+    };
+    auto report = [&](const char* name, double initSeconds, const double* data) {
+        walk(data);
+        double walkSeconds = 0;
+        long long misses = counter.count([&]() {
+            auto start = std::chrono::steady_clock::now();
+            walk(data);
+            walkSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        });
+        std::string missText = misses < 0 ? "n/a" : std::to_string(misses);
+        std::printf("%-16s %7zu %12.2f %12.2f %14s\n", name, count * sizeof(double) >> 20, initSeconds * 1e3,
+                    walkSeconds * 1e3, missText.c_str());
+    };
+
+    {
+        //Former MatrixImpl path: new T[] followed by single-threaded initialization
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<double[]> plain(new double[count]);
+        std::fill(plain.get(), plain.get() + count, 0.0);
+        double initSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report("new[] + fill", initSeconds, plain.get());
+    }
+    {
+        auto start = std::chrono::steady_clock::now();
+        Matrix<double> matrix(size, rowLength);
+        double initSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report("Matrix", initSeconds, matrix.cbegin());
+    }
+}
+
+static void benchmarkBatch() {
+    //Per-object loop multiplies and inverts Matrix objects one by one, as callers without batches do
+    std::printf("%-16s %7s %9s %14s %14s\n", "batch", "n", "count", "objects, ns", "batch, ns");
+    int count = 1 << 18;
+    for(int n : {3, 4})
+    {
+        std::vector<Matrix<float>> matrices;
+        for(int index = 0; index < count; index++)
+        {
+            matrices.emplace_back(n, n);
+            matrices.back().generate([index, n](int row, int col) {
+                return static_cast<float>((index + row * 3 + col) % 11) + (row == col ? 2.0f * n * 11 : 0.0f);
+            });
+        }
+        std::vector<Matrix<float>> products;
+        for(int index = 0; index < count; index++)
+        {
+            products.emplace_back(n, n);
+        }
+        MatrixBatch<float> batch(matrices);
+        MatrixBatch<float> result(count, n, n);
+
+        double objectSeconds = measure([&]() {
+            for(int index = 0; index < count; index++)
+            {
+                gemm(matrices[index], matrices[index], products[index]);
+            }
+        });
+        double batchSeconds = measure([&]() {batchMultiply(batch, batch, result);});
+        std::printf("%-16s %7d %9d %14.2f %14.2f\n", "multiply", n, count, objectSeconds / count * 1e9,
+                    batchSeconds / count * 1e9);
+
+        objectSeconds = measure([&]() {
+            for(int index = 0; index < count; index++)
+            {
+                //Gauss-Jordan elimination through at(), partial pivoting is skipped for dominant diagonals
+                Matrix<float>& a = matrices[index];
+                Matrix<float>& inverse = products[index];
+                float work[16];
+                std::copy(a.cbegin(), a.cend(), work);
+                inverse.fill(0.0f);
+                for(int i = 0; i < n; i++)
+                {
+                    inverse.at(i, i) = 1.0f;
+                }
+                for(int column = 0; column < n; column++)
+                {
+                    float scale = 1.0f / work[column * n + column];
+                    for(int j = 0; j < n; j++)
+                    {
+                        work[column * n + j] *= scale;
+                        inverse.at(column, j) *= scale;
+                    }
+                    for(int row = 0; row < n; row++)
+                    {
+                        float factor = row == column ? 0.0f : work[row * n + column];
+                        for(int j = 0; j < n; j++)
+                        {
+                            work[row * n + j] -= factor * work[column * n + j];
+                            inverse.at(row, j) -= factor * inverse.at(column, j);
+                        }
+                    }
+                }
+            }
+        });
+        batchSeconds = measure([&]() {batchInverse(batch, result);});
+        std::printf("%-16s %7d %9d %14.2f %14.2f\n", "inverse", n, count, objectSeconds / count * 1e9,
+                    batchSeconds / count * 1e9);
+    }
+}
+
+static void benchmarkBits() {
+    //Byte loop keeps one char per element and ORs byte rows, as adjacency matrices were stored before
+    std::printf("%-16s %7s %14s %14s %10s\n", "bits", "n", "bytes, ms", "bits, ms", "memory");
+    for(int n : {512, 2048})
+    {
+        Matrix<char> bytes(n, n);
+        bytes.generate([](int row, int col) {return static_cast<char>((row * 7 + col * 13) % 29 == 0);});
+        Matrix<bool> bits(n, n);
+        for(int row = 0; row < n; row++)
+        {
+            for(int col = 0; col < n; col++)
+            {
+                bits.at(row, col) = bytes.at(row, col) != 0;
+            }
+        }
+        Matrix<char> byteProduct(n, n);
+        Matrix<bool> bitProduct(n, n);
+        double byteSeconds = measure([&]() {
+            const char* a = bytes.cbegin();
+            char* c = byteProduct.begin();
+            std::fill(c, c + n * n, 0);
+            for(int i = 0; i < n; i++)
+            {
+                for(int k = 0; k < n; k++)
+                {
+                    if(a[i * n + k] != 0)
+                    {
+                        for(int j = 0; j < n; j++)
+                        {
+                            c[i * n + j] |= a[k * n + j];
+                        }
+                    }
+                }
+            }
+        });
+        double bitSeconds = measure([&]() {booleanMultiply(bits, bits, bitProduct);});
+        std::printf("%-16s %7d %14.2f %14.2f %9.1fx\n", "multiply", n, byteSeconds * 1e3, bitSeconds * 1e3,
+                    static_cast<double>(n) / (bits.getRowWordCount() * sizeof(std::uint64_t)));
+
+        Matrix<int> byteCounts(n, n);
+        Matrix<int> bitCounts(n, n);
+        byteSeconds = measure([&]() {
+            const char* a = bytes.cbegin();
+            int* c = byteCounts.begin();
+            std::fill(c, c + n * n, 0);
+            for(int i = 0; i < n; i++)
+            {
+                for(int k = 0; k < n; k++)
+                {
+                    int weight = a[i * n + k];
+                    for(int j = 0; j < n; j++)
+                    {
+                        c[i * n + j] += weight * a[k * n + j];
+                    }
+                }
+            }
+        });
+        bitSeconds = measure([&]() {countMultiply(bits, bits, bitCounts);});
+        std::printf("%-16s %7d %14.2f %14.2f\n", "count", n, byteSeconds * 1e3, bitSeconds * 1e3);
+    }
+}
+
+template<typename T>
+static void benchmarkMinPlus(const char* name, int n) {
+    Matrix<T> a(n, n);
+    a.generate([](int row, int col) {return (row * 31 + col * 17) % 7 == 0 ? static_cast<T>((row + col) % 50) :
+                                            MinPlus<T>::zero();});
+    Matrix<T> c(n, n);
+    //Naive loop keeps the running minimum of every element in a register, as hand-written min-plus loops do
+    double naiveSeconds = measure([&]() {
+        const T* data = a.cbegin();
+        T* result = c.begin();
+        for(int i = 0; i < n; i++)
+        {
+            for(int j = 0; j < n; j++)
+            {
+                T best = MinPlus<T>::zero();
+                for(int k = 0; k < n; k++)
+                {
+                    best = MinPlus<T>::add(best, MinPlus<T>::multiply(data[i * n + k], data[k * n + j]));
+                }
+                result[i * n + j] = best;
+            }
+        }
+    });
+    double semiringSeconds = measure([&]() {semiringMultiply<MinPlus<T>>(a, a, c);});
+    std::printf("%-16s %7d %14.2f %14.2f\n", name, n, naiveSeconds * 1e3, semiringSeconds * 1e3);
+}
+
+static void benchmarkSemiring() {
+    std::printf("%-16s %7s %14s %14s\n", "semiring", "n", "naive, ms", "blocked, ms");
+    for(int n : {256, 1024})
+    {
+        benchmarkMinPlus<float>("min-plus float", n);
+        benchmarkMinPlus<int>("min-plus int", n);
+    }
+}
+
+static void benchmarkOutOfCore() {
+    //Cache holds four of the 64 tiles of every operand, so element loops keep evicting tiles
+    constexpr int n = 256;
+    constexpr int tileSize = 32;
+    constexpr std::size_t cacheBytes = 4 * tileSize * tileSize * sizeof(double);
+    std::string directory = std::filesystem::temp_directory_path().string() + "/";
+    Matrix<double> dense(n, n);
+    dense.generate([](int row, int col) {return static_cast<double>((row * 7 + col) % 13);});
+    OutOfCoreMatrix<double> a(dense, directory + "matrixBenchmarks_a.bin", cacheBytes, tileSize);
+    OutOfCoreMatrix<double> b(dense, directory + "matrixBenchmarks_b.bin", cacheBytes, tileSize);
+    OutOfCoreMatrix<double> c(n, n, directory + "matrixBenchmarks_c.bin", cacheBytes, tileSize);
+    double elementSeconds = measure([&]() {
+        for(int i = 0; i < n; i++)
+        {
+            for(int j = 0; j < n; j++)
+            {
+                double sum = 0;
+                for(int k = 0; k < n; k++)
+                {
+                    sum += a.get(i, k) * b.get(k, j);
+                }
+                c.at(i, j) = sum;
+            }
+        }
+    });
+    double tiledSeconds = measure([&]() {gemm(a, b, c);});
+    std::printf("%-16s %7s %14s %14s\n", "out-of-core", "n", "element, ms", "tiled, ms");
+    std::printf("%-16s %7d %14.2f %14.2f\n", "gemm double", n, elementSeconds * 1e3, tiledSeconds * 1e3);
+    for(const char* name : {"matrixBenchmarks_a.bin", "matrixBenchmarks_b.bin", "matrixBenchmarks_c.bin"})
+    {
+        std::filesystem::remove(directory + name);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::pair<std::string, std::function<void()>>> benchmarks = {
+            {"gemv", benchmarkGemv},
+            {"strassen", benchmarkStrassen},
+            {"convolution", benchmarkConvolution},
+            {"hugepages", benchmarkHugePages},
+            {"batch", benchmarkBatch},
+            {"bits", benchmarkBits},
+            {"semiring", benchmarkSemiring},
+            {"outofcore", benchmarkOutOfCore},
+    };
+    std::string filter = argc > 1 ? argv[1] : "";
+    for(auto& [name, benchmark] : benchmarks)
+    {
+        if(name.find(filter) != std::string::npos)
+        {
+            benchmark();
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
@@ -1,6 +1,30 @@
 #include <Matrix.h>
+#include <MatrixAlgebra.h>
+#include <ReducedPrecision.h>
+#include <MatrixPool.h>
+#include <MatrixProduct.h>
+#include <ChunkedMatrix.h>
+#include <PermutedMatrix.h>
+#include <Convolution.h>
+#include <CpuDispatch.h>
+#include <MatrixTrace.h>
+#include <RowAggregate.h>
+#include <MatrixBatch.h>
+#include <PackedMatrix.h>
+#include <Semiring.h>
+#include <OutOfCoreMatrix.h>
+#include <RowBandPartition.h>
 #include <gtest/gtest.h>
 #include <vector>
+#include <numeric>
+#include <unordered_set>
+#include <thread>
+#include <random>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <limits>
+#include <unistd.h>
 
 class MatrixTest : public ::testing::Test {
 protected:
@@ -48,6 +72,17 @@ TEST_F(MatrixTest,ElementAccess)
     }
 }
 
+TEST_F(MatrixTest, ElementAccessOutOfRange)
+{
+    EXPECT_THROW(matrix3x3.at(-1,0), std::out_of_range);
+    EXPECT_THROW(matrix3x3.at(0,-1), std::out_of_range);
+    EXPECT_THROW(matrix3x3.at(3,0), std::out_of_range);
+    EXPECT_THROW(matrix3x3.ptrAt(-1,0), std::out_of_range);
+    EXPECT_THROW(matrix3x3.ptrAt(0,-1), std::out_of_range);
+    EXPECT_THROW(matrix3x3.ptrAt(0,3), std::out_of_range);
+    EXPECT_EQ(matrix3x3.at(2,2),9);
+}
+
 TEST_F(MatrixTest, RowIteratorAccessPtr)
 {
     Matrix<int>::rowIterator iter =matrix3x3.beginRow();
@@ -181,6 +216,33 @@ TEST_F(MatrixTest, ColumnIteratorAccessConst)
     EXPECT_EQ(iter,matrix3x3.endConstColumn());
 }
 
+TEST(MatrixConstIteratorTest, ReadingDoesNotDetachOrMarkRows)
+{
+    Matrix<int> original(2,3);
+    original.generate([](int row, int col) {return row * 3 + col;});
+    Matrix<int> shared = original;
+    RowAggregate sums(shared, [](std::span<const int> row) {return std::accumulate(row.begin(), row.end(), 0);});
+    sums.update();
+
+    int total = 0;
+    for(auto iter = shared.beginConstRow(); iter != shared.endConstRow(); iter++)
+    {
+        for(const int& value : *iter)
+        {
+            total += value;
+        }
+    }
+    Matrix<int>::const_columnIterator column = shared.beginConstColumn();
+    ++column;
+    ASSERT_EQ((*column).size(), 2);
+    EXPECT_EQ((*column)[1].get(), 4);
+    EXPECT_EQ(*column.operator->()[1], 4);
+    EXPECT_EQ(total, 15);
+    EXPECT_EQ(shared.cbegin(), original.cbegin());
+    sums.update();
+    EXPECT_EQ(sums.getRecomputedRowCount(), 0);
+}
+
 TEST_F(MatrixTest, RefCounter)
 {
     Matrix<int> copy = Matrix(matrix3x3);
@@ -225,6 +287,63 @@ TEST_F(MatrixTest,Swap)
     EXPECT_EQ(matrix3x3.at(0,0),100);
 }
 
+TEST_F(MatrixTest, EmptyHandlesShareData)
+{
+    Matrix<int> first;
+    Matrix<int> second;
+    EXPECT_EQ(first.getRowCount(), 0);
+    EXPECT_EQ(first.getColumnCount(), 0);
+    EXPECT_EQ(first.cbegin(), second.cbegin());
+
+    const int* storage = matrix3x3.cbegin();
+    Matrix<int> moved(std::move(matrix3x3));
+    EXPECT_EQ(moved.cbegin(), storage);
+    EXPECT_EQ(moved.refCount(), 1);
+    EXPECT_EQ(matrix3x3.getSize(), 0);
+    EXPECT_EQ(matrix3x3.cbegin(), first.cbegin());
+    EXPECT_THROW(matrix3x3.at(0,0), std::out_of_range);
+
+    Matrix<int> copy = moved;
+    first = std::move(moved);
+    EXPECT_EQ(first.cbegin(), storage);
+    EXPECT_EQ(first.refCount(), 2);
+    EXPECT_EQ(moved.getSize(), 0);
+    Matrix<int>& self = first;
+    first = std::move(self);
+    EXPECT_EQ(first.at(2,2), 9);
+    copy = Matrix<int>();
+    EXPECT_EQ(first.refCount(), 1);
+
+    //Writes to empty data detach, other empty handles are unaffected
+    second.resize(2, 2, 7);
+    EXPECT_EQ(second.at(1,1), 7);
+    EXPECT_EQ(copy.getSize(), 0);
+    EXPECT_NE(second.cbegin(), copy.cbegin());
+
+    std::vector<Matrix<int>> matrices;
+    std::vector<const int*> storages;
+    for(int index = 0; index < 100; index++)
+    {
+        matrices.emplace_back(index + 1, 1);
+        storages.push_back(matrices.back().cbegin());
+    }
+    matrices.resize(300);
+    std::reverse(matrices.begin(), matrices.end());
+    for(int index = 0; index < 100; index++)
+    {
+        EXPECT_EQ(matrices[299 - index].cbegin(), storages[index]);
+        EXPECT_EQ(matrices[299 - index].refCount(), 1);
+    }
+    EXPECT_EQ(matrices[0].cbegin(), copy.cbegin());
+
+    Matrix<bool> bits(3, 70);
+    bits.at(2, 69) = true;
+    Matrix<bool> movedBits(std::move(bits));
+    EXPECT_TRUE(movedBits.test(2, 69));
+    EXPECT_EQ(bits.getColumnCount(), 0);
+    EXPECT_EQ(bits.getSize(), 0);
+}
+
 TEST_F(MatrixTest, InsertRowValue)
 {
     std::vector<int> row;
@@ -391,4 +510,2303 @@ TEST_F(MatrixTest,RemoveColumnByIter)
     EXPECT_EQ(matrix3x3.at(0,1),3);
     EXPECT_EQ(matrix3x3.at(1,1),6);
     EXPECT_EQ(matrix3x3.at(2,1),9);
-}
\ No newline at end of file
+}
+
+TEST_F(MatrixTest, Fill)
+{
+    Matrix<int> copy = Matrix(matrix3x3);
+    matrix3x3.fill(7);
+    for(int row = 0; row < matrix3x3.getRowCount(); row++)
+    {
+        for(int col = 0; col < matrix3x3.getColumnCount(); col++)
+        {
+            EXPECT_EQ(matrix3x3.at(row,col),7);
+        }
+    }
+    EXPECT_EQ(copy.at(0,0),1);
+}
+
+TEST_F(MatrixTest, Generate)
+{
+    Matrix<int> large(300,500);
+    large.generate([](int row, int col) {return row * 1000 + col;});
+    EXPECT_EQ(large.at(0,0),0);
+    EXPECT_EQ(large.at(17,42),17042);
+    EXPECT_EQ(large.at(299,499),299499);
+}
+
+TEST_F(MatrixTest, ParallelForEach)
+{
+    matrixVectors.parallelForEach([](std::vector<int>& element) {element.push_back(element.at(0) * 2);});
+    int i = 1;
+    for(int row = 0; row < matrixVectors.getRowCount(); row++)
+    {
+        for(int col = 0; col < matrixVectors.getColumnCount(); col++)
+        {
+            EXPECT_EQ(matrixVectors.at(row,col).size(),2);
+            EXPECT_EQ(matrixVectors.at(row,col).at(1),i * 2);
+            i++;
+        }
+    }
+}
+
+TEST_F(MatrixTest, ParallelTransform)
+{
+    Matrix<int> large(400,400);
+    large.fill(3);
+    large.parallelTransform([](int element) {return element * element;});
+    EXPECT_EQ(large.at(0,0),9);
+    EXPECT_EQ(large.at(399,399),9);
+
+    Matrix<double> halves(3,3);
+    halves.parallelTransform(matrix3x3, [](int element) {return element / 2.0;});
+    EXPECT_DOUBLE_EQ(halves.at(0,0),0.5);
+    EXPECT_DOUBLE_EQ(halves.at(2,2),4.5);
+
+    Matrix<double> wrongSize(2,3);
+    EXPECT_THROW(wrongSize.parallelTransform(matrix3x3, [](int element) {return element;}), std::invalid_argument);
+}
+
+#ifdef MATRIX_HAS_EXECUTION_POLICIES
+TEST_F(MatrixTest, ParallelForEachPolicy)
+{
+    matrix3x3.parallelForEach(std::execution::par_unseq, [](int& element) {element += 10;});
+    matrix3x3.parallelTransform(std::execution::par, [](int element) {return element * 2;});
+    EXPECT_EQ(matrix3x3.at(0,0),22);
+    EXPECT_EQ(matrix3x3.at(2,2),38);
+}
+#endif
+
+TEST(ThreadPoolTest, ParallelForCoversRangeAndRethrows)
+{
+    ThreadPool pool(3);
+    std::vector<int> visits(1000, 0);
+    pool.parallelFor(0, 1000, 7, [&visits](int begin, int end) {
+        for(int i = begin; i < end; i++)
+        {
+            visits[i]++;
+        }
+    });
+    EXPECT_EQ(std::count(visits.begin(), visits.end(), 1), 1000);
+
+    EXPECT_THROW(pool.parallelFor(0, 100, 1, [](int begin, int) {
+        if(begin == 50)
+        {
+            throw std::runtime_error("chunk failure");
+        }
+    }), std::runtime_error);
+}
+
+static_assert(std::contiguous_iterator<Matrix<int>::iterator>);
+static_assert(std::contiguous_iterator<Matrix<int>::const_iterator>);
+
+TEST_F(MatrixTest, FlatIteratorAlgorithms)
+{
+    Matrix<int> copy = Matrix(matrix3x3);
+    std::sort(matrix3x3.begin(), matrix3x3.end(), std::greater<int>());
+    EXPECT_EQ(matrix3x3.at(0,0),9);
+    EXPECT_EQ(matrix3x3.at(2,2),1);
+    EXPECT_EQ(copy.at(0,0),1);
+
+    EXPECT_EQ(std::reduce(copy.cbegin(), copy.cend()),45);
+    EXPECT_EQ(copy.cend() - copy.cbegin(),9);
+
+    std::ranges::transform(copy, copy.begin(), [](int element) {return element + 1;});
+    EXPECT_EQ(copy.at(1,1),6);
+}
+
+TEST_F(MatrixTest, RowAndColumnViews)
+{
+    auto rows = matrix3x3.rows();
+    static_assert(std::ranges::view<decltype(rows)>);
+    static_assert(std::ranges::random_access_range<decltype(rows)>);
+    EXPECT_EQ(std::ranges::distance(rows),3);
+    EXPECT_EQ(rows[1][2],6);
+    rows[1][2] = 60;
+    EXPECT_EQ(matrix3x3.at(1,2),60);
+
+    auto columns = matrix3x3.columns();
+    static_assert(std::ranges::view<decltype(columns)>);
+    int sum = 0;
+    for(int& element : columns[1])
+    {
+        sum += element;
+        element = 0;
+    }
+    EXPECT_EQ(sum,2 + 5 + 8);
+    EXPECT_EQ(matrix3x3.at(2,1),0);
+
+    std::vector<int> columnSums;
+    for(auto column : matrix3x3.constColumns())
+    {
+        columnSums.push_back(std::reduce(column.begin(), column.end()));
+    }
+    EXPECT_EQ(columnSums,(std::vector<int>{12,0,72}));
+    EXPECT_EQ(matrix3x3.constRows()[2].size(),3);
+}
+
+TEST_F(MatrixTest, Gemv)
+{
+    std::vector<int> x{1,0,-1};
+    std::vector<int> y{100,200,300};
+    gemv(matrix3x3, x, y, 2, 1);
+    EXPECT_EQ(y,(std::vector<int>{96,196,296}));
+
+    gemvTransposed(matrix3x3, x, y);
+    EXPECT_EQ(y,(std::vector<int>{-6,-6,-6}));
+
+    std::vector<int> wrongSize(2);
+    EXPECT_THROW(gemv(matrix3x3, wrongSize, y), std::invalid_argument);
+}
+
+TEST_F(MatrixTest, GemvParallelMatchesSerial)
+{
+    Matrix<double> large(300,700);
+    large.generate([](int row, int col) {return (row * 7 + col * 3) % 11 - 5.0;});
+    std::vector<double> x(700);
+    std::vector<double> xt(300);
+    for(int i = 0; i < 700; i++)
+    {
+        x[i] = (i % 5) * 0.5;
+    }
+    for(int i = 0; i < 300; i++)
+    {
+        xt[i] = (i % 3) - 1.0;
+    }
+    std::vector<double> y(300, 1.0);
+    std::vector<double> yt(700, 1.0);
+    gemv(large, x, y, 0.5, 2.0);
+    gemvTransposed(large, xt, yt, 0.5, 2.0);
+
+    for(int row = 0; row < 300; row++)
+    {
+        double expected = 0;
+        for(int col = 0; col < 700; col++)
+        {
+            expected += large.at(row,col) * x[col];
+        }
+        EXPECT_NEAR(y[row],0.5 * expected + 2.0,1e-9);
+    }
+    for(int col = 0; col < 700; col++)
+    {
+        double expected = 0;
+        for(int row = 0; row < 300; row++)
+        {
+            expected += large.at(row,col) * xt[row];
+        }
+        EXPECT_NEAR(yt[col],0.5 * expected + 2.0,1e-9);
+    }
+}
+
+TEST_F(MatrixTest, Gemm)
+{
+    Matrix<int> result(3,3);
+    result.fill(1);
+    gemm(matrix3x3, matrix3x3, result, 1, 2);
+    EXPECT_EQ(result.at(0,0),30 + 2);
+    EXPECT_EQ(result.at(1,2),96 + 2);
+    EXPECT_EQ(result.at(2,1),126 + 2);
+
+    Matrix<int> wrongSize(2,3);
+    EXPECT_THROW(gemm(matrix3x3, wrongSize, result), std::invalid_argument);
+}
+
+TEST_F(MatrixTest, StrassenMatchesGemm)
+{
+    for(int size : {256, 300})
+    {
+        Matrix<long long> a(size,size);
+        Matrix<long long> b(size,size);
+        a.generate([](int row, int col) {return (row * 31 + col * 17) % 23 - 11;});
+        b.generate([](int row, int col) {return (row * 13 + col * 29) % 19 - 9;});
+        Matrix<long long> expected(size,size);
+        Matrix<long long> actual(size,size);
+        gemm(a, b, expected);
+        strassenMultiply(a, b, actual, 32);
+        EXPECT_TRUE(std::equal(actual.cbegin(), actual.cend(), expected.cbegin()));
+    }
+
+    //Concurrent recursion branches use separate scratch regions
+    Matrix<long long> a(128,128);
+    a.generate([](int row, int col) {return (row + 2 * col) % 5;});
+    Matrix<long long> expected(128,128);
+    gemm(a, a, expected);
+    std::vector<long long> scratch(MatrixKernels::strassenScratchSize(128, 16, 2));
+    std::vector<long long> actual(128 * 128);
+    MatrixKernels::strassen(a.cbegin(), 128, a.cbegin(), 128, actual.data(), 128, 128, 16, 2, scratch.data());
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), expected.cbegin()));
+}
+
+TEST(ReducedPrecisionTest, HalfConversion)
+{
+    EXPECT_EQ(Half(1.0f).getBits(),0x3c00);
+    EXPECT_EQ(Half(-2.0f).getBits(),0xc000);
+    EXPECT_EQ(Half(65504.0f).getBits(),0x7bff);
+    EXPECT_EQ(Half(65520.0f).getBits(),0x7c00);
+    EXPECT_EQ(Half(5.960464477539063e-08f).getBits(),0x0001);
+    EXPECT_EQ(Half(1.0f + 1.0f / 2048).getBits(),0x3c00); //Tie rounds to even
+    EXPECT_EQ(Half(1.0f + 3.0f / 2048).getBits(),0x3c02);
+    EXPECT_TRUE(std::isnan(static_cast<float>(Half(std::nanf("")))));
+    for(std::uint32_t bits = 0; bits < 0x7c00; bits++)
+    {
+        Half value = Half::fromBits(static_cast<std::uint16_t>(bits));
+        EXPECT_EQ(Half(static_cast<float>(value)).getBits(),bits);
+    }
+
+    EXPECT_EQ(BFloat16(1.0f).getBits(),0x3f80);
+    EXPECT_FLOAT_EQ(static_cast<float>(BFloat16(3.140625f)),3.140625f);
+    EXPECT_EQ(BFloat16(1.0f + 1.0f / 256).getBits(),0x3f80);
+}
+
+template<typename T>
+static void expectValueEquality()
+{
+    T zero(0.0f);
+    T negativeZero(-0.0f);
+    T nan(std::nanf(""));
+    EXPECT_NE(zero.getBits(),negativeZero.getBits());
+    EXPECT_TRUE(zero == negativeZero);
+    EXPECT_EQ(std::hash<T>()(zero),std::hash<T>()(negativeZero));
+    EXPECT_FALSE(nan == nan);
+    EXPECT_FALSE(T(1.0f) == T(2.0f));
+
+    Matrix<T> zeros(2,3);
+    Matrix<T> negativeZeros(2,3);
+    zeros.fill(zero);
+    negativeZeros.fill(negativeZero);
+    EXPECT_TRUE(zeros == negativeZeros);
+    EXPECT_EQ(zeros.hash(),negativeZeros.hash());
+
+    Matrix<T> nans(2,3);
+    Matrix<T> otherNans(2,3);
+    nans.fill(nan);
+    otherNans.fill(nan);
+    EXPECT_FALSE(nans == otherNans);
+}
+
+TEST(ReducedPrecisionTest, EqualityAndHashFollowValues)
+{
+    expectValueEquality<Half>();
+    expectValueEquality<BFloat16>();
+}
+
+TEST(ReducedPrecisionTest, ConversionAndProducts)
+{
+    Matrix<float> a(40,70);
+    Matrix<float> b(70,30);
+    a.generate([](int row, int col) {return std::sin(row * 0.3f + col * 0.7f);});
+    b.generate([](int row, int col) {return std::cos(row * 0.5f - col * 0.2f);});
+    std::vector<float> x(70);
+    for(int i = 0; i < 70; i++)
+    {
+        x[i] = std::cos(i * 0.1f);
+    }
+    std::vector<float> expectedY(40);
+    gemv(a, x, expectedY);
+    Matrix<float> expectedC(40,30);
+    gemm(a, b, expectedC);
+
+    Matrix<Half> aHalf = toReducedPrecision<Half>(a);
+    Matrix<BFloat16> aBFloat = toReducedPrecision<BFloat16>(a);
+    Matrix<Half> bHalf = toReducedPrecision<Half>(b);
+    Matrix<float> roundTrip = toFloat(aHalf);
+    EXPECT_NEAR(roundTrip.at(3,5),a.at(3,5),1e-3);
+
+    std::vector<float> y(40);
+    gemv(aHalf, x, y);
+    for(int row = 0; row < 40; row++)
+    {
+        EXPECT_NEAR(y[row],expectedY[row],2e-2);
+    }
+    gemv(aBFloat, x, y);
+    for(int row = 0; row < 40; row++)
+    {
+        EXPECT_NEAR(y[row],expectedY[row],2e-1);
+    }
+    Matrix<float> c(40,30);
+    gemm(aHalf, bHalf, c);
+    for(int row = 0; row < 40; row++)
+    {
+        for(int col = 0; col < 30; col++)
+        {
+            EXPECT_NEAR(c.at(row,col),expectedC.at(row,col),3e-2);
+        }
+    }
+}
+
+TEST(ReducedPrecisionTest, QuantizedProducts)
+{
+    Matrix<float> a(20,50);
+    Matrix<float> b(50,10);
+    a.generate([](int row, int col) {return (row + 1) * std::sin(col * 0.3f);});
+    b.generate([](int row, int col) {return std::cos(row * 0.2f + col);});
+    std::vector<float> x(50, 0.5f);
+    std::vector<float> expectedY(20);
+    gemv(a, x, expectedY);
+    Matrix<float> expectedC(20,10);
+    gemm(a, b, expectedC);
+
+    QuantizedMatrix perRow(a, QuantizationScale::PerRow);
+    QuantizedMatrix perTensor(a, QuantizationScale::PerTensor);
+    QuantizedMatrix bQuantized(b, QuantizationScale::PerTensor);
+    EXPECT_NE(perRow.getScale(0),perRow.getScale(19));
+    EXPECT_EQ(perTensor.getScale(0),perTensor.getScale(19));
+    Matrix<float> restored = perRow.dequantize();
+    EXPECT_NEAR(restored.at(7,11),a.at(7,11),perRow.getScale(7));
+
+    std::vector<float> y(20);
+    gemv(perRow, x, y);
+    for(int row = 0; row < 20; row++)
+    {
+        EXPECT_NEAR(y[row],expectedY[row],0.02 * (row + 1));
+    }
+    Matrix<float> c(20,10);
+    gemm(perRow, bQuantized, c);
+    for(int row = 0; row < 20; row++)
+    {
+        for(int col = 0; col < 10; col++)
+        {
+            EXPECT_NEAR(c.at(row,col),expectedC.at(row,col),0.05 * (row + 1));
+        }
+    }
+    EXPECT_THROW(gemm(bQuantized, perRow, c), std::invalid_argument);
+}
+
+TEST_F(MatrixTest, ContentEquality)
+{
+    Matrix<int> copy = Matrix(matrix3x3);
+    EXPECT_TRUE(copy == matrix3x3);
+
+    Matrix<int> same(3,3);
+    same.generate([](int row, int col) {return row * 3 + col + 1;});
+    EXPECT_TRUE(same == matrix3x3);
+    same.at(2,2) = 0;
+    EXPECT_TRUE(same != matrix3x3);
+    EXPECT_FALSE(Matrix<int>(3,1) == Matrix<int>(1,3));
+
+    Matrix<std::vector<int>> vectors(3,3);
+    int i = 1;
+    for(auto& element : vectors)
+    {
+        element.push_back(i++);
+    }
+    EXPECT_TRUE(vectors == matrixVectors);
+    vectors.at(0,0).push_back(0);
+    EXPECT_FALSE(vectors == matrixVectors);
+}
+
+TEST_F(MatrixTest, ContentHash)
+{
+    Matrix<int> same(3,3);
+    same.generate([](int row, int col) {return row * 3 + col + 1;});
+    EXPECT_EQ(std::hash<Matrix<int>>()(same),std::hash<Matrix<int>>()(matrix3x3));
+    EXPECT_NE(Matrix<int>(3,1).hash(),Matrix<int>(1,3).hash());
+
+    std::size_t before = matrix3x3.hash();
+    matrix3x3.at(1,1) = 50;
+    EXPECT_NE(matrix3x3.hash(),before);
+    matrix3x3.at(1,1) = 5;
+    EXPECT_EQ(matrix3x3.hash(),before);
+    *matrix3x3.begin() = 10;
+    EXPECT_NE(matrix3x3.hash(),before);
+
+    Matrix<double> doubles(2,2);
+    doubles.fill(0.5);
+    EXPECT_EQ(doubles.hash(),doubles.hash());
+
+    std::unordered_set<Matrix<int>> cache;
+    cache.insert(same);
+    EXPECT_EQ(cache.count(same),1);
+    EXPECT_EQ(cache.count(matrix3x3),0);
+}
+
+TEST(MatrixHashTest, EqualMatricesHashEqualAfterEarlierPointerWrites)
+{
+    Matrix<int> a(2,2);
+    Matrix<int> b(2,2);
+    a.fill(1);
+    b.fill(1);
+    int* pointer = a.begin();
+    a.hash();
+    pointer[0] = 7;
+    b.at(0,0) = 7;
+    ASSERT_TRUE(a == b);
+    EXPECT_EQ(a.hash(), b.hash());
+
+    MatrixPool<int> pool;
+    Matrix<int> pooled = pool.intern(a);
+    EXPECT_EQ(pooled.hash(), b.hash());
+    EXPECT_EQ(pool.intern(b).cbegin(), pooled.cbegin());
+}
+
+TEST_F(MatrixTest, InternSharesIdenticalMatrices)
+{
+    MatrixPool<int> pool;
+    Matrix<int> same(3,3);
+    same.generate([](int row, int col) {return row * 3 + col + 1;});
+
+    Matrix<int> first = pool.intern(matrix3x3);
+    Matrix<int> second = pool.intern(same);
+    EXPECT_EQ(pool.getSize(),1);
+    EXPECT_EQ(first.refCount(),3);
+    EXPECT_EQ(first.cbegin(),second.cbegin());
+    EXPECT_EQ(first.cbegin(),matrix3x3.cbegin());
+
+    //Writing through an interned handle leaves pooled data intact
+    matrix3x3.at(0,0) = 100;
+    EXPECT_EQ(first.at(0,0),1);
+    EXPECT_EQ(pool.getSize(),1);
+    EXPECT_EQ(second.refCount(),1);
+    EXPECT_EQ(pool.intern(matrix3x3).at(0,0),100);
+    EXPECT_EQ(pool.getSize(),2);
+
+    Matrix<int> unrelated(1,1);
+    matrix3x3 = unrelated;
+    EXPECT_EQ(pool.getSize(),1);
+    first = unrelated;
+    second = unrelated;
+    EXPECT_EQ(pool.getSize(),0);
+}
+
+TEST(MatrixPoolTest, ConcurrentIntern)
+{
+    MatrixPool<int> pool;
+    std::vector<std::thread> threads;
+    std::vector<Matrix<int>> results;
+    std::mutex resultsMutex;
+    for(int thread = 0; thread < 4; thread++)
+    {
+        threads.emplace_back([&pool, &results, &resultsMutex, thread]() {
+            for(int i = 0; i < 200; i++)
+            {
+                Matrix<int> request(4,4);
+                request.fill(i % 5);
+                Matrix<int> interned = pool.intern(request);
+                if(i == thread)
+                {
+                    std::lock_guard<std::mutex> lock(resultsMutex);
+                    results.push_back(interned);
+                }
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(results.size(),4);
+    EXPECT_EQ(pool.getSize(),4);
+    results.clear();
+    EXPECT_EQ(pool.getSize(),0);
+}
+
+TEST(MatrixProductTest, ChainOrder)
+{
+    Matrix<int> a(10,100);
+    Matrix<int> b(100,5);
+    Matrix<int> c(5,50);
+    MatrixProduct<int> product = a * b * c;
+    EXPECT_EQ(product.getOperandCount(),3);
+    EXPECT_EQ(product.getOrder(),"((0*1)*2)");
+    EXPECT_EQ(product.getCost(),10 * 100 * 5 + 10 * 5 * 50);
+
+    Matrix<int> d(50,1);
+    EXPECT_EQ((b * c * d).getOrder(),"(0*(1*2))");
+    EXPECT_EQ((a * (b * c) * d).getOrder(),"(0*(1*(2*3)))");
+
+    Matrix<int> wrong(3,3);
+    EXPECT_THROW(Matrix<int>(a * wrong), std::invalid_argument);
+}
+
+TEST(MatrixProductTest, EvaluationMatchesGemm)
+{
+    Matrix<long long> a(7,30);
+    Matrix<long long> b(30,2);
+    Matrix<long long> c(2,40);
+    Matrix<long long> d(40,3);
+    a.generate([](int row, int col) {return (row + col) % 5 - 2;});
+    b.generate([](int row, int col) {return (row * col) % 3 - 1;});
+    c.generate([](int row, int col) {return (row + 2 * col) % 7 - 3;});
+    d.generate([](int row, int col) {return (3 * row + col) % 4 - 1;});
+
+    Matrix<long long> ab(7,2);
+    Matrix<long long> abc(7,40);
+    Matrix<long long> expected(7,3);
+    gemm(a, b, ab);
+    gemm(ab, c, abc);
+    gemm(abc, d, expected);
+
+    Matrix<long long> result = a * b * c * d;
+    EXPECT_EQ(result.getRowCount(),7);
+    EXPECT_EQ(result.getColumnCount(),3);
+    EXPECT_TRUE(result == expected);
+
+    a = a * b * c * d;
+    EXPECT_TRUE(a == expected);
+}
+
+TEST(MatrixProductTest, WideDimensionsAreNotTruncated)
+{
+    MatrixIndex wide = (MatrixIndex(1) << 32) + 1;
+    Matrix<int> a(0,wide);
+    Matrix<int> b(wide,0);
+    Matrix<int> c(1,3);
+    EXPECT_THROW((a * c).getOrder(), std::invalid_argument);
+
+    EXPECT_EQ((a * b).getCost(),0);
+    Matrix<int> result = a * b;
+    EXPECT_EQ(result.getRowCount(),0);
+    EXPECT_EQ(result.getColumnCount(),0);
+}
+
+TEST_F(MatrixTest, ResizeKeepsContents)
+{
+    matrix3x3.reserve(4,5);
+    EXPECT_EQ(matrix3x3.getCapacity(),20);
+    const int* storage = matrix3x3.cbegin();
+
+    matrix3x3.resize(4,4,-1);
+    EXPECT_EQ(matrix3x3.cbegin(),storage);
+    EXPECT_EQ(matrix3x3.getRowCount(),4);
+    EXPECT_EQ(matrix3x3.getColumnCount(),4);
+    EXPECT_EQ(matrix3x3.at(0,0),1);
+    EXPECT_EQ(matrix3x3.at(1,2),6);
+    EXPECT_EQ(matrix3x3.at(2,2),9);
+    EXPECT_EQ(matrix3x3.at(1,3),-1);
+    EXPECT_EQ(matrix3x3.at(3,0),-1);
+
+    matrix3x3.resize(2,2);
+    EXPECT_EQ(matrix3x3.cbegin(),storage);
+    EXPECT_EQ(matrix3x3.at(0,1),2);
+    EXPECT_EQ(matrix3x3.at(1,0),4);
+    EXPECT_EQ(matrix3x3.at(1,1),5);
+
+    matrix3x3.resize(3,8,0);
+    EXPECT_EQ(matrix3x3.getCapacity(),24);
+    EXPECT_EQ(matrix3x3.at(1,1),5);
+    EXPECT_EQ(matrix3x3.at(1,7),0);
+    EXPECT_EQ(matrix3x3.at(2,0),0);
+}
+
+TEST(MatrixResizeTest, InPlaceResizeKeepsNonTrivialElements)
+{
+    Matrix<std::string> strings(3, 2);
+    strings.generate([](int row, int column) {return std::to_string(row) + "," + std::to_string(column);});
+    strings.resize(2, 2);
+    EXPECT_EQ(strings.at(0, 0), "0,0");
+    EXPECT_EQ(strings.at(0, 1), "0,1");
+    EXPECT_EQ(strings.at(1, 1), "1,1");
+    strings.resize(2, 1);
+    EXPECT_EQ(strings.at(0, 0), "0,0");
+    EXPECT_EQ(strings.at(1, 0), "1,0");
+
+    //Capacity of 4 x 3 lets 3 x 2 widen to 3 x 3 and then 3 x 4 would not fit, so both paths run in place first
+    Matrix<std::vector<int>> vectors(4, 3);
+    vectors.reserve(4, 3);
+    vectors.resize(3, 2);
+    vectors.generate([](int row, int column) {return std::vector<int>{row, column};});
+    vectors.resize(3, 3, std::vector<int>{-1});
+    EXPECT_EQ(vectors.at(0, 0), (std::vector<int>{0, 0}));
+    EXPECT_EQ(vectors.at(0, 1), (std::vector<int>{0, 1}));
+    EXPECT_EQ(vectors.at(0, 2), (std::vector<int>{-1}));
+    EXPECT_EQ(vectors.at(2, 1), (std::vector<int>{2, 1}));
+    vectors.resize(3, 1);
+    EXPECT_EQ(vectors.at(0, 0), (std::vector<int>{0, 0}));
+    EXPECT_EQ(vectors.at(2, 0), (std::vector<int>{2, 0}));
+}
+
+TEST_F(MatrixTest, ResizeSharedDetaches)
+{
+    //Detaching data with spare capacity copies only the elements in use
+    matrix3x3.reserve(8,8);
+    Matrix<int> detached = Matrix(matrix3x3);
+    detached.at(0,0) = 0;
+    EXPECT_EQ(detached.at(2,2),9);
+
+    Matrix<int> copy = Matrix(matrix3x3);
+    copy.resize(2,4,7);
+    EXPECT_EQ(matrix3x3.getColumnCount(),3);
+    EXPECT_EQ(matrix3x3.refCount(),1);
+    EXPECT_EQ(copy.at(1,1),5);
+    EXPECT_EQ(copy.at(1,3),7);
+}
+
+TEST_F(MatrixTest, Reshape)
+{
+    matrix3x3.resize(2,6,0);
+    const int* storage = matrix3x3.cbegin();
+    matrix3x3.reshape(4,3);
+    EXPECT_EQ(matrix3x3.getRowCount(),4);
+    EXPECT_EQ(matrix3x3.cbegin(),storage);
+    EXPECT_EQ(matrix3x3.at(0,2),3);
+    EXPECT_EQ(matrix3x3.at(1,0),0);
+    EXPECT_THROW(matrix3x3.reshape(5,3), std::invalid_argument);
+
+    Matrix<int> copy = Matrix(matrix3x3);
+    copy.reshape(1,12);
+    EXPECT_EQ(matrix3x3.getRowCount(),4);
+    EXPECT_EQ(copy.at(0,3),0);
+}
+
+TEST(MatrixIndexTest, SizesBeyondIntRange)
+{
+    constexpr MatrixIndex maxIndex = std::numeric_limits<MatrixIndex>::max();
+    EXPECT_THROW(Matrix<char>(MatrixIndex(1) << 40, MatrixIndex(1) << 40), std::length_error);
+    EXPECT_THROW(Matrix<double>(maxIndex / 8 + 1, 1), std::length_error);
+    EXPECT_THROW(Matrix<int>(-1, 2), std::invalid_argument);
+    Matrix<int> small(2, 2);
+    EXPECT_THROW(small.reserve(maxIndex, 2), std::length_error);
+    EXPECT_THROW(small.resize(2, maxIndex), std::length_error);
+    EXPECT_THROW(small.reshape(maxIndex / 2 + 1, 4), std::invalid_argument);
+    EXPECT_EQ(small.getSize(), 4);
+
+    //Bit-packed rows hold 2^32 logical elements in 64 MiB
+    constexpr MatrixIndex wideColumns = MatrixIndex(1) << 31;
+    Matrix<bool> bits(2, wideColumns);
+    EXPECT_EQ(bits.getSize(), MatrixIndex(1) << 32);
+    bits.at(1, wideColumns - 1) = true;
+    bits.at(0, MatrixIndex(1) << 30) = true;
+    EXPECT_TRUE(bits.test(1, wideColumns - 1));
+    EXPECT_EQ(bits.popcount(), 2);
+
+    //Element offsets past INT_MAX need about 2 GiB, skipped on machines without that much free memory
+    constexpr MatrixIndex rows = MatrixIndex(1) << 16;
+    constexpr MatrixIndex columns = (MatrixIndex(1) << 15) + 1;
+    MatrixIndex availableBytes = static_cast<MatrixIndex>(sysconf(_SC_AVPHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+    if(availableBytes < 3 * rows * columns / 2)
+    {
+        GTEST_SKIP() << "not enough free memory for " << rows * columns << " byte matrix";
+    }
+    Matrix<char> large(rows, columns);
+    ASSERT_GT(large.getSize(), MatrixIndex(std::numeric_limits<int>::max()));
+    EXPECT_EQ(large.cend() - large.cbegin(), rows * columns);
+    large.at(rows - 1, columns - 1) = 7;
+    EXPECT_EQ(large.ptrAt(rows - 1, columns - 1) - large.cbegin(), rows * columns - 1);
+    EXPECT_EQ(*(large.cend() - 1), 7);
+    Matrix<char>::const_rowIterator lastRow(rows - 1, &large);
+    EXPECT_EQ((*lastRow)[columns - 1].get(), 7);
+    EXPECT_EQ(++lastRow, large.endConstRow());
+    large.reshape(columns, rows);
+    EXPECT_EQ(large.at(columns - 1, rows - 1), 7);
+}
+
+TEST(MatrixIndexTest, IntIndexedMatricesRejectWideSources)
+{
+    constexpr MatrixIndex wide = (MatrixIndex(1) << 32) + 2;
+    Matrix<double> tall(wide, 0);
+    Matrix<double> flat(0, wide);
+    EXPECT_THROW(TriangularMatrix<double>(tall, Triangle::Lower), std::length_error);
+    EXPECT_THROW(SymmetricMatrix<double>{tall}, std::length_error);
+    EXPECT_THROW(BandedMatrix<double>(tall, 1, 1), std::length_error);
+    EXPECT_THROW(ChunkedMatrix<double>{tall}, std::length_error);
+    EXPECT_THROW(ChunkedMatrix<double>{flat}, std::length_error);
+    EXPECT_THROW(PermutedMatrix<double>{flat}, std::length_error);
+}
+
+TEST(ChunkedMatrixTest, InsertAndEraseMatchContiguousMatrix)
+{
+    //Wide rows keep blocks small, so the sequence splits and unlinks many blocks
+    const int columns = 1024;
+    ChunkedMatrix<int> chunked(0, columns);
+    std::vector<std::vector<int>> expected;
+    std::minstd_rand random(7);
+    for(int step = 0; step < 600; step++)
+    {
+        int rowCount = static_cast<int>(expected.size());
+        if(rowCount > 0 && random() % 3 == 0)
+        {
+            int index = static_cast<int>(random() % rowCount);
+            chunked.eraseRow(index);
+            expected.erase(expected.begin() + index);
+        }
+        else
+        {
+            int index = static_cast<int>(random() % (rowCount + 1));
+            std::vector<int> row(columns, step);
+            row.front() = -step;
+            chunked.insertRow(row, index);
+            expected.insert(expected.begin() + index, row);
+        }
+    }
+    ASSERT_EQ(chunked.getRowCount(), static_cast<int>(expected.size()));
+    EXPECT_GT(chunked.getBlockCount(), 1);
+    int row = 0;
+    for(std::span<const int> values : chunked.constRows())
+    {
+        ASSERT_TRUE(std::equal(values.begin(), values.end(), expected[row].begin()));
+        row++;
+    }
+}
+
+TEST_F(MatrixTest, ChunkedMatrixIterators)
+{
+    ChunkedMatrix<int> chunked(matrix3x3);
+    chunked.insertRow(std::vector<int>{10,11,12}, 1);
+    ChunkedMatrix<int>::rowIterator second = chunked.beginRow();
+    second++;
+    EXPECT_EQ((*second)[2].get(),12);
+    chunked.eraseRow(chunked.beginRow());
+
+    std::vector<int> flat(chunked.cbegin(), chunked.cend());
+    EXPECT_EQ(flat, (std::vector<int>{10,11,12,4,5,6,7,8,9}));
+    for(int& value : chunked)
+    {
+        value *= 2;
+    }
+    ChunkedMatrix<int> copy = chunked;
+    copy.at(0,0) = 0;
+    EXPECT_EQ(chunked.at(0,0),20);
+
+    Matrix<int> contiguous = chunked.toMatrix();
+    EXPECT_EQ(contiguous.getRowCount(),3);
+    EXPECT_EQ(contiguous.at(2,1),16);
+}
+
+TEST_F(MatrixTest, ChunkedMatrixColumnIterators)
+{
+    ChunkedMatrix<int> chunked(matrix3x3);
+    ChunkedMatrix<int>::columnIterator column = chunked.beginColumn();
+    column++;
+    std::vector<std::reference_wrapper<int>> middle = *column;
+    ASSERT_EQ(middle.size(),3);
+    EXPECT_EQ(middle[2].get(),8);
+    middle[0].get() = 20;
+    EXPECT_EQ(chunked.at(0,1),20);
+    EXPECT_EQ(*(column.operator->().at(1)),5);
+
+    int columns = 0;
+    for(ChunkedMatrix<int>::const_columnIterator it = chunked.beginConstColumn(); it != chunked.endConstColumn(); it++)
+    {
+        std::vector<std::reference_wrapper<const int>> values = *it;
+        EXPECT_EQ(values[2].get(),7 + columns);
+        columns++;
+    }
+    EXPECT_EQ(columns,3);
+}
+
+TEST(ChunkedMatrixTest, InsertAndEraseColumnsMatchContiguousMatrix)
+{
+    const int rows = 700;
+    Matrix<int> expected(rows,6);
+    expected.generate([](int row, int col) {return row * 10 + col;});
+    ChunkedMatrix<int> chunked(expected);
+    ASSERT_GT(chunked.getBlockCount(), 1);
+
+    std::vector<int> inserted(rows);
+    std::iota(inserted.begin(), inserted.end(), -rows);
+    chunked.insertColumn(inserted, 2);
+    expected.insertColumn(inserted, 2);
+    std::vector<int*> pointers;
+    for(int& value : inserted)
+    {
+        pointers.push_back(&value);
+    }
+    chunked.insertColumn(pointers, 7);
+    expected.insertColumn(pointers, 7);
+    EXPECT_EQ(chunked.getColumnCount(),8);
+    EXPECT_TRUE(chunked.toMatrix() == expected);
+
+    ChunkedMatrix<int>::columnIterator next = chunked.eraseColumn(chunked.beginColumn());
+    EXPECT_EQ(next.getIndex(),0);
+    expected.eraseColumn(expected.beginColumn());
+    chunked.eraseColumn(6);
+    expected.eraseColumn(Matrix<int>::columnIterator(6, &expected));
+    EXPECT_EQ(chunked.getColumnCount(),6);
+    EXPECT_EQ(chunked.getRowCount(),rows);
+    EXPECT_TRUE(chunked.toMatrix() == expected);
+}
+
+TEST(ChunkedMatrixTest, ColumnInsertAndEraseRejectBadArguments)
+{
+    ChunkedMatrix<int> chunked(3,2);
+    EXPECT_THROW(chunked.insertColumn(std::vector<int>{1,2,3}, 3), std::out_of_range);
+    EXPECT_THROW(chunked.insertColumn(std::vector<int>{1,2,3}, -1), std::out_of_range);
+    EXPECT_THROW(chunked.insertColumn(std::vector<int>{1,2}, 0), std::invalid_argument);
+    EXPECT_THROW(chunked.eraseColumn(2), std::out_of_range);
+    EXPECT_THROW(chunked.eraseColumn(-1), std::out_of_range);
+    EXPECT_EQ(chunked.getColumnCount(),2);
+    EXPECT_EQ(chunked.getRowCount(),3);
+}
+
+TEST(ChunkedMatrixTest, EraseMergesUnderfilledBlocks)
+{
+    //Rows of 1024 ints give four rows per block
+    const int columns = 1024;
+    const int rows = 64;
+    Matrix<int> source(rows,columns);
+    source.generate([](int row, int col) {return row * columns + col;});
+    ChunkedMatrix<int> chunked(source);
+    ASSERT_EQ(chunked.getBlockCount(),16);
+
+    for(int row = rows - 1; row >= 0; row--)
+    {
+        if(row % 4 != 0)
+        {
+            chunked.eraseRow(row);
+        }
+    }
+    EXPECT_EQ(chunked.getRowCount(),16);
+    EXPECT_LE(chunked.getBlockCount(),4);
+    int row = 0;
+    for(std::span<const int> values : chunked.constRows())
+    {
+        EXPECT_EQ(values.front(),4 * row * columns);
+        row++;
+    }
+}
+
+TEST_F(MatrixTest, PermutedMatrixSwapAndPermute)
+{
+    PermutedMatrix<int> view(matrix3x3);
+    view.swapRows(0,2);
+    view.swapColumns(0,1);
+    EXPECT_EQ(view.get(0,0),8);
+    EXPECT_EQ(view.get(2,2),3);
+    EXPECT_THROW(view.get(3,0), std::out_of_range);
+    EXPECT_EQ(matrix3x3.refCount(),2);
+    EXPECT_EQ(view.at(0,0),8);
+    EXPECT_EQ(matrix3x3.refCount(),1);
+    view.permuteRows({2,0,1});
+    EXPECT_EQ(view.getRowMap(), (std::vector<int>{0,2,1}));
+    EXPECT_THROW(view.permuteRows({0,0,1}), std::invalid_argument);
+
+    Matrix<int> result = view.materialize();
+    EXPECT_EQ(std::vector<int>(result.cbegin(), result.cend()), (std::vector<int>{2,1,3,8,7,9,5,4,6}));
+    EXPECT_EQ(matrix3x3.at(0,0),1);
+}
+
+TEST(PermutedMatrixTest, ParallelSortMatchesStableSort)
+{
+    Matrix<int> matrix(20000, 3);
+    matrix.generate([](int row, int col) {return col == 1 ? (row * 7919) % 1000 : row;});
+    PermutedMatrix<int> view(matrix);
+    view.sortRowsBy(1);
+
+    std::vector<int> expected(20000);
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(), [](int lhs, int rhs) {
+        return (lhs * 7919) % 1000 < (rhs * 7919) % 1000;
+    });
+    EXPECT_EQ(view.getRowMap(), expected);
+
+    view.sortRowsBy(0, std::greater<int>());
+    Matrix<int> result = view.materialize();
+    EXPECT_EQ(result.at(0,0),19999);
+    EXPECT_EQ(result.at(19999,2),0);
+}
+
+///@brief Reference correlation reading source through at()
+static double referenceConvolution(Matrix<double>& source, Matrix<double>& kernel, int row, int col, BorderMode border)
+{
+    double sum = 0;
+    for(int i = 0; i < kernel.getRowCount(); i++)
+    {
+        for(int j = 0; j < kernel.getColumnCount(); j++)
+        {
+            int sourceRow = MatrixKernels::borderIndex(row + i - kernel.getRowCount() / 2, source.getRowCount(), border);
+            int sourceCol = MatrixKernels::borderIndex(col + j - kernel.getColumnCount() / 2, source.getColumnCount(), border);
+            if(sourceRow >= 0 && sourceCol >= 0)
+            {
+                sum += kernel.at(i,j) * source.at(sourceRow,sourceCol);
+            }
+        }
+    }
+    return sum;
+}
+
+TEST(ConvolutionTest, MatchesReferenceForAllBorderModes)
+{
+    //Size spans several tiles in both directions with partial edge tiles
+    Matrix<double> source(70, 300);
+    source.generate([](int row, int col) {return std::sin(row * 0.3 + col * 0.11);});
+    Matrix<double> general(3, 5);
+    general.generate([](int row, int col) {return row * 5 + col - 7.0 + (row == col ? 0.5 : 0.0);});
+    Matrix<double> separable(7, 7);
+    separable.generate([](int row, int col) {return (1.0 + row) * (3.0 - col);});
+    Matrix<double> destination(70, 300);
+
+    for(BorderMode border : {BorderMode::Zero, BorderMode::Clamp, BorderMode::Wrap})
+    {
+        for(Matrix<double>* kernel : {&general, &separable})
+        {
+            convolve(source, *kernel, destination, border);
+            for(int row : {0, 1, 31, 32, 69})
+            {
+                for(int col : {0, 2, 255, 256, 299})
+                {
+                    EXPECT_NEAR(destination.at(row,col), referenceConvolution(source, *kernel, row, col, border), 1e-9);
+                }
+            }
+        }
+    }
+    EXPECT_THROW(convolve(source, general, source), std::invalid_argument);
+}
+
+TEST(ConvolutionTest, Stencil)
+{
+    Matrix<float> grid(40, 40);
+    grid.generate([](int row, int col) {return static_cast<float>(row * row + col * col);});
+    Matrix<float> laplacian(40, 40);
+    applyStencil(grid, laplacian, 1, [](const float* center, int stride) {
+        return center[-stride] + center[stride] + center[-1] + center[1] - 4 * center[0];
+    }, BorderMode::Clamp);
+    EXPECT_FLOAT_EQ(laplacian.at(10,20), 4.0f);
+    EXPECT_FLOAT_EQ(laplacian.at(0,0), 2.0f);
+}
+
+TEST_F(MatrixTest, BroadcastVectors)
+{
+    Matrix<int> shared = Matrix(matrix3x3);
+    matrix3x3.subtractRowVector(std::vector<int>{4,5,6});
+    EXPECT_EQ(std::vector<int>(matrix3x3.cbegin(), matrix3x3.cend()), (std::vector<int>{-3,-3,-3,0,0,0,3,3,3}));
+    EXPECT_EQ(shared.at(0,0),1);
+
+    matrix3x3.mulColumnVector(std::vector<int>{2,7,-1});
+    EXPECT_EQ(std::vector<int>(matrix3x3.cbegin(), matrix3x3.cend()), (std::vector<int>{-6,-6,-6,0,0,0,-3,-3,-3}));
+
+    shared.broadcastRows(std::vector<int>{1,0,1}, [](int element, int mask) {return mask ? element : 0;});
+    EXPECT_EQ(std::vector<int>(shared.cbegin(), shared.cend()), (std::vector<int>{1,0,3,4,0,6,7,0,9}));
+    EXPECT_THROW(shared.addColumnVector(std::vector<int>{1,2}), std::invalid_argument);
+}
+
+template<typename T>
+static void expectKernelsMatch(const CpuKernels& reference, const CpuKernels& variant,
+                               T (*CpuKernels::*dot)(const T*, const T*, int),
+                               void (*CpuKernels::*axpy)(T, const T*, T*, int))
+{
+    for(int size : {0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 100, 1001})
+    {
+        std::vector<T> x(size);
+        std::vector<T> y(size);
+        for(int i = 0; i < size; i++)
+        {
+            x[i] = static_cast<T>(std::sin(i * 0.7));
+            y[i] = static_cast<T>(std::cos(i * 0.3));
+        }
+        T tolerance = static_cast<T>(size + 1) * std::numeric_limits<T>::epsilon() * 4;
+        EXPECT_NEAR((variant.*dot)(x.data(), y.data(), size), (reference.*dot)(x.data(), y.data(), size), tolerance)
+                << "size " << size;
+
+        std::vector<T> expected = y;
+        (reference.*axpy)(T(1.5), x.data(), expected.data(), size);
+        (variant.*axpy)(T(1.5), x.data(), y.data(), size);
+        for(int i = 0; i < size; i++)
+        {
+            EXPECT_NEAR(y[i], expected[i], std::numeric_limits<T>::epsilon() * 8) << "size " << size;
+        }
+    }
+}
+
+TEST(CpuDispatchTest, VariantsMatchScalarReference)
+{
+    const CpuKernels& scalar = cpuKernels(CpuIsa::Scalar);
+    for(CpuIsa isa : {CpuIsa::SSE2, CpuIsa::AVX2, CpuIsa::AVX512})
+    {
+        if(!isCpuIsaSupported(isa))
+        {
+            std::cout << cpuIsaName(isa) << " is not supported on this machine, skipped" << std::endl;
+            continue;
+        }
+        SCOPED_TRACE(cpuIsaName(isa));
+        expectKernelsMatch<float>(scalar, cpuKernels(isa), &CpuKernels::dotFloat, &CpuKernels::axpyFloat);
+        expectKernelsMatch<double>(scalar, cpuKernels(isa), &CpuKernels::dotDouble, &CpuKernels::axpyDouble);
+        for(int size : {0, 1, 3, 4, 7, 8, 9, 33, 100})
+        {
+            std::vector<std::uint64_t> lhs(size);
+            std::vector<std::uint64_t> rhs(size);
+            for(int i = 0; i < size; i++)
+            {
+                lhs[i] = 0x9e3779b97f4a7c15ull * (i + 1);
+                rhs[i] = ~0ull << (i % 64);
+            }
+            EXPECT_EQ(cpuKernels(isa).andPopcount(lhs.data(), rhs.data(), size),
+                      scalar.andPopcount(lhs.data(), rhs.data(), size)) << "size " << size;
+
+            std::vector<int> distances(size);
+            std::vector<int> expected(size);
+            std::vector<float> floatDistances(size);
+            std::vector<float> floatExpected(size);
+            for(int i = 0; i < size; i++)
+            {
+                distances[i] = i % 3 == 0 ? std::numeric_limits<int>::max() : (i * 37) % 50 - 10;
+                expected[i] = (i * 11) % 40;
+                floatDistances[i] = static_cast<float>(distances[i]);
+                floatExpected[i] = static_cast<float>(expected[i]);
+            }
+            std::vector<int> reference = expected;
+            std::vector<float> floatReference = floatExpected;
+            scalar.minPlusInt(7, distances.data(), reference.data(), size);
+            cpuKernels(isa).minPlusInt(7, distances.data(), expected.data(), size);
+            scalar.minPlusFloat(7.0f, floatDistances.data(), floatReference.data(), size);
+            cpuKernels(isa).minPlusFloat(7.0f, floatDistances.data(), floatExpected.data(), size);
+            EXPECT_EQ(expected, reference) << "size " << size;
+            EXPECT_EQ(floatExpected, floatReference) << "size " << size;
+        }
+    }
+}
+
+TEST(CpuDispatchTest, EnvironmentOverride)
+{
+    CpuIsa parsed = CpuIsa::Scalar;
+    EXPECT_TRUE(cpuIsaFromName("avx2", parsed));
+    EXPECT_EQ(parsed, CpuIsa::AVX2);
+    EXPECT_FALSE(cpuIsaFromName("neon", parsed));
+
+    CpuIsa expected = detectCpuIsa();
+    const char* requested = std::getenv(cpuIsaEnvironmentVariable);
+    if(requested != nullptr && cpuIsaFromName(requested, parsed) && parsed < expected)
+    {
+        expected = parsed;
+    }
+    EXPECT_EQ(activeCpuIsa(), expected);
+    EXPECT_EQ(&cpuKernels(), &cpuKernels(expected));
+}
+
+TEST(MatrixAllocatorTest, LargeMatricesUseHugePageAlignedZeroedStorage)
+{
+    int rows = static_cast<int>(hugePageThreshold / sizeof(double) / 1024);
+    Matrix<double> large(rows, 1024);
+    ASSERT_TRUE(MatrixAllocator<double>::isHugePageAllocation(static_cast<std::size_t>(rows) * 1024));
+#ifdef __linux__
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large.cbegin()) % hugePageSize, 0u);
+#endif
+    EXPECT_TRUE(std::all_of(large.cbegin(), large.cend(), [](double value) {return value == 0.0;}));
+
+    large.at(rows - 1, 1023) = 5.0;
+    Matrix<double> copy = Matrix(large);
+    copy.at(0,0) = 1.0;
+    EXPECT_EQ(large.at(0,0), 0.0);
+    EXPECT_EQ(copy.at(rows - 1, 1023), 5.0);
+
+    //Shrinking below the threshold reuses the mapping, growing beyond it maps a new one
+    large.resize(4, 4);
+    EXPECT_EQ(large.at(3,3), 0.0);
+    copy.resize(rows + 1, 1024);
+    EXPECT_EQ(copy.at(rows - 1, 1023), 5.0);
+    EXPECT_FALSE(MatrixAllocator<std::vector<int>>::isHugePageAllocation(hugePageThreshold));
+}
+
+TEST(MatrixTraceTest, ChromeTraceHoldsEventsOfEveryThread)
+{
+    MatrixTrace::instance().clear();
+    {
+        MatrixTraceScope scope("traced \"outer\"", 3, 4, 96);
+        std::thread worker([]() {
+            MatrixTraceScope inner("traced inner", 5, 6, 240);
+        });
+        worker.join();
+    }
+#ifdef MATRIX_ENABLE_TRACING
+    Matrix<double> matrix(8, 8);
+    matrix.fill(1.0);
+#endif
+    std::ostringstream stream;
+    MatrixTrace::instance().writeChromeTrace(stream);
+    std::string trace = stream.str();
+
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(trace.find("\"name\":\"traced \\\"outer\\\"\",\"cat\":\"matrix\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(trace.find("\"args\":{\"rows\":5,\"cols\":6,\"bytes\":240}"), std::string::npos);
+    std::size_t outer = trace.find("traced \\\"outer");
+    std::size_t inner = trace.find("traced inner");
+    std::string outerThread = trace.substr(trace.find("\"tid\":", outer), 8);
+    std::string innerThread = trace.substr(trace.find("\"tid\":", inner), 8);
+    EXPECT_NE(outerThread, innerThread);
+#ifdef MATRIX_ENABLE_TRACING
+    EXPECT_NE(trace.find("\"name\":\"Matrix::fill\""), std::string::npos);
+#endif
+    MatrixTrace::instance().clear();
+    std::ostringstream empty;
+    MatrixTrace::instance().writeChromeTrace(empty);
+    EXPECT_EQ(empty.str().find("\"ph\""), std::string::npos);
+}
+
+TEST(RowAggregateTest, UpdateRevisitsOnlyModifiedRows)
+{
+    Matrix<double> matrix(100, 8);
+    matrix.generate([](int row, int column) {return row * 8.0 + column;});
+    auto rowSum = [](std::span<const double> row) {return std::accumulate(row.begin(), row.end(), 0.0);};
+    RowAggregate sums(matrix, rowSum);
+    auto expectCurrent = [&](const std::vector<double>& values) {
+        ASSERT_EQ(static_cast<int>(values.size()), matrix.getRowCount());
+        for(int row = 0; row < matrix.getRowCount(); row++)
+        {
+            EXPECT_EQ(values[row], rowSum(std::span<const double>(matrix.cbegin() + row * 8, 8)));
+        }
+    };
+
+    expectCurrent(sums.update());
+    EXPECT_EQ(sums.getRecomputedRowCount(), 100);
+    sums.update();
+    EXPECT_EQ(sums.getRecomputedRowCount(), 0);
+
+    matrix.at(5, 2) = -1.0;
+    *matrix.ptrAt(70, 0) = -2.0;
+    expectCurrent(sums.update());
+    EXPECT_EQ(sums.getRecomputedRowCount(), 2);
+
+    //Rows behind an inserted or erased row moved, rows before it keep their values
+    matrix.insertRow(std::vector<double>(8, 1.0), 90);
+    expectCurrent(sums.update());
+    EXPECT_EQ(sums.getRecomputedRowCount(), 11);
+    matrix.eraseRow(matrix.beginRow());
+    expectCurrent(sums.update());
+    EXPECT_EQ(sums.getRecomputedRowCount(), 100);
+
+    matrix.reserve(200, 8);
+    matrix.resize(104, 8);
+    expectCurrent(sums.update());
+    EXPECT_EQ(sums.getRecomputedRowCount(), 4);
+
+    //Writes to a copy do not touch the original, detaching the original recomputes it once
+    Matrix<double> copy = Matrix(matrix);
+    copy.at(0, 0) = 10.0;
+    sums.update();
+    EXPECT_EQ(sums.getRecomputedRowCount(), 0);
+    Matrix<double> second = Matrix(matrix);
+    matrix.at(1, 1) = 3.0;
+    expectCurrent(sums.update());
+    EXPECT_EQ(sums.getRecomputedRowCount(), 104);
+    matrix.at(2, 1) = 3.0;
+    sums.update();
+    EXPECT_EQ(sums.getRecomputedRowCount(), 1);
+
+    matrix.fill(2.0);
+    expectCurrent(sums.update());
+    EXPECT_EQ(sums.getRecomputedRowCount(), 104);
+}
+
+//Count is not a multiple of batchLanes, so padding lanes are exercised as well
+static std::vector<Matrix<double>> randomBatchMatrices(int n, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    int count = 2 * batchLanes + 5;
+    std::vector<Matrix<double>> matrices;
+    for(int index = 0; index < count; index++)
+    {
+        matrices.emplace_back(n, n);
+        matrices.back().generate([&](int, int) {return distribution(generator);});
+    }
+    //Diagonally dominant matrices are far from singular
+    for(int index = 0; index < count; index += 2)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            matrices[index].at(i, i) += n;
+        }
+    }
+    return matrices;
+}
+
+TEST(MatrixBatchTest, PacksAndUnpacksMatrices)
+{
+    std::vector<Matrix<double>> matrices = randomBatchMatrices(3, 7);
+    int count = static_cast<int>(matrices.size());
+    MatrixBatch<double> batch(matrices);
+    EXPECT_EQ(batch.getCount(), count);
+    EXPECT_EQ(batch.getStride() % batchLanes, 0);
+    EXPECT_GE(batch.getStride(), count);
+    EXPECT_TRUE(batch.getMatrix(count - 1) == matrices[count - 1]);
+    EXPECT_EQ(batch.at(4, 2, 1), matrices[4].at(2, 1));
+
+    batch.setMatrix(0, matrices[1]);
+    std::vector<Matrix<double>> unpacked = batch.toMatrices();
+    ASSERT_EQ(static_cast<int>(unpacked.size()), count);
+    EXPECT_TRUE(unpacked[0] == matrices[1]);
+    EXPECT_TRUE(unpacked[count - 1] == matrices[count - 1]);
+}
+
+TEST(MatrixBatchTest, PackingRejectsBadArguments)
+{
+    EXPECT_THROW(MatrixBatch<double>(-1, 2, 2), std::invalid_argument);
+    std::vector<Matrix<double>> mixed;
+    mixed.emplace_back(2, 2);
+    mixed.emplace_back(2, 3);
+    EXPECT_THROW(MatrixBatch<double>{mixed}, std::invalid_argument);
+
+    MatrixBatch<double> batch(3, 2, 2);
+    Matrix<double> wrong(3, 2);
+    EXPECT_THROW(batch.at(3, 0, 0), std::out_of_range);
+    EXPECT_THROW(batch.at(0, -1, 0), std::out_of_range);
+    EXPECT_THROW(batch.getMatrix(-1), std::out_of_range);
+    EXPECT_THROW(batch.setMatrix(3, wrong), std::out_of_range);
+    EXPECT_THROW(batch.setMatrix(0, wrong), std::invalid_argument);
+}
+
+TEST(MatrixBatchTest, MultiplyMatchesGemm)
+{
+    for(int n : {2, 3, 4, 5})
+    {
+        std::vector<Matrix<double>> matrices = randomBatchMatrices(n, 11);
+        int count = static_cast<int>(matrices.size());
+        MatrixBatch<double> batch(matrices);
+        MatrixBatch<double> product(count, n, n);
+        batchMultiply(batch, batch, product);
+        for(int index = 0; index < count; index++)
+        {
+            Matrix<double> expected(n, n);
+            gemm(matrices[index], matrices[index], expected);
+            Matrix<double> result = product.getMatrix(index);
+            for(int element = 0; element < n * n; element++)
+            {
+                EXPECT_NEAR(result.cbegin()[element], expected.cbegin()[element], 1e-12);
+            }
+        }
+    }
+
+    MatrixBatch<double> wide(3, 2, 3);
+    MatrixBatch<double> square(3, 2, 2);
+    MatrixBatch<double> otherCount(4, 2, 2);
+    EXPECT_THROW(batchMultiply(wide, wide, wide), std::invalid_argument);
+    EXPECT_THROW(batchMultiply(square, square, otherCount), std::invalid_argument);
+    EXPECT_THROW(batchMultiply(square, square, square), std::invalid_argument);
+}
+
+TEST(MatrixBatchTest, TransposeMatchesPerMatrixTranspose)
+{
+    std::vector<Matrix<double>> matrices;
+    for(int index = 0; index < batchLanes + 1; index++)
+    {
+        matrices.emplace_back(2, 3);
+        matrices.back().generate([index](int row, int col) {return index * 10.0 + row * 3 + col;});
+    }
+    MatrixBatch<double> batch(matrices);
+    MatrixBatch<double> transposed(batch.getCount(), 3, 2);
+    batchTranspose(batch, transposed);
+    for(int index = 0; index < batch.getCount(); index++)
+    {
+        for(int row = 0; row < 2; row++)
+        {
+            for(int column = 0; column < 3; column++)
+            {
+                EXPECT_EQ(transposed.at(index, column, row), matrices[index].at(row, column));
+            }
+        }
+    }
+
+    MatrixBatch<double> square(3, 2, 2);
+    MatrixBatch<double> sameShape(batch.getCount(), 2, 3);
+    EXPECT_THROW(batchTranspose(batch, sameShape), std::invalid_argument);
+    EXPECT_THROW(batchTranspose(square, square), std::invalid_argument);
+}
+
+TEST(MatrixBatchTest, InverseAndDeterminantMatchPerMatrixResults)
+{
+    for(int n : {2, 3, 4, 5})
+    {
+        std::vector<Matrix<double>> matrices = randomBatchMatrices(n, 13);
+        int count = static_cast<int>(matrices.size());
+        MatrixBatch<double> batch(matrices);
+        MatrixBatch<double> inverse(count, n, n);
+        EXPECT_EQ(batchInverse(batch, inverse), 0);
+        std::vector<double> determinants(count);
+        batchDeterminant(batch, std::span<double>(determinants));
+        std::vector<double> inverseDeterminants(count);
+        batchDeterminant(inverse, std::span<double>(inverseDeterminants));
+        for(int index = 0; index < count; index++)
+        {
+            Matrix<double> identity(n, n);
+            Matrix<double> matrixInverse = inverse.getMatrix(index);
+            gemm(matrices[index], matrixInverse, identity);
+            for(int row = 0; row < n; row++)
+            {
+                for(int column = 0; column < n; column++)
+                {
+                    EXPECT_NEAR(identity.at(row, column), row == column ? 1.0 : 0.0, 1e-9);
+                }
+            }
+            EXPECT_NEAR(determinants[index] * inverseDeterminants[index], 1.0, 1e-9);
+        }
+    }
+}
+
+TEST(MatrixBatchTest, InverseCountsSingularMatrices)
+{
+    MatrixBatch<double> singular(3, 3, 3);
+    singular.at(1, 0, 0) = 1.0;
+    EXPECT_EQ(batchInverse(singular, singular), 3);
+    std::vector<double> determinants(3, 1.0);
+    MatrixBatch<double> zeros(3, 3, 3);
+    batchDeterminant(zeros, std::span<double>(determinants));
+    EXPECT_EQ(determinants, std::vector<double>(3, 0.0));
+}
+
+TEST(MatrixBatchTest, InverseAndDeterminantRejectBadArguments)
+{
+    MatrixBatch<double> wide(3, 2, 3);
+    MatrixBatch<double> square(3, 2, 2);
+    MatrixBatch<double> otherCount(4, 2, 2);
+    std::vector<double> determinants(3);
+    std::vector<double> tooFew(2);
+    EXPECT_THROW(batchInverse(wide, wide), std::invalid_argument);
+    EXPECT_THROW(batchInverse(square, otherCount), std::invalid_argument);
+    EXPECT_THROW(batchDeterminant(wide, std::span<double>(determinants)), std::invalid_argument);
+    EXPECT_THROW(batchDeterminant(square, std::span<double>(tooFew)), std::invalid_argument);
+}
+
+//Strong diagonal keeps triangular and band solves stable
+static Matrix<double> diagonallyDominant(int size, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    Matrix<double> dense(size, size);
+    dense.generate([&](int, int) {return distribution(generator);});
+    for(int i = 0; i < size; i++)
+    {
+        dense.at(i, i) += 4.0;
+    }
+    return dense;
+}
+
+static std::vector<double> randomVector(int size, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    std::vector<double> values(size);
+    for(double& value : values)
+    {
+        value = distribution(generator);
+    }
+    return values;
+}
+
+//Compares structured gemv with dense gemv of the same matrix, y starts at 1 so beta is exercised
+template<typename Structured>
+static void expectGemvMatchesDense(Structured& structured, Matrix<double>& dense, std::vector<double>& x)
+{
+    int size = static_cast<int>(x.size());
+    std::vector<double> expected(size, 1.0);
+    std::vector<double> actual(size, 1.0);
+    gemv(dense, x, std::span<double>(expected), 2.0, 0.5);
+    gemv(structured, x, std::span<double>(actual), 2.0, 0.5);
+    for(int i = 0; i < size; i++)
+    {
+        EXPECT_NEAR(actual[i], expected[i], 1e-10);
+    }
+}
+
+//Compares structured gemm with dense gemm, 300 columns span two panels
+template<typename Structured>
+static void expectGemmMatchesDense(Structured& structured, Matrix<double>& dense, Matrix<double>& b)
+{
+    Matrix<double> expected(dense.getRowCount(), b.getColumnCount());
+    expected.fill(1.0);
+    Matrix<double> actual(dense.getRowCount(), b.getColumnCount());
+    actual.fill(1.0);
+    gemm(dense, b, expected, 2.0, 0.5);
+    gemm(structured, b, actual, 2.0, 0.5);
+    for(int i = 0; i < actual.getSize(); i++)
+    {
+        EXPECT_NEAR(actual.cbegin()[i], expected.cbegin()[i], 1e-10);
+    }
+}
+
+//Checks that solution of a * solution = x satisfies the system
+template<typename Structured>
+static void expectSolves(Structured& a, std::vector<double>& solution, std::vector<double>& x)
+{
+    std::vector<double> residual(x.size());
+    gemv(a, solution, std::span<double>(residual));
+    for(std::size_t i = 0; i < x.size(); i++)
+    {
+        EXPECT_NEAR(residual[i], x[i], 1e-9);
+    }
+}
+
+TEST(PackedMatrixTest, DenseConversionsKeepStoredElements)
+{
+    int size = 7;
+    Matrix<double> dense = diagonallyDominant(size, 11);
+    Matrix<double> symmetricDense = SymmetricMatrix<double>(dense).toMatrix();
+    TriangularMatrix<double> lower(dense, Triangle::Lower);
+    TriangularMatrix<double> upper(dense, Triangle::Upper);
+    BandedMatrix<double> banded(dense, 2, 1);
+    Matrix<double> lowerDense = lower.toMatrix();
+    Matrix<double> upperDense = upper.toMatrix();
+    Matrix<double> bandedDense = banded.toMatrix();
+    for(int row = 0; row < size; row++)
+    {
+        for(int column = 0; column < size; column++)
+        {
+            double value = dense.at(row, column);
+            EXPECT_EQ(symmetricDense.at(row, column), row >= column ? value : dense.at(column, row));
+            EXPECT_EQ(lowerDense.at(row, column), column <= row ? value : 0.0);
+            EXPECT_EQ(upperDense.at(row, column), column >= row ? value : 0.0);
+            EXPECT_EQ(bandedDense.at(row, column), column >= row - 2 && column <= row + 1 ? value : 0.0);
+            EXPECT_EQ(upper.get(row, column), upperDense.at(row, column));
+            EXPECT_EQ(banded.get(row, column), bandedDense.at(row, column));
+        }
+    }
+}
+
+TEST(PackedMatrixTest, ConstructionAndAccessRejectBadArguments)
+{
+    Matrix<double> wide(2, 3);
+    EXPECT_THROW(TriangularMatrix<double>(wide, Triangle::Lower), std::invalid_argument);
+    EXPECT_THROW(SymmetricMatrix<double>{wide}, std::invalid_argument);
+    EXPECT_THROW(BandedMatrix<double>(wide, 1, 1), std::invalid_argument);
+    EXPECT_THROW(TriangularMatrix<double>(-1, Triangle::Upper), std::invalid_argument);
+    EXPECT_THROW(SymmetricMatrix<double>(-1), std::invalid_argument);
+    EXPECT_THROW(BandedMatrix<double>(3, -1, 0), std::invalid_argument);
+
+    TriangularMatrix<double> triangular(3, Triangle::Lower);
+    EXPECT_THROW(triangular.at(0, 1), std::out_of_range);
+    EXPECT_THROW(triangular.get(3, 0), std::out_of_range);
+    EXPECT_EQ(triangular.get(0, 1), 0.0);
+    SymmetricMatrix<double> symmetric(3);
+    EXPECT_THROW(symmetric.at(-1, 0), std::out_of_range);
+    symmetric.at(0, 2) = 5.0;
+    EXPECT_EQ(symmetric.at(2, 0), 5.0);
+    BandedMatrix<double> banded(4, 1, 0);
+    EXPECT_THROW(banded.at(0, 1), std::out_of_range);
+    EXPECT_THROW(banded.get(0, 4), std::out_of_range);
+}
+
+TEST(PackedMatrixTest, SymmetricGemv)
+{
+    //400 rows take the parallel path
+    for(int size : {1, 7, 40, 400})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 13);
+        SymmetricMatrix<double> symmetric(dense);
+        Matrix<double> symmetricDense = symmetric.toMatrix();
+        std::vector<double> x = randomVector(size, 17);
+        expectGemvMatchesDense(symmetric, symmetricDense, x);
+    }
+    SymmetricMatrix<double> symmetric(3);
+    std::vector<double> x(3);
+    std::vector<double> y(4);
+    EXPECT_THROW(gemv(symmetric, x, std::span<double>(y)), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, TriangularGemv)
+{
+    for(int size : {1, 7, 40, 400})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 19);
+        std::vector<double> x = randomVector(size, 23);
+        for(Triangle triangle : {Triangle::Lower, Triangle::Upper})
+        {
+            TriangularMatrix<double> triangular(dense, triangle);
+            Matrix<double> triangularDense = triangular.toMatrix();
+            expectGemvMatchesDense(triangular, triangularDense, x);
+        }
+    }
+    TriangularMatrix<double> triangular(3, Triangle::Upper);
+    std::vector<double> x(2);
+    std::vector<double> y(3);
+    EXPECT_THROW(gemv(triangular, x, std::span<double>(y)), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, BandedGemv)
+{
+    for(int size : {1, 7, 40, 400})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 29);
+        BandedMatrix<double> banded(dense, 2, 1);
+        Matrix<double> bandedDense = banded.toMatrix();
+        std::vector<double> x = randomVector(size, 31);
+        expectGemvMatchesDense(banded, bandedDense, x);
+    }
+    BandedMatrix<double> banded(3, 1, 1);
+    std::vector<double> x(3);
+    std::vector<double> y(2);
+    EXPECT_THROW(gemv(banded, x, std::span<double>(y)), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, SymmetricGemm)
+{
+    for(int size : {1, 7, 40})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 37);
+        SymmetricMatrix<double> symmetric(dense);
+        Matrix<double> symmetricDense = symmetric.toMatrix();
+        Matrix<double> b = diagonallyDominant(size, 41);
+        b.resize(size, 300, 0.5);
+        expectGemmMatchesDense(symmetric, symmetricDense, b);
+    }
+    SymmetricMatrix<double> symmetric(3);
+    Matrix<double> b(3, 4);
+    Matrix<double> wrong(3, 5);
+    EXPECT_THROW(gemm(symmetric, b, wrong), std::invalid_argument);
+    EXPECT_THROW(gemm(symmetric, b, b), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, TriangularGemm)
+{
+    for(int size : {1, 7, 40})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 43);
+        Matrix<double> b = diagonallyDominant(size, 47);
+        b.resize(size, 300, -0.5);
+        for(Triangle triangle : {Triangle::Lower, Triangle::Upper})
+        {
+            TriangularMatrix<double> triangular(dense, triangle);
+            Matrix<double> triangularDense = triangular.toMatrix();
+            expectGemmMatchesDense(triangular, triangularDense, b);
+        }
+    }
+    TriangularMatrix<double> triangular(3, Triangle::Lower);
+    Matrix<double> b(4, 2);
+    Matrix<double> c(3, 2);
+    EXPECT_THROW(gemm(triangular, b, c), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, TriangularSolveLower)
+{
+    for(int size : {1, 7, 40, 400})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 53);
+        TriangularMatrix<double> lower(dense, Triangle::Lower);
+        std::vector<double> x = randomVector(size, 59);
+        std::vector<double> solution = x;
+        triangularSolve(lower, std::span<double>(solution));
+        expectSolves(lower, solution, x);
+    }
+}
+
+TEST(PackedMatrixTest, TriangularSolveUpper)
+{
+    for(int size : {1, 7, 40, 400})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 61);
+        TriangularMatrix<double> upper(dense, Triangle::Upper);
+        std::vector<double> x = randomVector(size, 67);
+        std::vector<double> solution = x;
+        triangularSolve(upper, std::span<double>(solution));
+        expectSolves(upper, solution, x);
+    }
+    TriangularMatrix<double> upper(3, Triangle::Upper);
+    std::vector<double> rhs(4, 1.0);
+    EXPECT_THROW(triangularSolve(upper, std::span<double>(rhs)), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, TriangularSolveMultipleRightHandSides)
+{
+    for(int size : {1, 7, 40})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 71);
+        Matrix<double> b = diagonallyDominant(size, 73);
+        b.resize(size, 300, 0.25);
+        for(Triangle triangle : {Triangle::Lower, Triangle::Upper})
+        {
+            TriangularMatrix<double> triangular(dense, triangle);
+            Matrix<double> solutions = b;
+            triangularSolve(triangular, solutions);
+            Matrix<double> triangularDense = triangular.toMatrix();
+            Matrix<double> recovered(size, 300);
+            gemm(triangularDense, solutions, recovered);
+            for(int i = 0; i < recovered.getSize(); i++)
+            {
+                EXPECT_NEAR(recovered.cbegin()[i], b.cbegin()[i], 1e-9);
+            }
+        }
+    }
+    TriangularMatrix<double> triangular(3, Triangle::Lower);
+    Matrix<double> wrong(2, 3);
+    EXPECT_THROW(triangularSolve(triangular, wrong), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, BandedSolve)
+{
+    for(int size : {1, 7, 40, 400})
+    {
+        Matrix<double> dense = diagonallyDominant(size, 79);
+        BandedMatrix<double> banded(dense, 2, 1);
+        std::vector<double> x = randomVector(size, 83);
+        std::vector<double> solution = x;
+        bandedSolve(banded, std::span<double>(solution));
+        expectSolves(banded, solution, x);
+    }
+    Matrix<double> dense = diagonallyDominant(3, 89);
+    BandedMatrix<double> banded(dense, 1, 1);
+    std::vector<double> rhs(4, 1.0);
+    EXPECT_THROW(bandedSolve(banded, std::span<double>(rhs)), std::invalid_argument);
+}
+
+TEST(PackedMatrixTest, BandedSolveZeroPivotThrows)
+{
+    BandedMatrix<double> banded(4, 1, 0);
+    std::vector<double> rhs(4, 1.0);
+    EXPECT_THROW(bandedSolve(banded, std::span<double>(rhs)), std::invalid_argument);
+    EXPECT_EQ(rhs, std::vector<double>(4, 1.0));
+}
+
+///@brief Fills bit matrix with reproducible random elements
+static Matrix<bool> randomBits(int rows, int columns, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution distribution(0.4);
+    Matrix<bool> matrix(rows, columns);
+    for(int row = 0; row < rows; row++)
+    {
+        for(int column = 0; column < columns; column++)
+        {
+            matrix.at(row, column) = distribution(generator);
+        }
+    }
+    return matrix;
+}
+
+///@brief Reads bit matrix element by element into nested vectors
+static std::vector<std::vector<bool>> bitRows(Matrix<bool>& matrix)
+{
+    std::vector<std::vector<bool>> rows(matrix.getRowCount(), std::vector<bool>(matrix.getColumnCount()));
+    for(int row = 0; row < matrix.getRowCount(); row++)
+    {
+        for(int column = 0; column < matrix.getColumnCount(); column++)
+        {
+            rows[row][column] = matrix.test(row, column);
+        }
+    }
+    return rows;
+}
+
+//70 columns leave padding in the second word of every row
+TEST(BitMatrixTest, CopyOnWriteAndEquality)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    EXPECT_EQ(a.getRowWordCount(), 2);
+    Matrix<bool> shared = a;
+    EXPECT_EQ(shared.refCount(), 2);
+    shared.at(0, 69).flip();
+    EXPECT_EQ(a.refCount(), 1);
+    EXPECT_NE(shared.test(0, 69), a.test(0, 69));
+    EXPECT_FALSE(shared == a);
+    shared.at(0, 69) = a.at(0, 69);
+    EXPECT_TRUE(shared == a);
+    EXPECT_EQ(shared.hash(), a.hash());
+}
+
+TEST(BitMatrixTest, ElementAccessOutOfRange)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    EXPECT_THROW(a.at(45, 0), std::out_of_range);
+    EXPECT_THROW(a.at(0, 70), std::out_of_range);
+    EXPECT_THROW(a.at(-1, 0), std::out_of_range);
+    EXPECT_THROW(a.test(0, -1), std::out_of_range);
+    EXPECT_THROW(a.rowWords(45), std::out_of_range);
+    EXPECT_THROW(a.constRowWords(-1), std::out_of_range);
+    EXPECT_THROW(Matrix<bool>(2, -1), std::invalid_argument);
+}
+
+TEST(BitMatrixTest, BitwiseOperators)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    Matrix<bool> b = randomBits(45, 70, 6);
+    Matrix<bool> negated = ~a;
+    EXPECT_EQ((a & negated).popcount(), 0);
+    EXPECT_EQ((a | negated).popcount(), a.getSize());
+    EXPECT_EQ((a ^ negated).popcount(), a.getSize());
+    Matrix<bool> conjunction = a & b;
+    Matrix<bool> disjunction = a | b;
+    Matrix<bool> difference = a ^ b;
+    for(int row = 0; row < 45; row++)
+    {
+        for(int column = 0; column < 70; column++)
+        {
+            EXPECT_EQ(negated.test(row, column), !a.test(row, column));
+            EXPECT_EQ(conjunction.test(row, column), a.test(row, column) && b.test(row, column));
+            EXPECT_EQ(disjunction.test(row, column), a.test(row, column) || b.test(row, column));
+            EXPECT_EQ(difference.test(row, column), a.test(row, column) != b.test(row, column));
+        }
+    }
+
+    Matrix<bool> other(70, 45);
+    EXPECT_THROW(a &= other, std::invalid_argument);
+    EXPECT_THROW(a |= other, std::invalid_argument);
+    EXPECT_THROW(a ^= other, std::invalid_argument);
+}
+
+TEST(BitMatrixTest, Popcount)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    std::vector<std::vector<bool>> rows = bitRows(a);
+    int expected = 0;
+    for(std::vector<bool>& row : rows)
+    {
+        expected += static_cast<int>(std::count(row.begin(), row.end(), true));
+    }
+    EXPECT_EQ(a.popcount(), expected);
+    EXPECT_EQ(a.popcount() + (~a).popcount(), a.getSize());
+    EXPECT_EQ(Matrix<bool>(3, 0).popcount(), 0);
+}
+
+TEST(BitMatrixTest, RowPopcounts)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    std::vector<int> rowCounts = a.rowPopcounts();
+    ASSERT_EQ(static_cast<int>(rowCounts.size()), 45);
+    int row = 0;
+    for(auto rowIter = a.beginConstRow(); rowIter != a.endConstRow(); ++rowIter, row++)
+    {
+        std::vector<bool> values = *rowIter;
+        EXPECT_EQ(rowCounts[row], std::count(values.begin(), values.end(), true));
+    }
+}
+
+TEST(BitMatrixTest, ColumnPopcounts)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    std::vector<int> expected(a.getColumnCount());
+    for(std::vector<bool>& row : bitRows(a))
+    {
+        for(int column = 0; column < a.getColumnCount(); column++)
+        {
+            expected[column] += row[column];
+        }
+    }
+    EXPECT_EQ(a.columnPopcounts(), expected);
+}
+
+TEST(BitMatrixTest, TransposedMatchesColumns)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    Matrix<bool> transposed = a.transposed();
+    EXPECT_EQ(transposed.getRowCount(), 70);
+    EXPECT_EQ(transposed.getColumnCount(), 45);
+    for(auto columnIter = a.beginColumn(); columnIter != a.endColumn(); ++columnIter)
+    {
+        std::vector<Matrix<bool>::reference> values = *columnIter;
+        for(int i = 0; i < a.getRowCount(); i++)
+        {
+            EXPECT_EQ(static_cast<bool>(values[i]), transposed.test(columnIter.getIndex(), i));
+        }
+    }
+}
+
+//Counts k for which a(i, k) and b(k, j) are true
+static int referenceCount(Matrix<bool>& a, Matrix<bool>& b, int i, int j)
+{
+    int count = 0;
+    for(int k = 0; k < a.getColumnCount(); k++)
+    {
+        count += a.test(i, k) && b.test(k, j);
+    }
+    return count;
+}
+
+TEST(BitMatrixTest, BooleanMultiply)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    Matrix<bool> b = randomBits(70, 130, 7);
+    Matrix<bool> product(45, 130);
+    booleanMultiply(a, b, product);
+    for(int i = 0; i < 45; i++)
+    {
+        for(int j = 0; j < 130; j++)
+        {
+            EXPECT_EQ(product.test(i, j), referenceCount(a, b, i, j) > 0);
+        }
+    }
+
+    Matrix<bool> square = randomBits(45, 45, 8);
+    Matrix<bool> wrong(45, 129);
+    EXPECT_THROW(booleanMultiply(a, a, product), std::invalid_argument);
+    EXPECT_THROW(booleanMultiply(a, b, wrong), std::invalid_argument);
+    EXPECT_THROW(booleanMultiply(square, square, square), std::invalid_argument);
+}
+
+TEST(BitMatrixTest, CountMultiply)
+{
+    Matrix<bool> a = randomBits(45, 70, 5);
+    Matrix<bool> b = randomBits(70, 130, 7);
+    Matrix<int> counts(45, 130);
+    countMultiply(a, b, counts);
+    for(int i = 0; i < 45; i++)
+    {
+        for(int j = 0; j < 130; j++)
+        {
+            EXPECT_EQ(counts.at(i, j), referenceCount(a, b, i, j));
+        }
+    }
+
+    Matrix<int> wrong(130, 45);
+    EXPECT_THROW(countMultiply(a, a, counts), std::invalid_argument);
+    EXPECT_THROW(countMultiply(a, b, wrong), std::invalid_argument);
+}
+
+TEST_F(MatrixTest, BitMatrixInsertAndEraseRows)
+{
+    Matrix<bool> bits = randomBits(5, 70, 21);
+    std::vector<std::vector<bool>> expected = bitRows(bits);
+    std::vector<bool> inserted(70);
+    inserted[0] = inserted[69] = true;
+    bits.insertRow(inserted, 2);
+    expected.insert(expected.begin() + 2, inserted);
+    bool set = true;
+    bits.insertRow(std::vector<bool*>(70, &set), 6);
+    expected.push_back(std::vector<bool>(70, true));
+    EXPECT_EQ(bitRows(bits), expected);
+
+    bits.eraseRow(Matrix<bool>::rowIterator(0, &bits));
+    expected.erase(expected.begin());
+    EXPECT_EQ(bitRows(bits), expected);
+    EXPECT_THROW(bits.eraseRow(bits.endRow()), std::out_of_range);
+    EXPECT_THROW(bits.insertRow(std::vector<bool>(69), 0), std::out_of_range);
+    EXPECT_THROW(bits.insertRow(inserted, 8), std::out_of_range);
+}
+
+TEST_F(MatrixTest, BitMatrixInsertAndEraseColumns)
+{
+    //Inserting at 64 moves the column into the second word, inserting a 129th column adds a third word
+    Matrix<bool> bits = randomBits(4, 128, 22);
+    std::vector<std::vector<bool>> expected = bitRows(bits);
+    for(int column : {0, 64, 63, 130})
+    {
+        std::vector<bool> inserted = {true, false, true, true};
+        bits.insertColumn(inserted, column);
+        for(int row = 0; row < 4; row++)
+        {
+            expected[row].insert(expected[row].begin() + column, inserted[row]);
+        }
+        ASSERT_EQ(bitRows(bits), expected) << column;
+    }
+    EXPECT_EQ(bits.getRowWordCount(), 3);
+
+    for(int column : {131, 0, 64, 63})
+    {
+        bits.eraseColumn(Matrix<bool>::columnIterator(column, &bits));
+        for(int row = 0; row < 4; row++)
+        {
+            expected[row].erase(expected[row].begin() + column);
+        }
+        ASSERT_EQ(bitRows(bits), expected) << column;
+    }
+    EXPECT_EQ(bits.getRowWordCount(), 2);
+    std::int64_t expectedCount = 0;
+    for(const std::vector<bool>& row : expected)
+    {
+        expectedCount += std::count(row.begin(), row.end(), true);
+    }
+    EXPECT_EQ(bits.popcount(), expectedCount);
+    EXPECT_THROW(bits.insertColumn(std::vector<bool>(3), 0), std::out_of_range);
+    EXPECT_THROW(bits.eraseColumn(bits.endColumn()), std::out_of_range);
+}
+
+TEST_F(MatrixTest, BitMatrixResizeAndReshape)
+{
+    Matrix<bool> bits = randomBits(3, 70, 23);
+    std::vector<std::vector<bool>> original = bitRows(bits);
+    bits.reserve(10, 200);
+    EXPECT_GE(bits.getCapacity(), 10 * 4 * 64);
+    bits.resize(5, 130, true);
+    for(int row = 0; row < 5; row++)
+    {
+        for(int column = 0; column < 130; column++)
+        {
+            EXPECT_EQ(bits.test(row, column), row < 3 && column < 70 ? original[row][column] : true);
+        }
+    }
+    bits.resize(2, 10);
+    EXPECT_EQ(bits.popcount(), std::count(original[0].begin(), original[0].begin() + 10, true) +
+                               std::count(original[1].begin(), original[1].begin() + 10, true));
+
+    Matrix<bool> reshaped = randomBits(6, 70, 24);
+    std::vector<std::vector<bool>> rows = bitRows(reshaped);
+    reshaped.reshape(10, 42);
+    for(int index = 0; index < 420; index++)
+    {
+        EXPECT_EQ(reshaped.test(index / 42, index % 42), rows[index / 70][index % 70]);
+    }
+    EXPECT_THROW(reshaped.reshape(7, 61), std::invalid_argument);
+}
+
+template<typename Semiring, typename T>
+static void expectSemiringProductMatches(Matrix<T>& a, Matrix<T>& b)
+{
+    Matrix<T> product(a.getRowCount(), b.getColumnCount());
+    semiringMultiply<Semiring>(a, b, product);
+    for(int i = 0; i < a.getRowCount(); i++)
+    {
+        for(int j = 0; j < b.getColumnCount(); j++)
+        {
+            T expected = Semiring::zero();
+            for(int k = 0; k < a.getColumnCount(); k++)
+            {
+                expected = Semiring::add(expected, Semiring::multiply(a.at(i, k), b.at(k, j)));
+            }
+            EXPECT_EQ(product.at(i, j), expected) << i << ", " << j;
+        }
+    }
+}
+
+//Sparse random weights, absent edges hold the MinPlus zero. Integral values keep every product exact.
+static Matrix<int> randomMinPlusWeights(int rows, int columns, unsigned seed, int minimumWeight)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> weight(minimumWeight, 20);
+    std::bernoulli_distribution edge(0.1);
+    Matrix<int> matrix(rows, columns);
+    matrix.generate([&](int, int) {return edge(generator) ? weight(generator) : MinPlus<int>::zero();});
+    return matrix;
+}
+
+//Closures are checked against Floyd-Warshall, non-negative weights rule out negative cycles
+static Matrix<int> floydWarshall(Matrix<int>& graph)
+{
+    int n = static_cast<int>(graph.getRowCount());
+    Matrix<int> distances = graph;
+    for(int i = 0; i < n; i++)
+    {
+        distances.at(i, i) = 0;
+    }
+    for(int k = 0; k < n; k++)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            for(int j = 0; j < n; j++)
+            {
+                distances.at(i, j) = MinPlus<int>::add(distances.at(i, j),
+                                                       MinPlus<int>::multiply(distances.at(i, k), distances.at(k, j)));
+            }
+        }
+    }
+    return distances;
+}
+
+//300 columns span two blocks of the blocked kernel
+TEST(SemiringTest, MinPlusProduct)
+{
+    Matrix<int> a = randomMinPlusWeights(70, 300, 3, -3);
+    Matrix<int> b = randomMinPlusWeights(300, 90, 4, -3);
+    expectSemiringProductMatches<MinPlus<int>>(a, b);
+
+    Matrix<float> aFloat(70, 300);
+    Matrix<float> bFloat(300, 90);
+    aFloat.generate([&](int row, int column) {return a.at(row, column) == MinPlus<int>::zero() ?
+                                              MinPlus<float>::zero() : static_cast<float>(a.at(row, column));});
+    bFloat.generate([&](int row, int column) {return b.at(row, column) == MinPlus<int>::zero() ?
+                                              MinPlus<float>::zero() : static_cast<float>(b.at(row, column));});
+    expectSemiringProductMatches<MinPlus<float>>(aFloat, bFloat);
+}
+
+TEST(SemiringTest, MaxPlusProduct)
+{
+    Matrix<double> a(70, 300);
+    Matrix<double> b(300, 90);
+    a.generate([](int row, int column) {return static_cast<double>((row * 7 + column) % 13);});
+    b.generate([](int row, int column) {return static_cast<double>((row + column * 5) % 11) - 5.0;});
+    expectSemiringProductMatches<MaxPlus<double>>(a, b);
+}
+
+TEST(SemiringTest, PlusTimesProduct)
+{
+    Matrix<double> a(70, 300);
+    Matrix<double> b(300, 90);
+    a.generate([](int row, int column) {return static_cast<double>((row * 7 + column) % 13);});
+    b.generate([](int row, int column) {return static_cast<double>((row + column * 5) % 11) - 5.0;});
+    expectSemiringProductMatches<PlusTimes<double>>(a, b);
+}
+
+TEST(SemiringTest, OrAndProduct)
+{
+    std::mt19937 generator(5);
+    std::bernoulli_distribution edge(0.1);
+    Matrix<char> a(70, 300);
+    Matrix<char> b(300, 90);
+    a.generate([&](int, int) {return static_cast<char>(edge(generator));});
+    b.generate([&](int, int) {return static_cast<char>(edge(generator));});
+    expectSemiringProductMatches<OrAnd<char>>(a, b);
+}
+
+TEST(SemiringTest, MultiplyRejectsBadArguments)
+{
+    Matrix<int> a(4, 3);
+    Matrix<int> b(3, 5);
+    Matrix<int> wrong(4, 4);
+    Matrix<int> square(3, 3);
+    EXPECT_THROW(semiringMultiply<MinPlus<int>>(a, a, b), std::invalid_argument);
+    EXPECT_THROW(semiringMultiply<MinPlus<int>>(a, b, wrong), std::invalid_argument);
+    EXPECT_THROW(semiringMultiply<MinPlus<int>>(square, square, square), std::invalid_argument);
+}
+
+TEST(SemiringTest, ShortestPathsMatchFloydWarshall)
+{
+    Matrix<int> graph = randomMinPlusWeights(150, 150, 6, 0);
+    Matrix<int> distances = floydWarshall(graph);
+    EXPECT_TRUE(shortestPaths(graph) == distances);
+}
+
+TEST(SemiringTest, TransitiveClosureMatchesReachability)
+{
+    int n = 150;
+    Matrix<int> graph = randomMinPlusWeights(n, n, 7, 0);
+    Matrix<int> distances = floydWarshall(graph);
+    Matrix<bool> adjacency(n, n);
+    for(int i = 0; i < n; i++)
+    {
+        for(int j = 0; j < n; j++)
+        {
+            adjacency.at(i, j) = graph.at(i, j) != MinPlus<int>::zero();
+        }
+    }
+    Matrix<bool> reachable = transitiveClosure(adjacency);
+    for(int i = 0; i < n; i++)
+    {
+        for(int j = 0; j < n; j++)
+        {
+            EXPECT_EQ(reachable.test(i, j), distances.at(i, j) != MinPlus<int>::zero());
+        }
+    }
+}
+
+TEST(SemiringTest, ClosuresRejectNonSquareMatrices)
+{
+    Matrix<int> weights(4, 5);
+    Matrix<bool> adjacency(5, 4);
+    EXPECT_THROW(shortestPaths(weights), std::invalid_argument);
+    EXPECT_THROW(semiringClosure<MaxPlus<int>>(weights), std::invalid_argument);
+    EXPECT_THROW(transitiveClosure(adjacency), std::invalid_argument);
+}
+
+//Backing file in the test temporary directory, declared before the matrix so it is removed after the file is closed
+class TemporaryFile {
+private:
+    std::string path;
+
+public:
+    explicit TemporaryFile(const std::string& name) :
+            path(::testing::TempDir() + "matrixTests_outOfCore_" + name + ".bin") {};
+    ~TemporaryFile() {std::remove(path.c_str());};
+    const std::string& getPath() const {return path;};
+};
+
+//Three 16 x 16 tiles of doubles fit the cache, a 100 x 70 matrix has 35 tiles
+constexpr int testTileSize = 16;
+constexpr std::size_t testCacheBytes = 3 * testTileSize * testTileSize * sizeof(double);
+
+static Matrix<double> outOfCoreReference()
+{
+    Matrix<double> reference(100, 70);
+    reference.generate([](int row, int column) {return row * 1000.0 + column;});
+    return reference;
+}
+
+TEST(OutOfCoreMatrixTest, ElementsSurviveTileEviction)
+{
+    TemporaryFile file("elements");
+    OutOfCoreMatrix<double> matrix(100, 70, file.getPath(), testCacheBytes, testTileSize);
+    EXPECT_EQ(matrix.get(99, 69), 0.0);
+    for(int row = 0; row < 100; row++)
+    {
+        for(int column = 0; column < 70; column++)
+        {
+            matrix.at(row, column) = row * 1000.0 + column;
+        }
+    }
+    EXPECT_LE(matrix.getResidentTileCount(), 3u);
+    EXPECT_GT(matrix.getTileStoreCount(), 0);
+    matrix.flush();
+    EXPECT_TRUE(matrix.toMatrix() == outOfCoreReference());
+}
+
+TEST(OutOfCoreMatrixTest, OutOfCoreEvictsDirtyTile)
+{
+    //Cache holds two tiles of a row of three, so the third access evicts the least recently used one
+    TemporaryFile file("eviction");
+    constexpr std::size_t twoTiles = 2 * testTileSize * testTileSize * sizeof(double);
+    OutOfCoreMatrix<double> matrix(16, 48, file.getPath(), twoTiles, testTileSize);
+    matrix.at(0, 0) = 5.0;
+    EXPECT_EQ(matrix.get(0, 16), 0.0);
+    EXPECT_EQ(matrix.getTileStoreCount(), 0);
+    EXPECT_EQ(matrix.get(0, 32), 0.0);
+    EXPECT_EQ(matrix.getTileStoreCount(), 1);
+    std::int64_t loads = matrix.getTileLoadCount();
+    EXPECT_EQ(matrix.get(0, 0), 5.0);
+    EXPECT_EQ(matrix.getTileLoadCount(), loads + 1);
+    EXPECT_EQ(matrix.getTileStoreCount(), 1);
+    EXPECT_EQ(matrix.getResidentTileCount(), 2u);
+}
+
+TEST(OutOfCoreMatrixTest, RowAndColumnAccess)
+{
+    TemporaryFile file("rows");
+    Matrix<double> reference = outOfCoreReference();
+    OutOfCoreMatrix<double> matrix(reference, file.getPath(), testCacheBytes, testTileSize);
+    std::vector<double> column(100, -1.0);
+    matrix.setColumn(69, column);
+    std::vector<double> row(70, -2.0);
+    matrix.setRow(37, row);
+    for(int index = 0; index < 100; index++)
+    {
+        reference.at(index, 69) = -1.0;
+    }
+    for(int index = 0; index < 70; index++)
+    {
+        reference.at(37, index) = -2.0;
+    }
+    column[37] = -2.0;
+    EXPECT_EQ(matrix.getColumn(69), column);
+    EXPECT_EQ(matrix.getRow(37), row);
+
+    //Column scan moves by a whole tile row per tile switch and is prefetched
+    std::int64_t prefetched = matrix.getPrefetchCount();
+    EXPECT_EQ(*std::next(matrix.beginConstColumn(), 69), column);
+    EXPECT_GT(matrix.getPrefetchCount(), prefetched);
+    int rowCount = 0;
+    for(auto iter = matrix.beginConstRow(); iter != matrix.endConstRow(); ++iter)
+    {
+        const double* referenceRow = reference.ptrAt(iter.getIndex(), 0);
+        EXPECT_EQ(*iter, std::vector<double>(referenceRow, referenceRow + 70));
+        rowCount++;
+    }
+    EXPECT_EQ(rowCount, 100);
+}
+
+TEST(OutOfCoreMatrixTest, AccessRejectsBadArguments)
+{
+    TemporaryFile file("access");
+    OutOfCoreMatrix<double> matrix(100, 70, file.getPath(), testCacheBytes, testTileSize);
+    EXPECT_THROW(matrix.at(100, 0), std::out_of_range);
+    EXPECT_THROW(matrix.get(0, -1), std::out_of_range);
+    EXPECT_THROW(matrix.getRow(100), std::out_of_range);
+    EXPECT_THROW(matrix.getColumn(70), std::out_of_range);
+    EXPECT_THROW(matrix.setRow(0, std::vector<double>(69)), std::invalid_argument);
+    EXPECT_THROW(matrix.setColumn(0, std::vector<double>(101)), std::invalid_argument);
+    EXPECT_THROW(matrix.setRow(-1, std::vector<double>(70)), std::out_of_range);
+
+    TemporaryFile other("construction");
+    EXPECT_THROW(OutOfCoreMatrix<double>(-1, 2, other.getPath(), testCacheBytes, testTileSize),
+                 std::invalid_argument);
+    EXPECT_THROW(OutOfCoreMatrix<double>(2, 2, other.getPath(), testCacheBytes, 0), std::invalid_argument);
+    EXPECT_THROW(OutOfCoreMatrix<double>(2, 2, other.getPath() + "/missing/file.bin", testCacheBytes,
+                                         testTileSize), std::system_error);
+}
+
+TEST(OutOfCoreMatrixTest, ReductionsMatchInMemoryResults)
+{
+    TemporaryFile file("reductions");
+    Matrix<double> reference = outOfCoreReference();
+    OutOfCoreMatrix<double> matrix(reference, file.getPath(), testCacheBytes, testTileSize);
+    matrix.setRow(37, std::vector<double>(70, -2.0));
+    double sum = std::accumulate(reference.cbegin(), reference.cend(), 0.0) -
+            std::accumulate(reference.ptrAt(37, 0), reference.ptrAt(37, 0) + 70, 0.0) - 2.0 * 70;
+    EXPECT_EQ(reduce(matrix, 0.0, std::plus<double>()), sum);
+    std::vector<double> maxima = reduceRows(matrix, -1e9, [](double lhs, double rhs) {return std::max(lhs, rhs);});
+    ASSERT_EQ(maxima.size(), 100u);
+    EXPECT_EQ(maxima[0], 69.0);
+    EXPECT_EQ(maxima[37], -2.0);
+    EXPECT_EQ(maxima[99], 99069.0);
+}
+
+TEST(OutOfCoreMatrixTest, TiledGemmMatchesInMemoryGemm)
+{
+    TemporaryFile aFile("a");
+    TemporaryFile bFile("b");
+    TemporaryFile cFile("c");
+    Matrix<double> aDense(50, 40);
+    Matrix<double> bDense(40, 45);
+    aDense.generate([](int row, int column) {return static_cast<double>((row * 7 + column) % 13) - 6.0;});
+    bDense.generate([](int row, int column) {return static_cast<double>((row + column * 5) % 11) - 5.0;});
+    OutOfCoreMatrix<double> a(aDense, aFile.getPath(), testCacheBytes, testTileSize);
+    OutOfCoreMatrix<double> b(bDense, bFile.getPath(), testCacheBytes, testTileSize);
+    OutOfCoreMatrix<double> c(50, 45, cFile.getPath(), testCacheBytes, testTileSize);
+    Matrix<double> expected(50, 45);
+    gemm(aDense, bDense, expected);
+    gemm(a, b, c);
+    EXPECT_TRUE(c.toMatrix() == expected);
+    gemm(a, b, c, 2.0, -1.0);
+    EXPECT_TRUE(c.toMatrix() == expected);
+}
+
+TEST(OutOfCoreMatrixTest, TiledGemmOfSquareMatrixWithItself)
+{
+    TemporaryFile squareFile("square");
+    TemporaryFile squaredFile("squared");
+    Matrix<double> squareDense(40, 40);
+    squareDense.generate([](int row, int column) {return static_cast<double>((row * 3 + column) % 7) - 3.0;});
+    OutOfCoreMatrix<double> square(squareDense, squareFile.getPath(), testCacheBytes, testTileSize);
+    OutOfCoreMatrix<double> squared(40, 40, squaredFile.getPath(), testCacheBytes, testTileSize);
+    Matrix<double> squaredDense(40, 40);
+    gemm(squareDense, squareDense, squaredDense);
+    gemm(square, square, squared);
+    EXPECT_TRUE(squared.toMatrix() == squaredDense);
+}
+
+TEST(OutOfCoreMatrixTest, TiledGemmRejectsBadArguments)
+{
+    TemporaryFile aFile("gemm_a");
+    TemporaryFile bFile("gemm_b");
+    TemporaryFile cFile("gemm_c");
+    TemporaryFile otherFile("gemm_other");
+    OutOfCoreMatrix<double> a(50, 40, aFile.getPath(), testCacheBytes, testTileSize);
+    OutOfCoreMatrix<double> b(40, 45, bFile.getPath(), testCacheBytes, testTileSize);
+    OutOfCoreMatrix<double> c(50, 45, cFile.getPath(), testCacheBytes, testTileSize);
+    OutOfCoreMatrix<double> otherTiles(50, 45, otherFile.getPath(), testCacheBytes, 8);
+    EXPECT_THROW(gemm(a, b, a), std::invalid_argument);
+    EXPECT_THROW(gemm(b, a, c), std::invalid_argument);
+    EXPECT_THROW(gemm(a, b, otherTiles), std::invalid_argument);
+}
+
+TEST(RowBandPartitionTest, ThreadsFillDisjointBandsOfOneMatrix)
+{
+    Matrix<int> original(1001, 37);
+    original.fill(-1);
+    Matrix<int> shared = original;
+    std::size_t originalHash = original.hash();
+    RowAggregate rowSums(shared, [](std::span<const int> row) {return std::accumulate(row.begin(), row.end(), 0);});
+    rowSums.update();
+
+    //Shared data is copied once, producer threads then write without touching the handle
+    RowBandPartition<int> partition(std::move(shared), 4);
+    ASSERT_EQ(partition.getBandCount(), 4);
+    std::vector<std::thread> producers;
+    for(int band = 0; band < partition.getBandCount(); band++)
+    {
+        producers.emplace_back([writer = partition.writer(band)]() mutable {
+            for(MatrixIndex row = writer.getFirstRow(); row < writer.getEndRow(); row++)
+            {
+                for(MatrixIndex column = 0; column < writer.getColumnCount(); column++)
+                {
+                    writer.at(row, column) = static_cast<int>(row * 100 + column);
+                }
+            }
+        });
+    }
+    for(std::thread& producer : producers)
+    {
+        producer.join();
+    }
+    EXPECT_THROW(partition.writer(4), std::out_of_range);
+    shared = partition.seal();
+    EXPECT_EQ(partition.getBandCount(), 0);
+
+    Matrix<int> expected(1001, 37);
+    expected.generate([](int row, int column) {return row * 100 + column;});
+    EXPECT_TRUE(shared == expected);
+    EXPECT_EQ(shared.hash(), expected.hash());
+    EXPECT_EQ(original.hash(), originalHash);
+    EXPECT_EQ(original.at(1000, 36), -1);
+    EXPECT_EQ(rowSums.update()[1000], 1000 * 100 * 37 + 36 * 37 / 2);
+    EXPECT_EQ(rowSums.getRecomputedRowCount(), 1001);
+    Matrix<int> copy = shared;
+    EXPECT_EQ(copy.refCount(), 2);
+
+    //Uneven bands fill through spans on the thread pool
+    RowBandPartition<int> uneven(std::move(copy), std::vector<MatrixIndex>{0, 1, 1, 600, 1001});
+    ThreadPool::instance().parallelFor(0, uneven.getBandCount(), 1, [&](int bandBegin, int bandEnd) {
+        for(int band = bandBegin; band < bandEnd; band++)
+        {
+            RowBandWriter<int> writer = uneven.writer(band);
+            std::fill(writer.begin(), writer.end(), band);
+            if(writer.getEndRow() > writer.getFirstRow())
+            {
+                writer.row(writer.getFirstRow())[0] = -band;
+            }
+        }
+    });
+    copy = uneven.seal();
+    EXPECT_EQ(copy.at(0, 0), 0);
+    EXPECT_EQ(copy.at(0, 1), 0);
+    EXPECT_EQ(copy.at(1, 0), -2);
+    EXPECT_EQ(copy.at(599, 36), 2);
+    EXPECT_EQ(copy.at(600, 0), -3);
+    EXPECT_EQ(copy.at(1000, 36), 3);
+    EXPECT_TRUE(shared == expected);
+
+    EXPECT_THROW(RowBandPartition<int>(Matrix<int>(4, 4), 0), std::invalid_argument);
+    EXPECT_THROW(RowBandPartition<int>(Matrix<int>(4, 4), std::vector<MatrixIndex>{0, 3, 2, 4}), std::invalid_argument);
+    EXPECT_THROW(RowBandPartition<int>(Matrix<int>(4, 4), std::vector<MatrixIndex>{0, 3}), std::invalid_argument);
+}